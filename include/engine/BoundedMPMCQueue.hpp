@@ -0,0 +1,117 @@
+// include/engine/BoundedMPMCQueue.hpp
+#ifndef CMQ_BOUNDEDMPMCQUEUE_HPP
+#define CMQ_BOUNDEDMPMCQUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace CMQ {
+
+    // Lock-free bounded multi-producer/multi-consumer ring buffer.
+    // Each slot carries a sequence number that tells producers and consumers
+    // whether it is free for the current lap, so the only shared writes are
+    // one CAS on the enqueue or dequeue cursor per operation.
+    // Capacity is rounded up to a power of two.
+    template<typename T>
+    class BoundedMPMCQueue {
+    public:
+        explicit BoundedMPMCQueue(size_t capacity)
+            : capacity_(round_up(capacity)), mask_(capacity_ - 1),
+              cells_(new Cell[capacity_]), enqueue_pos_(0), dequeue_pos_(0) {
+            for (size_t i = 0; i < capacity_; ++i) {
+                cells_[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        ~BoundedMPMCQueue() {
+            T item;
+            while (try_pop(item)) {}
+        }
+
+        BoundedMPMCQueue(const BoundedMPMCQueue&) = delete;
+        BoundedMPMCQueue& operator=(const BoundedMPMCQueue&) = delete;
+
+        bool try_push(const T& item) { return emplace(item); }
+        bool try_push(T&& item) { return emplace(std::move(item)); }
+
+        template<typename... Args>
+        bool emplace(Args&&... args) {
+            Cell* cell;
+            size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+            for (;;) {
+                cell = &cells_[pos & mask_];
+                size_t seq = cell->sequence.load(std::memory_order_acquire);
+                intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+                if (diff == 0) {
+                    if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+                } else if (diff < 0) {
+                    return false; // full: slot still holds last lap's item
+                } else {
+                    pos = enqueue_pos_.load(std::memory_order_relaxed);
+                }
+            }
+            ::new (static_cast<void*>(cell->storage)) T(std::forward<Args>(args)...);
+            cell->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool try_pop(T& item) {
+            Cell* cell;
+            size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+            for (;;) {
+                cell = &cells_[pos & mask_];
+                size_t seq = cell->sequence.load(std::memory_order_acquire);
+                intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+                if (diff == 0) {
+                    if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+                } else if (diff < 0) {
+                    return false; // empty: producer has not published this slot yet
+                } else {
+                    pos = dequeue_pos_.load(std::memory_order_relaxed);
+                }
+            }
+            T* stored = std::launder(reinterpret_cast<T*>(cell->storage));
+            item = std::move(*stored);
+            stored->~T();
+            cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Approximate while producers/consumers are active
+        size_t size() const {
+            size_t enq = enqueue_pos_.load(std::memory_order_acquire);
+            size_t deq = dequeue_pos_.load(std::memory_order_acquire);
+            return enq > deq ? enq - deq : 0;
+        }
+
+        bool empty() const { return size() == 0; }
+        size_t capacity() const { return capacity_; }
+
+    private:
+        static size_t round_up(size_t capacity) {
+            size_t rounded = 2;
+            while (rounded < capacity) rounded <<= 1;
+            return rounded;
+        }
+
+        struct alignas(64) Cell {
+            std::atomic<size_t> sequence;
+            alignas(T) unsigned char storage[sizeof(T)];
+        };
+
+        const size_t capacity_;
+        const size_t mask_;
+        std::unique_ptr<Cell[]> cells_;
+
+        // Cursors on separate cache lines so producers and consumers do not false-share
+        alignas(64) std::atomic<size_t> enqueue_pos_;
+        alignas(64) std::atomic<size_t> dequeue_pos_;
+    };
+
+}
+
+#endif
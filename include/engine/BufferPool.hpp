@@ -0,0 +1,127 @@
+// include/engine/BufferPool.hpp
+#ifndef CMQ_ENGINE_BUFFER_POOL_HPP
+#define CMQ_ENGINE_BUFFER_POOL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace CMQ {
+
+    // One allocation: this header, then capacity bytes
+    struct Slab {
+        std::atomic<uint32_t> refs{1};
+        size_t capacity = 0;
+        Slab* next = nullptr; // free list link
+
+        char* data() { return reinterpret_cast<char*>(this + 1); }
+    };
+
+    // Counted reference to a slab; the last one dropped hands the slab back
+    // to the pool
+    class SlabRef {
+    public:
+        SlabRef() = default;
+        explicit SlabRef(Slab* slab) : slab_(slab) {} // adopts the slab's reference
+        SlabRef(const SlabRef& other) : slab_(other.slab_) {
+            if (slab_) slab_->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+        SlabRef(SlabRef&& other) noexcept : slab_(std::exchange(other.slab_, nullptr)) {}
+        SlabRef& operator=(SlabRef other) noexcept {
+            std::swap(slab_, other.slab_);
+            return *this;
+        }
+        ~SlabRef() { reset(); }
+
+        void reset();
+
+        char* data() const { return slab_ ? slab_->data() : nullptr; }
+        size_t capacity() const { return slab_ ? slab_->capacity : 0; }
+        bool unique() const { return slab_ && slab_->refs.load(std::memory_order_acquire) == 1; }
+        explicit operator bool() const { return slab_ != nullptr; }
+
+    private:
+        Slab* slab_ = nullptr;
+    };
+
+    // The bytes of one message inside a slab, e.g. a frame the decoder
+    // lifted out of a read. Copying a Payload copies the reference, not the
+    // bytes, so it crosses strands and queues without allocating.
+    class Payload {
+    public:
+        Payload() = default;
+        Payload(SlabRef slab, const char* data, size_t size) : slab_(std::move(slab)), data_(data), size_(size) {}
+        explicit Payload(std::string_view bytes); // copies bytes into a slab of its own
+
+        const char* data() const { return data_; }
+        size_t size() const { return size_; }
+        bool empty() const { return size_ == 0; }
+        std::string_view view() const { return std::string_view(data_, size_); }
+        operator std::string_view() const { return view(); }
+        std::string str() const { return std::string(data_, size_); }
+
+    private:
+        SlabRef slab_;
+        const char* data_ = nullptr;
+        size_t size_ = 0;
+    };
+
+    inline bool operator==(const Payload& payload, std::string_view bytes) { return payload.view() == bytes; }
+    inline std::ostream& operator<<(std::ostream& out, const Payload& payload) { return out << payload.view(); }
+
+    struct BufferPoolStats {
+        size_t allocations = 0; // slabs (pooled or oversized) taken from the heap
+        size_t acquired = 0;    // acquire() calls
+        size_t shared = 0;      // slabs on the shared free list right now
+    };
+
+    // Fixed-size slabs for socket reads to land in. Frames stay in the slab
+    // they arrived in and travel on as Payloads, so a message costs no
+    // allocation or copy between the socket and its handler. Each thread
+    // frees to and takes from its own free list without locking. Slabs
+    // mostly die on the gameplay threads and are born on the I/O ones, so a
+    // list that outgrows its cap passes half to a shared list, and an empty
+    // one refills from it.
+    class BufferPool {
+    public:
+        static constexpr size_t kSlabSize = 16 * 1024;
+
+        static BufferPool& get_instance(); // never destroyed: thread caches return slabs at thread exit
+
+        // A slab of at least min_capacity bytes. Over kSlabSize it is a
+        // one-off allocation, freed instead of pooled.
+        SlabRef acquire(size_t min_capacity = kSlabSize);
+        BufferPoolStats stats() const;
+
+    private:
+        friend class SlabRef;
+        struct ThreadCache;
+
+        BufferPool() = default;
+
+        static void release(Slab* slab);
+        void give_back(Slab* head, Slab* tail, size_t count);
+        size_t take_shared(Slab*& head, size_t max);
+
+        static thread_local ThreadCache thread_cache_;
+
+        Slab* shared_ = nullptr;
+        size_t shared_count_ = 0;
+        mutable std::mutex mutex_;
+        std::atomic<size_t> allocations_{0};
+        std::atomic<size_t> acquired_{0};
+    };
+
+    inline void SlabRef::reset() {
+        if (slab_ && slab_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) BufferPool::release(slab_);
+        slab_ = nullptr;
+    }
+
+}
+
+#endif
@@ -0,0 +1,175 @@
+// include/engine/Coroutine.hpp
+#ifndef CMQ_COROUTINE_HPP
+#define CMQ_COROUTINE_HPP
+
+#include "Dispatcher.hpp"
+#include "TimerWheel.hpp"
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <utility>
+
+namespace CMQ {
+
+    template<typename T = void>
+    class CoTask;
+
+    namespace detail {
+
+        struct CoPromiseBase {
+            std::coroutine_handle<> continuation;
+            std::exception_ptr exception;
+
+            // Hands control straight back to the awaiting coroutine
+            struct FinalAwaiter {
+                bool await_ready() const noexcept { return false; }
+                template<typename Promise>
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) const noexcept {
+                    auto next = handle.promise().continuation;
+                    return next ? next : std::noop_coroutine();
+                }
+                void await_resume() const noexcept {}
+            };
+
+            std::suspend_always initial_suspend() const noexcept { return {}; }
+            FinalAwaiter final_suspend() const noexcept { return {}; }
+            void unhandled_exception() noexcept { exception = std::current_exception(); }
+        };
+
+        template<typename T>
+        struct CoPromise : CoPromiseBase {
+            std::optional<T> value;
+
+            CoTask<T> get_return_object() noexcept;
+            template<typename U>
+            void return_value(U&& result) { value.emplace(std::forward<U>(result)); }
+
+            T take() {
+                if (exception) std::rethrow_exception(exception);
+                return std::move(*value);
+            }
+        };
+
+        template<>
+        struct CoPromise<void> : CoPromiseBase {
+            CoTask<void> get_return_object() noexcept;
+            void return_void() const noexcept {}
+
+            void take() {
+                if (exception) std::rethrow_exception(exception);
+            }
+        };
+
+    }
+
+    // Lazily started coroutine. Awaiting it runs it to completion on the
+    // awaiting thread (until it suspends) and yields its result; co_spawn
+    // detaches one onto a Dispatcher.
+    template<typename T>
+    class [[nodiscard]] CoTask {
+    public:
+        using promise_type = detail::CoPromise<T>;
+        using Handle = std::coroutine_handle<promise_type>;
+
+        CoTask() noexcept = default;
+        explicit CoTask(Handle handle) noexcept : handle_(handle) {}
+        CoTask(CoTask&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+        CoTask& operator=(CoTask&& other) noexcept {
+            if (this != &other) {
+                if (handle_) handle_.destroy();
+                handle_ = std::exchange(other.handle_, {});
+            }
+            return *this;
+        }
+        ~CoTask() {
+            if (handle_) handle_.destroy();
+        }
+
+        CoTask(const CoTask&) = delete;
+        CoTask& operator=(const CoTask&) = delete;
+
+        bool done() const noexcept { return !handle_ || handle_.done(); }
+
+        auto operator co_await() && noexcept {
+            struct Awaiter {
+                Handle handle;
+                bool await_ready() const noexcept { return !handle || handle.done(); }
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+                    handle.promise().continuation = awaiting;
+                    return handle;
+                }
+                T await_resume() { return handle.promise().take(); }
+            };
+            return Awaiter{handle_};
+        }
+
+    private:
+        Handle handle_;
+    };
+
+    namespace detail {
+
+        template<typename T>
+        CoTask<T> CoPromise<T>::get_return_object() noexcept {
+            return CoTask<T>(std::coroutine_handle<CoPromise<T>>::from_promise(*this));
+        }
+
+        inline CoTask<void> CoPromise<void>::get_return_object() noexcept {
+            return CoTask<void>(std::coroutine_handle<CoPromise<void>>::from_promise(*this));
+        }
+
+        // Self-destroying frame that owns a spawned CoTask
+        struct Detached {
+            struct promise_type {
+                Detached get_return_object() const noexcept { return {}; }
+                std::suspend_never initial_suspend() const noexcept { return {}; }
+                std::suspend_never final_suspend() const noexcept { return {}; }
+                void return_void() const noexcept {}
+                void unhandled_exception() const noexcept {}
+            };
+        };
+
+        inline Detached run_detached(Dispatcher& dispatcher, TaskLane lane, CoTask<void> task) {
+            co_await dispatcher.schedule(lane);
+            try {
+                co_await std::move(task);
+            } catch (const std::exception& e) {
+                std::cerr << "Coroutine error: " << e.what() << std::endl;
+            }
+        }
+
+    }
+
+    // Starts task on one of dispatcher's workers and lets it run to completion unattended
+    inline void co_spawn(Dispatcher& dispatcher, CoTask<void> task, TaskLane lane = TaskLane::GameplayTick) {
+        detail::run_detached(dispatcher, lane, std::move(task));
+    }
+
+    // co_await sleep_for(d) suspends without holding a worker; the coroutine
+    // resumes on the wheel's Dispatcher once d has passed
+    struct SleepAwaitable {
+        TimerWheel& wheel;
+        std::chrono::nanoseconds delay;
+        TaskLane lane;
+
+        bool await_ready() const noexcept { return delay.count() <= 0; }
+        void await_suspend(std::coroutine_handle<> handle) const {
+            wheel.schedule(delay, [handle]() { handle.resume(); }, lane);
+        }
+        void await_resume() const noexcept {}
+    };
+
+    inline SleepAwaitable sleep_for(std::chrono::nanoseconds delay, TaskLane lane = TaskLane::GameplayTick) {
+        return SleepAwaitable{TimerWheel::get_instance(), delay, lane};
+    }
+
+    inline SleepAwaitable sleep_for(TimerWheel& wheel, std::chrono::nanoseconds delay,
+                                    TaskLane lane = TaskLane::GameplayTick) {
+        return SleepAwaitable{wheel, delay, lane};
+    }
+
+}
+
+#endif
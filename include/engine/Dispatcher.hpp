@@ -2,41 +2,146 @@
 #ifndef CMQ_DISPATCHER_HPP
 #define CMQ_DISPATCHER_HPP
 
+#include "Task.hpp"
 #include "TaskQueue.hpp"
-#include <deque>
+#include "Stats.hpp"
+#include "WorkStealingQueue.hpp"
 #include <thread>
 #include <vector>
 #include <mutex>
 #include <condition_variable>
-#include <functional>
 #include <memory>
+#include <array>
+#include <atomic>
+#include <coroutine>
+#include <string>
 
 namespace CMQ {
-    using Task = std::function<void()>;
 
+    enum class SchedulingMode {
+        SharedQueue,  // every worker pops from one mutex-guarded TaskQueue
+        WorkStealing  // per-worker deques, shared injection queue, idle workers steal
+    };
+
+    enum class IdleStrategy {
+        Block,        // park on a condition variable as soon as no task is found
+        SpinThenPark  // spin with a CPU pause, then yield, then park
+    };
+
+    // Each worker adapts its spin budget: it doubles (up to spin_iterations)
+    // when spinning found work and halves when the worker had to park anyway.
+    // On a single-CPU machine spinning only delays the producer, so
+    // SpinThenPark parks straight away there.
+    struct IdlePolicy {
+        IdleStrategy strategy = IdleStrategy::Block;
+        uint32_t spin_iterations = 4096; // max pause-instruction polls before yielding
+        uint32_t yield_iterations = 16;  // sched_yield polls before parking
+    };
+
+    struct DispatcherOptions {
+        size_t thread_count = 4;
+        SchedulingMode mode = SchedulingMode::SharedQueue;
+        IdlePolicy idle;
+        std::vector<int> cpus; // worker i is pinned to cpus[i % cpus.size()]; empty leaves workers unpinned
+        int numa_node = -1;    // when cpus is empty, pin workers to this node's CPUs
+        bool collect_stats = true; // per-worker counters and queue-wait/run-time histograms
+    };
+
+    class Dispatcher;
+
+    // co_await dispatcher.schedule() resumes the coroutine on one of the
+    // pool's workers. With the pool stopped the coroutine just continues.
+    struct ScheduleAwaitable {
+        Dispatcher& dispatcher;
+        TaskLane lane;
+
+        bool await_ready() const noexcept;
+        bool await_suspend(std::coroutine_handle<> handle) const;
+        void await_resume() const noexcept {}
+    };
+
+    // A worker pool. Independent pools (e.g. "io" and "sim") keep blocking
+    // socket work off the threads that run gameplay.
     class Dispatcher {
     public:
-        static Dispatcher& get_instance(); // Singleton access method
+        static Dispatcher& get_instance(); // Default pool shared by the engine
+
+        explicit Dispatcher(std::string name = "pool");
+        ~Dispatcher();
 
-        // Deleted copy constructor and assignment operator for Singleton
         Dispatcher(const Dispatcher&) = delete;
         Dispatcher& operator=(const Dispatcher&) = delete;
 
-        void start(size_t thread_count = 4);
+        void start(size_t thread_count = 4, SchedulingMode mode = SchedulingMode::SharedQueue);
+        void start(const DispatcherOptions& options);
         void stop();
-        void dispatch(Task task, bool high_priority = false);
+        // False if the pool is stopped (or stopping) and the task was dropped
+        bool dispatch(Task task, bool high_priority = false); // high priority runs on the NetworkIO lane
+        bool dispatch(Task task, TaskLane lane, Deadline deadline = kNoDeadline);
+        ScheduleAwaitable schedule(TaskLane lane = TaskLane::GameplayTick);
 
-    private:
-        Dispatcher(); // Private constructor for Singleton
-        ~Dispatcher();
+        // Tasks currently queued on a lane (approximate under load; safe to
+        // call from any thread, even while the pool restarts)
+        size_t queue_depth(TaskLane lane) const;
+        void set_lane_weight(TaskLane lane, unsigned weight);
+
+        SchedulingMode mode() const;
+        IdlePolicy idle_policy() const;
+        bool is_running() const;
+        const std::string& name() const;
+        size_t thread_count() const;
+
+        // Aggregate of the per-worker counters since the last start(); the
+        // counters themselves are read lock-free
+        DispatcherStats stats() const;
 
-        void worker_thread();
+        // Stats of every live Dispatcher, default pool included
+        static std::vector<DispatcherStats> all_stats();
 
-        std::shared_ptr<TaskQueue> task_queue_;
+    private:
+        void worker_thread(size_t index, int cpu);
+        void run_shared_queue();
+        void run_work_stealing(size_t index);
+        bool find_task(size_t index, Task& task, TaskInfo& info);
+        bool has_pending_work() const;
+        void wait_for_work(uint32_t& spin_budget);
+        void notify_idle_worker();
+        void execute(Task& task, const TaskInfo& info, size_t index);
+        size_t queue_depth_locked(TaskLane lane) const; // needs stats_mutex_
+
+        const std::string name_;
+        std::shared_ptr<TaskQueue> task_queue_; // shared queue, or injection queue when work stealing
+        std::vector<std::unique_ptr<WorkStealingQueue>> local_queues_;
         std::vector<std::thread> threads_;
         std::atomic<bool> running_;
+        SchedulingMode mode_;
+        IdlePolicy idle_;
+
+        // Queued task count plus spinning and parked workers; kept for work
+        // stealing and for SpinThenPark, where wakes go to parked workers
+        // only when nobody is spinning
+        std::atomic<size_t> pending_;
+        std::atomic<size_t> spinners_;
+        std::atomic<size_t> sleepers_;
+        std::array<unsigned, kTaskLaneCount> lane_weights_;
+
+        bool collect_stats_;
+        std::vector<std::unique_ptr<WorkerCounters>> counters_; // one per worker, replaced on start
+        mutable std::mutex stats_mutex_; // also guards publishing task_queue_ and local_queues_ on start
+        std::mutex idle_mutex_;
+        std::condition_variable idle_cv_;
     };
 
+    inline bool ScheduleAwaitable::await_ready() const noexcept {
+        return !dispatcher.is_running();
+    }
+
+    // A pool that stops between await_ready and here drops the task, so the
+    // coroutine continues on this thread instead of never resuming
+    inline bool ScheduleAwaitable::await_suspend(std::coroutine_handle<> handle) const {
+        return dispatcher.dispatch([handle]() { handle.resume(); }, lane);
+    }
+
 }
 
 #endif
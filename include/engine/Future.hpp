@@ -0,0 +1,429 @@
+// include/engine/Future.hpp
+#ifndef CMQ_FUTURE_HPP
+#define CMQ_FUTURE_HPP
+
+#include "Dispatcher.hpp"
+#include "Task.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace CMQ {
+
+    template<typename T>
+    class Future;
+
+    template<typename T>
+    class Promise;
+
+    namespace detail {
+
+        // void results are stored as monostate so one state type serves both
+        template<typename T>
+        using StoredValue = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+        template<typename T>
+        struct IsFuture : std::false_type {};
+        template<typename T>
+        struct IsFuture<Future<T>> : std::true_type { using value_type = T; };
+
+        template<typename T, typename F>
+        struct ContinuationResult {
+            using type = std::invoke_result_t<F, T>;
+        };
+        template<typename F>
+        struct ContinuationResult<void, F> {
+            using type = std::invoke_result_t<F>;
+        };
+
+        // A continuation returning Future<U> yields Future<U>, not Future<Future<U>>
+        template<typename R>
+        struct Unwrapped {
+            using type = R;
+        };
+        template<typename U>
+        struct Unwrapped<Future<U>> {
+            using type = U;
+        };
+
+        template<typename T>
+        class FutureState {
+        public:
+            using Value = StoredValue<T>;
+
+            void set_value(Value value) {
+                Task continuation;
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    if (ready_) return;
+                    value_.emplace(std::move(value));
+                    ready_ = true;
+                    continuation = std::move(continuation_);
+                }
+                cv_.notify_all();
+                if (continuation) continuation();
+            }
+
+            void set_exception(std::exception_ptr error) {
+                Task continuation;
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    if (ready_) return;
+                    error_ = std::move(error);
+                    ready_ = true;
+                    continuation = std::move(continuation_);
+                }
+                cv_.notify_all();
+                if (continuation) continuation();
+            }
+
+            // Runs continuation on the completing thread, or right here if
+            // the state is already complete
+            void on_ready(Task continuation) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    if (!ready_) {
+                        continuation_ = std::move(continuation);
+                        return;
+                    }
+                }
+                continuation();
+            }
+
+            bool ready() const {
+                std::lock_guard<std::mutex> lock(mutex_);
+                return ready_;
+            }
+
+            void wait() const {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [this]() { return ready_; });
+            }
+
+            // Only called once the state is ready
+            std::exception_ptr exception() const {
+                std::lock_guard<std::mutex> lock(mutex_);
+                return error_;
+            }
+
+            Value take() {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (error_) std::rethrow_exception(error_);
+                return std::move(*value_);
+            }
+
+        private:
+            mutable std::mutex mutex_;
+            mutable std::condition_variable cv_;
+            bool ready_ = false;
+            std::optional<Value> value_;
+            std::exception_ptr error_;
+            Task continuation_;
+        };
+
+        template<typename R, typename Fn>
+        void fulfill(Promise<R>& promise, Fn&& fn);
+
+    }
+
+    // Write side of a Future. Dropping an unfulfilled Promise completes its
+    // Future with std::future_errc::broken_promise.
+    template<typename T>
+    class Promise {
+    public:
+        Promise() : state_(std::make_shared<detail::FutureState<T>>()) {}
+        Promise(Promise&&) noexcept = default;
+        Promise& operator=(Promise&& other) noexcept {
+            if (this != &other) {
+                abandon();
+                state_ = std::move(other.state_);
+            }
+            return *this;
+        }
+        ~Promise() { abandon(); }
+
+        Promise(const Promise&) = delete;
+        Promise& operator=(const Promise&) = delete;
+
+        Future<T> get_future() {
+            return Future<T>(state_);
+        }
+
+        template<typename U = T, typename = std::enable_if_t<!std::is_void_v<U>>>
+        void set_value(U value) {
+            state_->set_value(std::move(value));
+        }
+
+        template<typename U = T, typename = std::enable_if_t<std::is_void_v<U>>>
+        void set_value() {
+            state_->set_value(std::monostate{});
+        }
+
+        void set_exception(std::exception_ptr error) {
+            state_->set_exception(std::move(error));
+        }
+
+    private:
+        void abandon() {
+            if (state_ && !state_->ready()) {
+                state_->set_exception(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+            }
+        }
+
+        std::shared_ptr<detail::FutureState<T>> state_;
+    };
+
+    // Single-consumer result of asynchronous work. then() consumes the
+    // future; continuations never block a worker waiting for a result.
+    template<typename T>
+    class Future {
+    public:
+        using value_type = T;
+
+        Future() = default;
+        explicit Future(std::shared_ptr<detail::FutureState<T>> state) : state_(std::move(state)) {}
+
+        bool valid() const { return state_ != nullptr; }
+        bool is_ready() const { return state_ && state_->ready(); }
+        void wait() const { state_->wait(); }
+
+        // Blocks until ready; rethrows the stored exception
+        T get() {
+            auto state = std::move(state_);
+            state->wait();
+            if constexpr (std::is_void_v<T>) {
+                state->take();
+            } else {
+                return state->take();
+            }
+        }
+
+        // f(value) runs inline on the thread that completes this future (or
+        // on the caller if it is already complete). Use it for cheap glue.
+        template<typename F>
+        auto then(F&& f) {
+            return chain(nullptr, std::forward<F>(f), TaskLane::GameplayTick);
+        }
+
+        // f(value) is dispatched to a pool once this future completes
+        template<typename F>
+        auto then(Dispatcher& dispatcher, F&& f, TaskLane lane = TaskLane::GameplayTick) {
+            return chain(&dispatcher, std::forward<F>(f), lane);
+        }
+
+    private:
+        template<typename U>
+        friend class Future;
+        template<typename U>
+        friend Future<std::vector<U>> when_all(std::vector<Future<U>> futures);
+        friend Future<void> when_all(std::vector<Future<void>> futures);
+        template<typename U>
+        friend auto when_any(std::vector<Future<U>> futures);
+        template<typename R, typename Fn>
+        friend void detail::fulfill(Promise<R>& promise, Fn&& fn);
+
+        template<typename F>
+        auto chain(Dispatcher* dispatcher, F&& f, TaskLane lane) {
+            using R = typename detail::ContinuationResult<T, std::decay_t<F>>::type;
+            using Result = typename detail::Unwrapped<R>::type;
+
+            Promise<Result> promise;
+            Future<Result> result = promise.get_future();
+            auto state = std::move(state_);
+
+            auto run = [state, promise = std::move(promise), f = std::forward<F>(f)]() mutable {
+                if (auto error = state->exception()) {
+                    promise.set_exception(error);
+                    return;
+                }
+                detail::fulfill(promise, [&]() -> R {
+                    if constexpr (std::is_void_v<T>) {
+                        return f();
+                    } else {
+                        return f(state->take());
+                    }
+                });
+            };
+
+            state->on_ready([run = std::move(run), dispatcher, lane]() mutable {
+                if (dispatcher && dispatcher->is_running()) {
+                    dispatcher->dispatch(std::move(run), lane);
+                } else {
+                    run();
+                }
+            });
+            return result;
+        }
+
+        // Completes promise with this future's outcome
+        template<typename R>
+        void forward_to(Promise<R>& promise) {
+            auto state = std::move(state_);
+            state->on_ready([state, promise = std::move(promise)]() mutable {
+                if (auto error = state->exception()) {
+                    promise.set_exception(error);
+                } else if constexpr (std::is_void_v<T>) {
+                    promise.set_value();
+                } else {
+                    promise.set_value(state->take());
+                }
+            });
+        }
+
+        std::shared_ptr<detail::FutureState<T>> state_;
+    };
+
+    namespace detail {
+
+        // Runs fn and stores its result, exception or (for a returned
+        // Future) eventual outcome in promise
+        template<typename R, typename Fn>
+        void fulfill(Promise<R>& promise, Fn&& fn) {
+            using Produced = std::invoke_result_t<Fn>;
+            try {
+                if constexpr (IsFuture<Produced>::value) {
+                    fn().forward_to(promise);
+                } else if constexpr (std::is_void_v<Produced>) {
+                    fn();
+                    promise.set_value();
+                } else {
+                    promise.set_value(fn());
+                }
+            } catch (...) {
+                promise.set_exception(std::current_exception());
+            }
+        }
+
+    }
+
+    template<typename T>
+    Future<T> make_ready_future(T value) {
+        Promise<T> promise;
+        promise.set_value(std::move(value));
+        return promise.get_future();
+    }
+
+    inline Future<void> make_ready_future() {
+        Promise<void> promise;
+        promise.set_value();
+        return promise.get_future();
+    }
+
+    // Runs f on the pool and returns its result as a Future
+    template<typename F>
+    auto submit(Dispatcher& dispatcher, F&& f, TaskLane lane = TaskLane::GameplayTick) {
+        using R = std::invoke_result_t<std::decay_t<F>>;
+        Promise<typename detail::Unwrapped<R>::type> promise;
+        auto result = promise.get_future();
+
+        // A pool that drops the task destroys the promise: the future is then broken
+        dispatcher.dispatch([promise = std::move(promise), f = std::forward<F>(f)]() mutable {
+            detail::fulfill(promise, f);
+        }, lane);
+        return result;
+    }
+
+    // Completes with every value in input order, or with the first exception
+    template<typename T>
+    Future<std::vector<T>> when_all(std::vector<Future<T>> futures) {
+        struct Join {
+            explicit Join(size_t count) : values(count), remaining(count) {}
+            std::vector<std::optional<T>> values; // each slot written by one input only
+            std::atomic<size_t> remaining;
+            std::atomic<bool> failed{false};
+            Promise<std::vector<T>> promise;
+        };
+
+        if (futures.empty()) return make_ready_future(std::vector<T>{});
+
+        auto join = std::make_shared<Join>(futures.size());
+        auto result = join->promise.get_future();
+        for (size_t i = 0; i < futures.size(); ++i) {
+            auto state = std::move(futures[i].state_);
+            state->on_ready([join, state, i]() {
+                if (auto error = state->exception()) {
+                    if (!join->failed.exchange(true)) join->promise.set_exception(error);
+                } else {
+                    join->values[i].emplace(state->take());
+                }
+                if (join->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1 && !join->failed) {
+                    std::vector<T> values;
+                    values.reserve(join->values.size());
+                    for (auto& value : join->values) values.push_back(std::move(*value));
+                    join->promise.set_value(std::move(values));
+                }
+            });
+        }
+        return result;
+    }
+
+    inline Future<void> when_all(std::vector<Future<void>> futures) {
+        struct Join {
+            explicit Join(size_t count) : remaining(count) {}
+            std::atomic<size_t> remaining;
+            std::atomic<bool> failed{false};
+            Promise<void> promise;
+        };
+
+        if (futures.empty()) return make_ready_future();
+
+        auto join = std::make_shared<Join>(futures.size());
+        auto result = join->promise.get_future();
+        for (auto& future : futures) {
+            auto state = std::move(future.state_);
+            state->on_ready([join, state]() {
+                if (auto error = state->exception()) {
+                    if (!join->failed.exchange(true)) join->promise.set_exception(error);
+                }
+                if (join->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1 && !join->failed) {
+                    join->promise.set_value();
+                }
+            });
+        }
+        return result;
+    }
+
+    // Completes with the index (and value) of the first input to finish,
+    // whether it finished with a value or an exception
+    template<typename T>
+    auto when_any(std::vector<Future<T>> futures) {
+        using Result = std::conditional_t<std::is_void_v<T>, size_t, std::pair<size_t, detail::StoredValue<T>>>;
+        struct Race {
+            std::atomic<bool> done{false};
+            Promise<Result> promise;
+        };
+
+        auto race = std::make_shared<Race>();
+        auto result = race->promise.get_future();
+        if (futures.empty()) {
+            race->promise.set_exception(std::make_exception_ptr(std::future_error(std::future_errc::no_state)));
+            return result;
+        }
+
+        for (size_t i = 0; i < futures.size(); ++i) {
+            auto state = std::move(futures[i].state_);
+            state->on_ready([race, state, i]() {
+                if (race->done.exchange(true)) return;
+                if (auto error = state->exception()) {
+                    race->promise.set_exception(error);
+                } else if constexpr (std::is_void_v<T>) {
+                    race->promise.set_value(i);
+                } else {
+                    race->promise.set_value(Result(i, state->take()));
+                }
+            });
+        }
+        return result;
+    }
+
+}
+
+#endif
@@ -1,45 +1,84 @@
 // include/engine/MessageQueue.hpp
 #pragma once
 
-#include <queue>
+#include "BoundedMPMCQueue.hpp"
+#include "RingDeque.hpp"
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
+#include <chrono>
 #include <functional>
+#include <memory>
+#include <span>
+#include <utility>
 #include <vector>
 
 namespace CMQ {
 
+    enum class QueueBackend {
+        Locked,       // FIFO (or comparator-ordered heap) behind a mutex
+        LockFreeRing  // bounded MPMC ring, FIFO only, blocks only when full/empty
+    };
+
     template<typename T>
     class MessageQueue {
     public:
         using Comparator = std::function<bool(const T&, const T&)>;
 
-        // Constructor: optional priority comparator
+        // Constructor: optional priority comparator (FIFO when omitted)
         explicit MessageQueue(size_t capacity, Comparator comp = nullptr);
 
+        // Constructor: FIFO queue on the selected backend
+        MessageQueue(size_t capacity, QueueBackend backend);
+
+        // Blocks while the queue is full. The item is copied or moved into
+        // place; build it as a temporary and pass it as T&& to avoid a copy.
         void push(const T& item);
+        void push(T&& item);
+
+        // Moves every element of items in, blocking for space as needed.
+        // Takes the lock once per batch that fits. Returns the number pushed
+        // (fewer than items.size() only if the queue was closed).
+        size_t push_bulk(std::span<T> items);
+
         bool pop(T& item);       // blocking
         bool try_pop(T& item);   // non-blocking
 
+        // Waits up to timeout for at least one item, then moves up to max_n
+        // items onto the end of out under a single lock. Returns the count.
+        size_t pop_bulk(std::vector<T>& out, size_t max_n, std::chrono::milliseconds timeout);
+
         void close();            // stop the queue
         bool empty() const;
         size_t size() const;
         bool is_closed() const;
+        QueueBackend backend() const;
 
     private:
-        struct DefaultCompare {
-            bool operator()(const T& a, const T& b) const {
-                return false; // FIFO if no comparator provided
-            }
-        };
+        template<typename U> void push_locked(U&& item);
+        template<typename U> bool push_ring(U&& item); // false if the queue closed first: item was not stored
+        void store_locked(T&& item);
+        T take_locked();
+        size_t locked_size() const;
+
+        void notify_ring_consumer(bool all = false);
+        void notify_ring_producer(bool all = false);
 
-        std::priority_queue<T, std::vector<T>, Comparator> queue_;
-        mutable std::mutex mutex_;
-        std::condition_variable cv_;
-        std::atomic<bool> closed_;
         size_t capacity_;
+        QueueBackend backend_;
         Comparator comparator_;
+        RingDeque<T> fifo_;             // locked backend without comparator
+        std::vector<T> heap_;           // locked backend with comparator
+        std::unique_ptr<BoundedMPMCQueue<T>> ring_;
+
+        mutable std::mutex mutex_;
+        std::condition_variable not_empty_;
+        std::condition_variable not_full_;
+        std::atomic<bool> closed_;
+
+        // Ring backend only: threads parked on the fallback condition variables
+        std::atomic<size_t> push_waiters_;
+        std::atomic<size_t> pop_waiters_;
     };
 
 } // namespace CMQ
@@ -0,0 +1,113 @@
+// include/engine/RingDeque.hpp
+#ifndef CMQ_RINGDEQUE_HPP
+#define CMQ_RINGDEQUE_HPP
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace CMQ {
+
+    // Growable circular buffer with deque-style ends. Unlike std::deque it keeps
+    // its storage when drained, so a queue in steady state never allocates.
+    // Not thread-safe; callers guard it with their own mutex.
+    template<typename T>
+    class RingDeque {
+    public:
+        RingDeque() = default;
+        explicit RingDeque(size_t initial_capacity) { reserve(initial_capacity); }
+
+        RingDeque(const RingDeque&) = delete;
+        RingDeque& operator=(const RingDeque&) = delete;
+
+        ~RingDeque() {
+            clear();
+        }
+
+        void push_back(T&& value) {
+            grow_if_full();
+            ::new (slot(head_ + size_)) T(std::move(value));
+            ++size_;
+        }
+
+        void push_front(T&& value) {
+            grow_if_full();
+            head_ = (head_ + capacity_ - 1) & (capacity_ - 1);
+            ::new (slot(head_)) T(std::move(value));
+            ++size_;
+        }
+
+        template<typename... Args>
+        T& emplace_back(Args&&... args) {
+            grow_if_full();
+            T* item = ::new (slot(head_ + size_)) T(std::forward<Args>(args)...);
+            ++size_;
+            return *item;
+        }
+
+        T& front() { return *slot(head_); }
+        T& back() { return *slot(head_ + size_ - 1); }
+
+        void pop_front() {
+            slot(head_)->~T();
+            head_ = (head_ + 1) & (capacity_ - 1);
+            --size_;
+        }
+
+        void pop_back() {
+            slot(head_ + size_ - 1)->~T();
+            --size_;
+        }
+
+        void clear() {
+            while (size_ > 0) pop_front();
+            head_ = 0;
+        }
+
+        void reserve(size_t capacity) {
+            if (capacity > capacity_) reallocate(capacity);
+        }
+
+        bool empty() const { return size_ == 0; }
+        size_t size() const { return size_; }
+        size_t capacity() const { return capacity_; }
+
+    private:
+        T* slot(size_t index) {
+            return std::launder(reinterpret_cast<T*>(storage_.get()) + (index & (capacity_ - 1)));
+        }
+
+        void grow_if_full() {
+            if (size_ == capacity_) reallocate(capacity_ == 0 ? 16 : capacity_ * 2);
+        }
+
+        void reallocate(size_t min_capacity) {
+            size_t capacity = 16;
+            while (capacity < min_capacity) capacity *= 2;
+
+            std::unique_ptr<Storage[]> storage(new Storage[capacity]);
+            T* dst = reinterpret_cast<T*>(storage.get());
+            for (size_t i = 0; i < size_; ++i) {
+                T* src = slot(head_ + i);
+                ::new (dst + i) T(std::move(*src));
+                src->~T();
+            }
+            storage_ = std::move(storage);
+            capacity_ = capacity;
+            head_ = 0;
+        }
+
+        struct alignas(T) Storage {
+            unsigned char bytes[sizeof(T)];
+        };
+
+        std::unique_ptr<Storage[]> storage_;
+        size_t capacity_ = 0; // always zero or a power of two
+        size_t head_ = 0;
+        size_t size_ = 0;
+    };
+
+}
+
+#endif
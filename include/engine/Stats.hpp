@@ -0,0 +1,103 @@
+// include/engine/Stats.hpp
+#ifndef CMQ_STATS_HPP
+#define CMQ_STATS_HPP
+
+#include "TaskQueue.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace CMQ {
+
+    // Counters below have a single writer, so a relaxed load + store replaces
+    // a locked read-modify-write
+    inline void bump_counter(std::atomic<uint64_t>& counter, uint64_t by = 1) {
+        counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    }
+
+    // Merged, read-only copy of one or more LatencyHistograms (values in ns)
+    class HistogramSnapshot {
+    public:
+        HistogramSnapshot();
+
+        void merge(const HistogramSnapshot& other);
+
+        uint64_t count() const { return count_; }
+        uint64_t max() const { return max_; }
+        double mean() const;
+        uint64_t percentile(double q) const; // upper bound of the bucket holding quantile q
+
+    private:
+        friend class LatencyHistogram;
+        std::vector<uint64_t> buckets_;
+        uint64_t count_;
+        uint64_t sum_;
+        uint64_t max_;
+    };
+
+    // Log-linear histogram: 8 sub-buckets per power of two (~12% resolution)
+    // up to 2^40 ns. Written by a single thread with plain relaxed stores,
+    // so recording costs no locked instructions; readers snapshot lock-free.
+    class LatencyHistogram {
+    public:
+        static constexpr unsigned kSubBucketBits = 3;
+        static constexpr unsigned kSubBuckets = 1u << kSubBucketBits;
+        static constexpr unsigned kMaxExponent = 40;
+        static constexpr size_t kBucketCount = (kMaxExponent - kSubBucketBits) * kSubBuckets + 2 * kSubBuckets;
+
+        static size_t bucket_index(uint64_t value);
+        static uint64_t bucket_upper_bound(size_t index);
+
+        void record(uint64_t value); // single writer only
+        void snapshot_into(HistogramSnapshot& snapshot) const;
+
+    private:
+        std::array<std::atomic<uint64_t>, kBucketCount> buckets_{};
+        std::atomic<uint64_t> count_{0};
+        std::atomic<uint64_t> sum_{0};
+        std::atomic<uint64_t> max_{0};
+    };
+
+    // Owned and written by one Dispatcher worker; histograms and per-lane
+    // counts are indexed by TaskLane, which doubles as the task category
+    struct alignas(64) WorkerCounters {
+        std::atomic<uint64_t> executed{0};
+        std::atomic<uint64_t> failed{0};
+        std::atomic<uint64_t> steals{0};
+        std::atomic<uint64_t> parks{0};
+        std::array<LatencyHistogram, kTaskLaneCount> queue_wait; // enqueue -> start
+        std::array<LatencyHistogram, kTaskLaneCount> run_time;
+        std::array<std::atomic<uint64_t>, kTaskLaneCount> lane_executed{};
+        std::array<std::atomic<uint64_t>, kTaskLaneCount> lane_failed{};
+    };
+
+    struct WorkerStats {
+        uint64_t executed = 0;
+        uint64_t failed = 0;
+        uint64_t steals = 0;
+        uint64_t parks = 0;
+    };
+
+    struct LaneStats {
+        size_t depth = 0;
+        uint64_t executed = 0;
+        uint64_t failed = 0;
+        HistogramSnapshot queue_wait;
+        HistogramSnapshot run_time;
+    };
+
+    struct DispatcherStats {
+        std::string name;
+        bool running = false;
+        std::vector<WorkerStats> workers;
+        std::array<LaneStats, kTaskLaneCount> lanes;
+    };
+
+    const char* lane_name(TaskLane lane);
+
+}
+
+#endif
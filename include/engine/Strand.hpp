@@ -0,0 +1,43 @@
+// include/engine/Strand.hpp
+#ifndef CMQ_STRAND_HPP
+#define CMQ_STRAND_HPP
+
+#include "Dispatcher.hpp"
+#include "RingDeque.hpp"
+#include <memory>
+#include <mutex>
+
+namespace CMQ {
+
+    // Serial executor on top of a Dispatcher. Tasks posted to one strand run
+    // one at a time in post order, but may run on any worker, so many
+    // strands (e.g. one per client) still spread across the pool.
+    // Copies share the same queue; queued tasks outlive the last copy.
+    class Strand {
+    public:
+        explicit Strand(Dispatcher& dispatcher, TaskLane lane = TaskLane::GameplayTick);
+
+        void post(Task task);
+        size_t pending() const;
+        bool running_in_this_thread() const;
+
+    private:
+        struct State {
+            State(Dispatcher& dispatcher, TaskLane lane) : dispatcher(dispatcher), lane(lane) {}
+
+            Dispatcher& dispatcher;
+            const TaskLane lane;
+            RingDeque<Task> queue;
+            bool scheduled = false; // a drain task is queued or running
+            mutable std::mutex mutex;
+        };
+
+        static void schedule(const std::shared_ptr<State>& state);
+        static void drain(const std::shared_ptr<State>& state);
+
+        std::shared_ptr<State> state_;
+    };
+
+}
+
+#endif
@@ -0,0 +1,141 @@
+// include/engine/Task.hpp
+#ifndef CMQ_TASK_HPP
+#define CMQ_TASK_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Bytes of capture a Task stores without touching the heap. Set globally
+// through the CMQ_TASK_INLINE_SIZE CMake cache variable so every module agrees.
+#ifndef CMQ_TASK_INLINE_SIZE
+#define CMQ_TASK_INLINE_SIZE 96
+#endif
+
+namespace CMQ {
+
+    // Move-only replacement for std::function<void()> with small-buffer storage.
+    // Callables up to InlineSize bytes (and nothrow-movable) live inside the
+    // task itself; larger ones fall back to a single heap allocation.
+    template<std::size_t InlineSize>
+    class BasicTask {
+    public:
+        static constexpr std::size_t inline_size = InlineSize;
+
+        template<typename F>
+        static constexpr bool fits_inline = sizeof(F) <= InlineSize &&
+                                            alignof(F) <= alignof(std::max_align_t) &&
+                                            std::is_nothrow_move_constructible_v<F>;
+
+        BasicTask() noexcept = default;
+        BasicTask(std::nullptr_t) noexcept {}
+
+        template<typename F,
+                 typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, BasicTask> &&
+                                             std::is_invocable_v<std::decay_t<F>&>>>
+        BasicTask(F&& f) {
+            using Fn = std::decay_t<F>;
+            if constexpr (fits_inline<Fn>) {
+                ::new (static_cast<void*>(storage_)) Fn(std::forward<F>(f));
+                ops_ = &inline_ops<Fn>;
+            } else {
+                ::new (static_cast<void*>(storage_)) Fn*(new Fn(std::forward<F>(f)));
+                heap_allocations_.fetch_add(1, std::memory_order_relaxed);
+                ops_ = &heap_ops<Fn>;
+            }
+        }
+
+        BasicTask(BasicTask&& other) noexcept {
+            move_from(other);
+        }
+
+        BasicTask& operator=(BasicTask&& other) noexcept {
+            if (this != &other) {
+                reset();
+                move_from(other);
+            }
+            return *this;
+        }
+
+        BasicTask& operator=(std::nullptr_t) noexcept {
+            reset();
+            return *this;
+        }
+
+        BasicTask(const BasicTask&) = delete;
+        BasicTask& operator=(const BasicTask&) = delete;
+
+        ~BasicTask() {
+            reset();
+        }
+
+        void operator()() {
+            if (!ops_) throw std::bad_function_call();
+            ops_->invoke(storage_);
+        }
+
+        explicit operator bool() const noexcept {
+            return ops_ != nullptr;
+        }
+
+        void reset() noexcept {
+            if (ops_) {
+                ops_->destroy(storage_);
+                ops_ = nullptr;
+            }
+        }
+
+        // Number of tasks (process-wide, per inline size) whose callable did not fit inline
+        static std::size_t heap_allocations() {
+            return heap_allocations_.load(std::memory_order_relaxed);
+        }
+
+    private:
+        struct Ops {
+            void (*invoke)(void* storage);
+            void (*relocate)(void* dst, void* src) noexcept; // move into dst and destroy src
+            void (*destroy)(void* storage) noexcept;
+        };
+
+        template<typename Fn>
+        static constexpr Ops inline_ops = {
+            [](void* s) { (*std::launder(static_cast<Fn*>(s)))(); },
+            [](void* dst, void* src) noexcept {
+                Fn* from = std::launder(static_cast<Fn*>(src));
+                ::new (dst) Fn(std::move(*from));
+                from->~Fn();
+            },
+            [](void* s) noexcept { std::launder(static_cast<Fn*>(s))->~Fn(); }
+        };
+
+        template<typename Fn>
+        static constexpr Ops heap_ops = {
+            [](void* s) { (**std::launder(static_cast<Fn**>(s)))(); },
+            [](void* dst, void* src) noexcept {
+                ::new (dst) Fn*(*std::launder(static_cast<Fn**>(src)));
+            },
+            [](void* s) noexcept { delete *std::launder(static_cast<Fn**>(s)); }
+        };
+
+        void move_from(BasicTask& other) noexcept {
+            if (other.ops_) {
+                other.ops_->relocate(storage_, other.storage_);
+                ops_ = other.ops_;
+                other.ops_ = nullptr;
+            }
+        }
+
+        alignas(std::max_align_t) unsigned char storage_[InlineSize < sizeof(void*) ? sizeof(void*) : InlineSize];
+        const Ops* ops_ = nullptr;
+
+        inline static std::atomic<std::size_t> heap_allocations_{0};
+    };
+
+    using Task = BasicTask<CMQ_TASK_INLINE_SIZE>;
+
+}
+
+#endif
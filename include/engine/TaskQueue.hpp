@@ -2,30 +2,89 @@
 #ifndef CMQ_TASKQUEUE_HPP
 #define CMQ_TASKQUEUE_HPP
 
-#include <deque>
+#include "Task.hpp"
+#include "RingDeque.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <mutex>
 #include <condition_variable>
-#include <functional>
+#include <vector>
 
 namespace CMQ {
-    using Task = std::function<void()>;
+
+    // Scheduling lanes, each with its own weight in the fair selection between lanes
+    enum class TaskLane : uint8_t {
+        NetworkIO,    // socket reads/writes and decoded network messages
+        GameplayTick, // simulation work; the default lane
+        Heartbeat,    // liveness pings and timeouts
+        Background,   // maintenance and bulk work
+        Count
+    };
+
+    constexpr size_t kTaskLaneCount = static_cast<size_t>(TaskLane::Count);
+
+    using Deadline = std::chrono::steady_clock::time_point;
+    constexpr Deadline kNoDeadline = Deadline::max();
+
+    // Where a queued task came from, handed to the worker that runs it
+    struct TaskInfo {
+        TaskLane lane = TaskLane::GameplayTick;
+        std::chrono::steady_clock::time_point enqueued{}; // epoch when not stamped
+    };
 
     class TaskQueue {
     public:
         TaskQueue();
         ~TaskQueue();
 
-        void push(Task task, bool high_priority = false);
-        bool pop(Task& task);
-        bool try_pop(Task& task);
+        // Legacy two-level API: high priority maps to the NetworkIO lane
+        bool push(Task task, bool high_priority = false);
+
+        // Tasks with a deadline run earliest-deadline-first ahead of the
+        // lane's deadline-less tasks, which run FIFO. False once the queue
+        // is closed: the task is dropped.
+        bool push(Task task, TaskLane lane, Deadline deadline = kNoDeadline);
+
+        bool pop(Task& task, TaskInfo* info = nullptr);
+        bool try_pop(Task& task, TaskInfo* info = nullptr);
         void close();
         bool empty() const;
 
+        size_t depth(TaskLane lane) const; // lock-free readout
+        void set_weight(TaskLane lane, unsigned weight);
+        unsigned weight(TaskLane lane) const;
+
+        // Stamp entries with their enqueue time, reported through TaskInfo
+        void set_record_enqueue_time(bool enabled);
+
     private:
-        std::deque<Task> queue_;
+        struct Entry {
+            Task task;
+            Deadline deadline;
+            uint64_t sequence; // FIFO tie-break between equal deadlines
+            std::chrono::steady_clock::time_point enqueued;
+        };
+
+        struct Lane {
+            RingDeque<Entry> fifo;
+            std::vector<Entry> deadlines; // min-heap on (deadline, sequence)
+            unsigned weight = 1;
+            int64_t credit = 0;           // smooth weighted round-robin state
+            std::atomic<size_t> depth{0};
+        };
+
+        Lane* select_lane();
+        void take(Lane& lane, Task& task, TaskInfo* info);
+
+        std::array<Lane, kTaskLaneCount> lanes_;
+        size_t size_;
+        uint64_t sequence_;
         mutable std::mutex mutex_;
         std::condition_variable cv_;
         bool closed_;
+        std::atomic<bool> record_enqueue_time_;
     };
 }
 
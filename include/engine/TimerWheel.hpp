@@ -0,0 +1,92 @@
+// include/engine/TimerWheel.hpp
+#ifndef CMQ_TIMERWHEEL_HPP
+#define CMQ_TIMERWHEEL_HPP
+
+#include "Dispatcher.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace CMQ {
+
+    // Hierarchical timing wheel (4 levels x 256 slots). Schedule, cancel and
+    // reschedule are O(1); one driver thread sleeps until the next occupied
+    // slot and fires due callbacks onto a Dispatcher.
+    class TimerWheel {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        struct Timer;
+        using TimerHandle = std::shared_ptr<Timer>;
+
+        static TimerWheel& get_instance(); // Default wheel (1 ms ticks) on the default Dispatcher
+
+        explicit TimerWheel(Dispatcher& dispatcher, std::chrono::nanoseconds tick = std::chrono::milliseconds(1));
+        ~TimerWheel();
+
+        TimerWheel(const TimerWheel&) = delete;
+        TimerWheel& operator=(const TimerWheel&) = delete;
+
+        // One-shot timer firing after delay
+        TimerHandle schedule(std::chrono::nanoseconds delay, Task callback, TaskLane lane = TaskLane::GameplayTick);
+
+        // Periodic timer; successive expiries are interval apart and do not drift
+        TimerHandle schedule_periodic(std::chrono::nanoseconds interval, Task callback,
+                                      TaskLane lane = TaskLane::GameplayTick);
+
+        // After cancel() returns the callback is not running (unless cancel is
+        // called from inside it) and will not start again
+        void cancel(const TimerHandle& timer);
+
+        // Moves a pending or already-fired timer to fire after delay.
+        // Returns false if the timer was cancelled.
+        bool reschedule(const TimerHandle& timer, std::chrono::nanoseconds delay);
+
+        size_t active_timers() const;
+        std::chrono::nanoseconds tick() const;
+
+    private:
+        static constexpr size_t kLevels = 4;
+        static constexpr size_t kSlotBits = 8;
+        static constexpr size_t kSlots = size_t(1) << kSlotBits;
+        static constexpr uint64_t kSlotMask = kSlots - 1;
+
+        TimerHandle arm(std::chrono::nanoseconds delay, std::chrono::nanoseconds interval, Task callback, TaskLane lane);
+        uint64_t ticks_for(std::chrono::nanoseconds duration) const;
+        uint64_t now_tick() const;
+        Clock::time_point time_of(uint64_t tick) const;
+
+        void link(Timer* timer);
+        void unlink(Timer* timer);
+        void advance(std::vector<TimerHandle>& expired);
+        void cascade(size_t level);
+        uint64_t next_wakeup_tick() const;
+        void wake_if_earlier(uint64_t expiry);
+
+        void run();
+        void fire(std::vector<TimerHandle>& expired);
+
+        Dispatcher& dispatcher_;
+        const std::chrono::nanoseconds tick_;
+        const Clock::time_point start_;
+
+        std::array<std::array<Timer*, kSlots>, kLevels> slots_{};
+        uint64_t current_;     // last tick processed
+        uint64_t next_wakeup_; // tick the driver thread is sleeping until
+        size_t active_;
+
+        mutable std::mutex mutex_;
+        std::condition_variable cv_;
+        bool running_;
+        std::thread thread_;
+    };
+
+}
+
+#endif
@@ -0,0 +1,46 @@
+// include/engine/WorkStealingQueue.hpp
+#ifndef CMQ_WORKSTEALINGQUEUE_HPP
+#define CMQ_WORKSTEALINGQUEUE_HPP
+
+#include "Task.hpp"
+#include "TaskQueue.hpp"
+#include "RingDeque.hpp"
+#include <mutex>
+#include <atomic>
+
+namespace CMQ {
+
+    // Per-worker deque used by the work-stealing Dispatcher mode.
+    // Unlike the usual LIFO owner, the owning worker runs its tasks oldest
+    // first, like TaskQueue: a GameplayTick task that re-dispatches itself
+    // would otherwise run again ahead of everything it spawned before and
+    // starve it. Thieves take the newest task, the one the owner would
+    // reach last. Both ends share one mutex, so the choice of end is about
+    // order, not contention.
+    class WorkStealingQueue {
+    public:
+        WorkStealingQueue();
+
+        // enqueued is reported back through TaskInfo (lane is always GameplayTick)
+        void push(Task task, bool high_priority = false, std::chrono::steady_clock::time_point enqueued = {});
+        bool pop(Task& task, TaskInfo* info = nullptr);    // owner side, FIFO (high priority first)
+        bool steal(Task& task, TaskInfo* info = nullptr);  // thief side, takes the newest task (last in the owner's order)
+        void clear();
+
+        size_t size() const;     // approximate, lock-free
+        bool empty() const;
+
+    private:
+        struct Entry {
+            Task task;
+            std::chrono::steady_clock::time_point enqueued;
+        };
+
+        RingDeque<Entry> queue_;
+        mutable std::mutex mutex_;
+        std::atomic<size_t> size_;
+    };
+
+}
+
+#endif
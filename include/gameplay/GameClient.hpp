@@ -11,14 +11,27 @@ namespace CMQ {
 
     class GameClient : public NetworkClient {
     public:
-        GameClient(const std::string &server_ip, int port, ProtocolType protocol, bool use_ssl = false);
+        GameClient(const std::string &server_ip, int port, ProtocolType protocol, bool use_ssl = false,
+                   std::shared_ptr<Dispatcher> io_dispatcher = nullptr);
 
         void register_commands();
-        void send_command(const std::string &command, const std::string &params);
+        void send_command(const std::string &command, const std::string &params); // params in text form, e.g. "100 200"
+        void set_command_encoding(CommandEncoding encoding); // must match the server's
+
+        // The message send_command(command, params) sends in encoding;
+        // false if the command is unknown or params don't parse
+        static bool encode_command(const std::string &command, std::string_view params, CommandEncoding encoding,
+                                   std::string &message);
+
+        template<typename Message>
+        void send_command(const Message& message) {
+            send_message(encode_message(message));
+        }
         void receive_message_async();
 
     private:
         std::unordered_map<std::string, std::shared_ptr<Command>> command_registry_;
+        CommandEncoding command_encoding_ = CommandEncoding::Binary;
     };
 
 }
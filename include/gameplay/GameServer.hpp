@@ -5,16 +5,27 @@
 #include "network/NetworkServer.hpp"
 #include "gameplay/GameplaySystem.hpp"
 #include <memory>
+#include <string_view>
 
 namespace CMQ {
 
     class GameServer : public NetworkServer {
     public:
-        GameServer(int port, std::shared_ptr<MessageQueue<std::string>> queue, ProtocolType protocol, bool use_ssl = false);
-        void handle_player_message(int client_fd, const std::string &message);
+        GameServer(int port, std::shared_ptr<MessageQueue<Payload>> queue, ProtocolType protocol, bool use_ssl = false,
+                   std::shared_ptr<Dispatcher> io_dispatcher = nullptr, IoBackend backend = IoBackend::Epoll);
+        ~GameServer() override;
+
+        void handle_player_message(int client_fd, std::string_view message);
+
+        // Call before start(); Text accepts "move 100 200" style commands
+        void set_command_encoding(CommandEncoding encoding);
+
+    protected:
+        void handle_message(int client_fd, const Payload &message) override;
 
     private:
         std::shared_ptr<GameplaySystem> gameplay_system_;
+        CommandEncoding command_encoding_ = CommandEncoding::Binary;
     };
 
 }
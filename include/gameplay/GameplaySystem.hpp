@@ -5,30 +5,39 @@
 #include "EventBus.hpp"
 #include "RateLimiter.hpp"
 #include "commands/CommandFactory.hpp"
+#include <functional>
 #include <memory>
-#include <unordered_map>
 #include <string>
-#include <mutex>
+#include <string_view>
 
 namespace CMQ {
 
+    // Where GameplaySystem's messages go; GameServer points it at its
+    // clients. Without one they are only logged.
+    struct MessageOutlet {
+        std::function<bool(int client_id, std::string message)> send;
+        std::function<size_t(std::string message)> broadcast; // every connected player
+    };
+
     class GameplaySystem {
     public:
         GameplaySystem();
         void initialize();
         void handle_event(const std::string& event_name, const std::string& data);
         void execute_command(const std::string& command_name, const std::string& params, const std::string& client_id);
+        void execute_command(int client_id, std::string_view payload); // binary: opcode + fields
+
+        void set_outlet(MessageOutlet outlet); // before any command runs
 
         // New message methods for commands
-        void broadcast_message(const std::string& message);
-        void send_message(const std::string& client_id, const std::string& message);
+        void broadcast_message(std::string message);
+        void send_message(int client_id, std::string message);
+        void send_message(const std::string& client_id, const std::string& message); // text ids
 
     private:
+        MessageOutlet outlet_;
         std::shared_ptr<EventBus> event_bus_;
         std::shared_ptr<RateLimiter> rate_limiter_;
-        std::unordered_map<std::string, std::shared_ptr<Command>> command_registry_;
-        std::unordered_map<int, std::string> player_map_; // Player state (client ID -> player name)
-        std::mutex player_map_mutex_;
     };
 
 }
@@ -2,13 +2,11 @@
 #ifndef CMQ_RATELIMITER_HPP
 #define CMQ_RATELIMITER_HPP
 
+#include "engine/TimerWheel.hpp"
 #include <unordered_map>
 #include <list>
 #include <chrono>
 #include <mutex>
-#include <thread>
-#include <string>
-#include <atomic>
 
 namespace CMQ {
 
@@ -17,7 +15,7 @@ namespace CMQ {
         RateLimiter(int max_requests, double time_window, size_t max_clients = 1000);
         ~RateLimiter();
 
-        bool allow_request(const std::string& client_id);
+        bool allow_request(int client_id);
 
     private:
         void cleanup_expired_clients();
@@ -27,15 +25,14 @@ namespace CMQ {
         double time_window_;
         size_t max_clients_;
 
-        using LRUList = std::list<std::string>;
+        using LRUList = std::list<int>;
         using ClientRecord = std::pair<int, std::chrono::steady_clock::time_point>;
 
-        std::unordered_map<std::string, std::pair<ClientRecord, LRUList::iterator>> request_records_;
+        std::unordered_map<int, std::pair<ClientRecord, LRUList::iterator>> request_records_;
         LRUList lru_list_;
 
         std::mutex mutex_;
-        std::atomic<bool> running_;
-        std::thread cleanup_thread_;
+        TimerWheel::TimerHandle cleanup_timer_; // periodic expiry sweep
     };
 
 } // namespace CMQ
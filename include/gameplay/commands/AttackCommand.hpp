@@ -3,14 +3,23 @@
 #define CMQ_ATTACKCOMMAND_HPP
 
 #include "Command.hpp"
+#include <cstdint>
 #include <string>
+#include <string_view>
 
 namespace CMQ {
     class GameplaySystem; // Forward declaration
 
-    class AttackCommand : public Command {
-    public:
-        void execute(GameplaySystem* system, int client_id, const std::string& params) override;
+    struct AttackMessage {
+        static constexpr uint16_t kOpcode = 3;
+        std::string_view target;
+
+        static bool visit(auto& self, auto& field) { return field(self.target); }
+    };
+
+    class AttackCommand : public CommandOf<AttackMessage> {
+    protected:
+        void run(GameplaySystem* system, int client_id, const AttackMessage& message) override;
 
     private:
         static bool registered;
@@ -3,14 +3,23 @@
 #define CMQ_CHATCOMMAND_HPP
 
 #include "Command.hpp"
+#include <cstdint>
 #include <string>
+#include <string_view>
 
 namespace CMQ {
     class GameplaySystem; // Forward declaration
 
-    class ChatCommand : public Command {
-    public:
-        void execute(GameplaySystem* system, int client_id, const std::string& params) override;
+    struct ChatMessage {
+        static constexpr uint16_t kOpcode = 2;
+        std::string_view text;
+
+        static bool visit(auto& self, auto& field) { return field(self.text); }
+    };
+
+    class ChatCommand : public CommandOf<ChatMessage> {
+    protected:
+        void run(GameplaySystem* system, int client_id, const ChatMessage& message) override;
 
     private:
         static bool registered;
@@ -2,22 +2,74 @@
 #ifndef CMQ_COMMAND_HPP
 #define CMQ_COMMAND_HPP
 
+#include "network/WireCodec.hpp"
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <memory>
 
 
 namespace CMQ {
     class GameplaySystem;
 
+    // How commands travel inside a frame. Text ("move 100 200") is a
+    // debugging aid; servers and clients default to Binary.
+    enum class CommandEncoding { Binary, Text };
+
     class Command {
     public:
         virtual ~Command() = default;
-        virtual void execute(GameplaySystem* system, int client_id, const std::string& params) = 0;
+
+        virtual uint16_t opcode() const = 0;
+
+        // fields is the binary payload after the opcode, still in the
+        // receive buffer. Returns false if it does not decode.
+        virtual bool execute(GameplaySystem* system, int client_id, std::string_view fields) = 0;
+
+        // Debug text form of the fields, e.g. "100 200" for move
+        virtual bool execute_text(GameplaySystem* system, int client_id, std::string_view params) = 0;
+
+        // Appends the binary message (opcode included) for text params
+        virtual bool encode_text(std::string_view params, std::string& out) const = 0;
 
         // Factory method for automatic registration
         static void register_command(const std::string& name, std::shared_ptr<Command> command);
     };
 
+    // Implements the wire handling once for every command from its message
+    // type (see WireCodec.hpp); subclasses only act on the decoded message
+    template<typename Message>
+    class CommandOf : public Command {
+    public:
+        uint16_t opcode() const override {
+            return Message::kOpcode;
+        }
+
+        bool execute(GameplaySystem* system, int client_id, std::string_view fields) override {
+            Message message;
+            if (!decode_fields(fields, message)) return false;
+            run(system, client_id, message);
+            return true;
+        }
+
+        bool execute_text(GameplaySystem* system, int client_id, std::string_view params) override {
+            Message message;
+            if (!parse_text_fields(params, message)) return false;
+            run(system, client_id, message);
+            return true;
+        }
+
+        bool encode_text(std::string_view params, std::string& out) const override {
+            Message message;
+            if (!parse_text_fields(params, message)) return false;
+            append_message(out, message);
+            return true;
+        }
+
+    protected:
+        virtual void run(GameplaySystem* system, int client_id, const Message& message) = 0;
+    };
+
 }
 
 #endif
@@ -2,9 +2,11 @@
 #ifndef CMQ_COMMAND_FACTORY_HPP
 #define CMQ_COMMAND_FACTORY_HPP
 
+#include <cstdint>
 #include <unordered_map>
 #include <memory>
 #include <string>
+#include <vector>
 #include "Command.hpp"
 
 namespace CMQ {
@@ -12,6 +14,7 @@ namespace CMQ {
     public:
         static CommandFactory& get_instance();
         std::shared_ptr<Command> create_command(const std::string& command_name);
+        Command* find_command(uint16_t opcode) const; // nullptr if unknown; no lookup by name, no refcount
         const std::unordered_map<std::string, std::shared_ptr<Command>>& get_registered_commands() const;
 
         // Register a command (called by each Command subclass)
@@ -20,6 +23,7 @@ namespace CMQ {
     private:
         CommandFactory() = default;
         std::unordered_map<std::string, std::shared_ptr<Command>> command_registry_;
+        std::vector<Command*> by_opcode_; // indexed by opcode; filled during static registration only
     };
 }
 
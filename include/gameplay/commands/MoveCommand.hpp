@@ -3,14 +3,24 @@
 #define CMQ_MOVECOMMAND_HPP
 
 #include "Command.hpp"
+#include <cstdint>
 #include <string>
+#include <string_view>
 
 namespace CMQ {
     class GameplaySystem; // Forward declaration
 
-    class MoveCommand : public Command {
-    public:
-        void execute(GameplaySystem* system, int client_id, const std::string& params) override;
+    struct MoveMessage {
+        static constexpr uint16_t kOpcode = 1;
+        int32_t x = 0;
+        int32_t y = 0;
+
+        static bool visit(auto& self, auto& field) { return field(self.x) && field(self.y); }
+    };
+
+    class MoveCommand : public CommandOf<MoveMessage> {
+    protected:
+        void run(GameplaySystem* system, int client_id, const MoveMessage& message) override;
 
     private:
         static bool registered;
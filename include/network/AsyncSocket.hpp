@@ -0,0 +1,34 @@
+// include/network/AsyncSocket.hpp
+#ifndef CMQ_NETWORK_ASYNC_SOCKET_HPP
+#define CMQ_NETWORK_ASYNC_SOCKET_HPP
+
+#include "engine/Coroutine.hpp"
+#include "network/Reactor.hpp"
+#include <span>
+#include <sys/types.h>
+
+namespace CMQ {
+
+    // Non-blocking view of a connected socket for coroutine code. read and
+    // write suspend on the Reactor while the socket would block. They return
+    // the bytes transferred, 0 on EOF, or -errno. The fd is not owned.
+    class AsyncSocket {
+    public:
+        AsyncSocket(int fd, Reactor& reactor);
+
+        CoTask<ssize_t> read(std::span<char> buffer);
+        ssize_t try_read(std::span<char> buffer); // never suspends: -EAGAIN when nothing is waiting
+        Reactor::IoAwaitable readable();          // only after try_read returned -EAGAIN
+        CoTask<ssize_t> write(std::span<const char> buffer);  // at least one byte unless an error occurs
+        CoTask<ssize_t> write_all(std::span<const char> buffer);
+
+        int fd() const;
+
+    private:
+        int fd_;
+        Reactor& reactor_;
+    };
+
+}
+
+#endif
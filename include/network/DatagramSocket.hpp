@@ -0,0 +1,80 @@
+// include/network/DatagramSocket.hpp
+#ifndef CMQ_NETWORK_DATAGRAM_SOCKET_HPP
+#define CMQ_NETWORK_DATAGRAM_SOCKET_HPP
+
+#include <array>
+#include <memory>
+#include <netinet/in.h>
+#include <span>
+#include <string>
+#include <string_view>
+#include <sys/socket.h>
+#include <vector>
+
+namespace CMQ {
+
+    struct Datagram {
+        sockaddr_in peer;
+        std::string_view data; // points into the socket's receive buffers
+    };
+
+    struct OutgoingDatagram {
+        sockaddr_in peer;
+        std::string data;
+        std::shared_ptr<const std::string> shared; // instead of data: one payload sent to many peers
+
+        std::string_view bytes() const { return shared ? std::string_view(*shared) : std::string_view(data); }
+    };
+
+    // Batched I/O on a non-blocking UDP socket: one recvmmsg or sendmmsg
+    // moves up to kBatch datagrams. With offload (Linux 5.0+) the kernel
+    // may hand over a run of same-size datagrams from one peer as a single
+    // buffer (UDP_GRO), which receive() splits again, and send() passes runs
+    // to one peer down as one buffer (UDP_SEGMENT). The fd is not owned;
+    // receive and send may run concurrently, but neither with itself.
+    class DatagramSocket {
+    public:
+        static constexpr size_t kBatch = 32;
+
+        DatagramSocket(int fd, bool offload);
+
+        DatagramSocket(const DatagramSocket&) = delete;
+        DatagramSocket& operator=(const DatagramSocket&) = delete;
+
+        int fd() const;
+        bool offload() const; // false when the kernel refused it
+
+        // Appends what one recvmmsg returned; the views stay valid until the
+        // next receive. Returns the datagram count, or -errno (-EAGAIN when
+        // nothing is waiting).
+        int receive(std::vector<Datagram>& out);
+
+        // Returns how many datagrams went out; stops at the first error, e.g.
+        // a full socket buffer, and leaves its errno in error (0 when all
+        // went out). The datagram it stopped at is the first one not sent.
+        size_t send(std::span<const OutgoingDatagram> datagrams, int& error);
+
+    private:
+        struct Control {
+            alignas(cmsghdr) char data[CMSG_SPACE(sizeof(int))];
+        };
+
+        int fd_;
+        bool gro_;
+        bool gso_;
+        size_t slot_size_;
+
+        std::vector<char> receive_buffers_;
+        std::array<mmsghdr, kBatch> receive_headers_;
+        std::array<iovec, kBatch> receive_iovecs_;
+        std::array<sockaddr_in, kBatch> receive_peers_;
+        std::array<Control, kBatch> receive_control_;
+
+        std::array<mmsghdr, kBatch> send_headers_;
+        std::vector<iovec> send_iovecs_;
+        std::array<Control, kBatch> send_control_;
+    };
+
+}
+
+#endif
@@ -0,0 +1,65 @@
+// include/network/Framing.hpp
+#ifndef CMQ_NETWORK_FRAMING_HPP
+#define CMQ_NETWORK_FRAMING_HPP
+
+#include "engine/BufferPool.hpp"
+#include <cstddef>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace CMQ {
+
+    // TCP is a byte stream: writes coalesce and split in flight, so every
+    // message travels as a varint (LEB128) payload length followed by the
+    // payload. Datagram transports need no framing.
+    constexpr size_t kMaxFrameSize = 1 << 20;
+
+    void append_frame(std::string& out, std::string_view payload);
+    std::string encode_frame(std::string_view payload);
+
+    // Per-connection reassembly buffer. Reads land directly in the free
+    // tail of a pooled slab (prepare/commit); drain() then lifts out every
+    // complete frame at once, as Payloads that share the slab. Later reads
+    // fill the rest of the slab. When it runs out, the partial frame moves
+    // to the front, or to a fresh slab if drained frames still hold this
+    // one. So a frame is always contiguous, and only bytes of a frame that
+    // spans two reads are ever copied. A frame larger than a slab gets a
+    // buffer of its own, grown by doubling.
+    class FrameDecoder {
+    public:
+        explicit FrameDecoder(size_t max_frame = kMaxFrameSize);
+
+        std::span<char> prepare(size_t min_space = 4096); // writable space after the buffered bytes
+        void commit(size_t bytes);                        // bytes written into the last prepare()
+        void feed(std::string_view bytes);                // prepare + copy + commit
+
+        // Appends the payload of every complete frame buffered so far.
+        // Returns false once the stream is corrupt (a malformed header or a
+        // frame over max_frame); the connection should then be dropped.
+        bool drain(std::vector<Payload>& frames);
+        bool drain(std::vector<std::string>& frames); // copies each frame out
+
+        // Drops the slab if nothing is buffered, so a connection waiting
+        // for its next read holds none
+        void release();
+
+        size_t buffered() const;
+        size_t carried() const; // bytes copied to keep partial frames contiguous
+
+    private:
+        bool next_frame(size_t& offset, size_t& length); // steps past the next complete frame
+        void rewind();
+
+        SlabRef slab_;
+        size_t begin_ = 0; // first unconsumed byte
+        size_t end_ = 0;   // one past the last buffered byte
+        size_t max_frame_;
+        size_t carried_ = 0;
+        bool corrupt_ = false;
+    };
+
+}
+
+#endif
@@ -0,0 +1,78 @@
+// include/network/HeartbeatTable.hpp
+#ifndef CMQ_NETWORK_HEARTBEAT_TABLE_HPP
+#define CMQ_NETWORK_HEARTBEAT_TABLE_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace CMQ {
+
+    struct HeartbeatOptions {
+        std::chrono::milliseconds timeout{10000}; // silence after which a client is dropped
+        std::chrono::milliseconds interval{1000}; // how often deadlines are checked; a drop may come this much late
+    };
+
+    // Liveness of every connection, keyed by a small non-negative id (a
+    // socket fd or a UDP session id). Each id has a slot holding when it
+    // was last heard from, so touch() is one atomic store and never locks.
+    // Deadlines sit in a ring of buckets one interval wide: expire() only
+    // walks the buckets that came due, and a connection heard from since it
+    // was filed moves to the bucket of its new deadline instead.
+    class HeartbeatTable {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        explicit HeartbeatTable(HeartbeatOptions options = {});
+        ~HeartbeatTable();
+
+        HeartbeatTable(const HeartbeatTable&) = delete;
+        HeartbeatTable& operator=(const HeartbeatTable&) = delete;
+
+        // Starts id's timeout; an id already tracked is just touched.
+        // False if id is out of range.
+        bool track(int id, Clock::time_point now = Clock::now());
+        void touch(int id, Clock::time_point now = Clock::now());
+        void forget(int id); // lock-free; its bucket entry is dropped when the bucket comes due
+        bool tracked(int id) const;
+
+        // Appends the ids whose timeout has passed and stops tracking them
+        void expire(std::vector<int>& expired, Clock::time_point now = Clock::now());
+
+        const HeartbeatOptions& options() const;
+
+    private:
+        static constexpr size_t kChunkBits = 12; // slots are allocated 4096 at a time
+        static constexpr size_t kChunkSize = size_t(1) << kChunkBits;
+        static constexpr size_t kMaxChunks = 1024; // ids below 4M
+
+        struct Slot {
+            std::atomic<int64_t> last_seen{0};    // Clock nanoseconds
+            std::atomic<uint32_t> generation{0}; // odd while tracked
+        };
+
+        // A bucket entry only counts while the slot's generation still matches
+        struct Entry {
+            int id;
+            uint32_t generation;
+        };
+
+        Slot* slot(int id) const; // nullptr until a chunk holds id
+        int64_t bucket_index(int64_t deadline) const; // first interval at or after deadline
+
+        const HeartbeatOptions options_;
+        const int64_t timeout_ns_;
+        const int64_t interval_ns_;
+
+        std::array<std::atomic<Slot*>, kMaxChunks> chunks_{};
+        std::vector<std::vector<Entry>> buckets_; // bucket i holds deadlines in intervals == i mod size
+        int64_t cursor_;  // next interval to check
+        std::mutex mutex_; // guards buckets_, cursor_ and chunk allocation; touch() never takes it
+    };
+
+}
+
+#endif
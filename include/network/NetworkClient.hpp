@@ -3,8 +3,12 @@
 #define CMQ_NETWORK_CLIENT_HPP
 
 #include "engine/Dispatcher.hpp"
+#include "engine/TimerWheel.hpp"
+#include "network/Framing.hpp"
+#include "network/OutboundQueue.hpp"
 #include "network/ProtocolType.hpp"
 #include <string>
+#include <chrono>
 #include <memory>
 #include <atomic>
 #include <thread>
@@ -25,44 +29,96 @@
 
 namespace CMQ {
 
+    // How a client batches what it sends. Every message joins one ordered
+    // queue per connection; a single writer drains it, so a burst goes out
+    // in as few writes as the socket allows.
+    struct SendOptions {
+        // The writer starts this long after the first message of a burst, so
+        // the messages behind it share its write. Zero writes at once; other
+        // values round up to the timer wheel's tick.
+        std::chrono::microseconds flush_window{0};
+        bool no_delay = true; // TCP_NODELAY: don't hold small writes back until the last one is acknowledged
+        bool cork = false;    // TCP_CORK while the writer runs: only full segments leave until it is done
+    };
+
     class NetworkClient {
     public:
-        NetworkClient(const std::string &server_ip, int port, ProtocolType protocol, bool use_ssl = false);
+        NetworkClient(const std::string &server_ip, int port, ProtocolType protocol, bool use_ssl = false,
+                      std::shared_ptr<Dispatcher> dispatcher = nullptr);
         ~NetworkClient();
 
+        void set_send_options(const SendOptions& options); // before connect_server()
         bool connect_server();
-        void disconnect();
+        void disconnect(); // waits for the receive_message_async reader to stop
         bool is_connected() const;
 
-        void send_message(const std::string &message);
+        // TLS resumption: the latest session or ticket from the server is
+        // offered on every reconnect
+        bool has_tls_session() const;
+        bool tls_session_reused() const; // the last handshake was abbreviated
+
+        void send_message(const std::string &message); // framed over TCP, one datagram over UDP; sent in call order
         void receive_message_async();
         void start_heartbeat(); // Start heartbeat mechanism
 
     protected:
+        // One connection's write side, bound to its socket when the
+        // connection opens. Flushes write to this fd, never client_fd_. A
+        // connection that closes mid-flush leaves the socket to the flusher,
+        // which closes it when the flush ends, so nothing left of this queue
+        // can reach the next connection.
+        struct Outbound {
+            explicit Outbound(int fd) : fd(fd) {}
+
+            const int fd;
+            OutboundQueue queue; // one datagram per message over UDP
+            std::atomic<bool> timer_pending{false}; // a flush timer owes this queue a flush
+        };
+
+        bool open_connection();
+        void close_connection();  // leaves running_ alone, so reconnect can follow
         void handle_tcp();
         void handle_udp();
-        void monitor_heartbeat(); // Monitor heartbeat for disconnection
-        void reconnect();         // Automatic reconnection
+        void start_flush(const std::shared_ptr<Outbound>& outbound);
+        void flush_outbound(const std::shared_ptr<Outbound>& outbound);
+        ssize_t write_datagrams(int fd, const std::vector<iovec>& datagrams);
+        void set_cork(int fd, bool on);
+        ssize_t write_tls(int fd, const std::string& record);
+        void stop_heartbeat();
+        bool reconnect();         // Automatic reconnection, on the reader thread; false once disconnected
+        void wait_for_reader();
         void initialize_ssl();
         void cleanup_ssl();
         void close_socket(int fd);
+        static int on_new_session(SSL* ssl, SSL_SESSION* session);
 
         std::string server_ip_;
         int port_;
-        int client_fd_;
+        int client_fd_ = -1;
         ProtocolType protocol_;
         bool use_ssl_;
 
         std::shared_ptr<Dispatcher> dispatcher_;
         std::atomic<bool> connected_;
         std::atomic<bool> running_;
-        std::atomic<bool> heartbeat_active_;
-        std::thread heartbeat_thread_;
+        TimerWheel::TimerHandle heartbeat_timer_; // periodic HEARTBEAT sender
         std::mutex heartbeat_mutex_;
-        std::condition_variable heartbeat_cv_;
+        SendOptions send_options_;
+        std::shared_ptr<Outbound> outbound_;  // replaced on every connect
+        TimerWheel::TimerHandle flush_timer_; // a writer waiting out the flush window
+        std::mutex outbound_mutex_;
+
+        bool reading_ = false; // a receive_message_async reader is running
+        std::thread::id reader_thread_;
+        std::mutex reader_mutex_;
+        std::condition_variable reader_cv_;
 
         SSL_CTX *ssl_ctx_;  // SSL context for secure communication
-        SSL *ssl_;          // SSL object for client
+        SSL *ssl_;          // SSL object for client; non-blocking once connected
+        std::mutex ssl_mutex_; // one SSL call at a time: reads and flushes take turns
+        SSL_SESSION *tls_session_ = nullptr; // offered on the next connect
+        mutable std::mutex tls_session_mutex_;
+        std::atomic<bool> tls_session_reused_{false};
 
 #ifdef _WIN32
         WSADATA wsa_data_;
@@ -2,17 +2,31 @@
 #ifndef CMQ_NETWORK_SERVER_HPP
 #define CMQ_NETWORK_SERVER_HPP
 
+#include "engine/Coroutine.hpp"
 #include "engine/Dispatcher.hpp"
 #include "engine/MessageQueue.hpp"
+#include "engine/Strand.hpp"
+#include "engine/TimerWheel.hpp"
+#include "network/DatagramSocket.hpp"
+#include "network/Framing.hpp"
+#include "network/HeartbeatTable.hpp"
+#include "network/OutboundQueue.hpp"
 #include "network/ProtocolType.hpp"
+#include "network/Reactor.hpp"
+#include "network/UringBackend.hpp"
+#include <deque>
 #include <memory>
+#include <string>
 #include <thread>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 #include <mutex>
 #include <atomic>
 #include <openssl/ssl.h>
 #include <openssl/err.h>
 #include <chrono>
+#include <condition_variable>
 
 #ifdef _WIN32
 #include <winsock2.h>
@@ -27,41 +41,191 @@
 
 namespace CMQ {
 
+    struct TlsOptions {
+        std::string certificate_file; // PEM, leaf first
+        std::string private_key_file; // PEM
+        size_t session_cache_size = 20 * 1024; // server-side sessions kept for session-id resumption
+        std::chrono::seconds session_lifetime{2 * 60 * 60}; // of cached sessions and tickets
+        bool ktls = false; // let the kernel encrypt records when it and OpenSSL support it
+    };
+
+    struct TlsStats {
+        size_t handshakes = 0;
+        size_t resumed = 0; // abbreviated handshakes from a ticket or the session cache
+        size_t ktls = 0;    // connections whose record encryption moved into the kernel
+    };
 
     class NetworkServer {
     public:
-        NetworkServer(int port, std::shared_ptr<MessageQueue<std::string>> queue, ProtocolType protocol, bool use_ssl = false);
-        ~NetworkServer();
+        // Client I/O runs on dispatcher, or on the default pool when none is given
+        NetworkServer(int port, std::shared_ptr<MessageQueue<Payload>> queue, ProtocolType protocol, bool use_ssl = false,
+                      std::shared_ptr<Dispatcher> dispatcher = nullptr, IoBackend backend = IoBackend::Epoll);
+        virtual ~NetworkServer();
 
         void start();
         void stop();
         bool is_running() const;
+        IoBackend io_backend() const; // the backend in use, after any fallback
+
+        // Queues message, framed, for client_fd; false if the client is gone.
+        // On a UDP server client ids are session ids and each message is
+        // one datagram.
+        bool send_to_client(int client_fd, std::string message, SendPriority priority = SendPriority::Normal);
+
+        // Queues message to every client, or to those in client_fds. It is
+        // framed once into a buffer that all their queues share, and queued
+        // by one NetworkIO task per shard, so shards fan out in parallel and
+        // the caller only waits for the list of targets. TLS still encrypts
+        // per connection. Broadcasts reach each client in the order they
+        // were made, but a send_to_client may overtake one still fanning
+        // out. Returns how many clients it is queued to.
+        size_t broadcast(std::string message, SendPriority priority = SendPriority::Normal);
+        size_t broadcast(const std::vector<int>& client_fds, std::string message,
+                         SendPriority priority = SendPriority::Normal);
+
+        // Call before start(): bounds what each TCP client may leave unread
+        void set_outbound_limits(OutboundLimits limits);
+        size_t outbound_bytes(int client_fd); // queued for client_fd, not yet taken by its socket
+
+        // Call before start(): lets a UDP server use UDP_GRO/UDP_SEGMENT
+        void set_udp_offload(bool enabled);
+        size_t dropped_datagrams() const; // replies the UDP socket refused or the server stopped holding
+
+        // Call before start(): how many listeners a TCP server opens on its
+        // port, each with its own reactor (or io_uring) loop. Defaults to
+        // one per core; a UDP server always uses a single socket.
+        void set_listener_shards(size_t count);
+        size_t listener_shards() const; // listeners actually open
+
+        // Call before start() on a TLS server: certificate, key and
+        // resumption settings. False (and logged) if the files do not load.
+        bool configure_tls(const TlsOptions& options);
+        TlsStats tls_stats() const;
+
+        // Call before start(): how long a client may stay silent (TCP: no
+        // PONG; UDP: no datagram) and how often that is checked
+        void set_heartbeat(HeartbeatOptions options);
 
     protected:
+        struct UringSession {
+            Strand strand;
+            FrameDecoder decoder;
+        };
+
+        // OpenSSL allows one call at a time per SSL object: the session's
+        // reads and the flusher's writes take turns on mutex, and neither
+        // holds it while waiting for the socket
+        struct TlsConnection {
+            explicit TlsConnection(SSL* ssl) : ssl(ssl) {}
+            ~TlsConnection() { SSL_free(ssl); }
+            TlsConnection(const TlsConnection&) = delete;
+            TlsConnection& operator=(const TlsConnection&) = delete;
+
+            SSL* ssl;
+            std::mutex mutex;
+        };
+
+        // One listener on the shared port (SO_REUSEPORT: the kernel spreads
+        // new connections across them) with its own event loop. A connection
+        // stays on the shard that accepted it: its reads, flushes and close
+        // all go through that shard's reactor or io_uring loop.
+        struct Shard {
+            explicit Shard(Dispatcher& dispatcher) : fan_out(dispatcher, TaskLane::NetworkIO) {}
+
+            int listen_fd = -1;
+            Reactor reactor; // resumes the shard's sessions on its own thread
+            std::unique_ptr<UringBackend> uring; // set while the io_uring backend serves the shard
+            std::unordered_map<int, UringSession> uring_sessions; // touched on its uring loop thread only
+            Strand fan_out; // queues broadcasts to the shard's clients in the order they were made
+        };
+
+        // Runs on the client's strand: one message at a time per client, in
+        // arrival order, on the default (gameplay) pool. message views the
+        // slab it was read into; keep a copy of the Payload, not of the bytes.
+        virtual void handle_message(int client_fd, const Payload &message);
+
         void initialize_socket();
         void initialize_ssl();
         void cleanup_ssl();
-        void accept_connections();
-        void handle_client(int client_fd);
-        void handle_task(const std::string &message);
-        void monitor_heartbeat(); // Monitor client heartbeats
-        void close_socket(int fd);
+        CoTask<void> accept_connections(Shard& shard); // drains the listener on every readiness edge
+        CoTask<void> tls_session(int client_fd, Shard& shard); // handshake and reads as non-blocking steps on the reactor
+        CoTask<void> client_session(int client_fd, Shard& shard); // plain TCP: suspends on the reactor between reads
+        CoTask<void> serve_datagrams();             // UDP: one loop batches every peer's datagrams
+        int udp_session(const sockaddr_in& peer);   // finds or opens the peer's session; needs udp_mutex_
+        void expire_udp_session(int session_id);
+        CoTask<void> flush_datagrams(); // waits on the reactor while the send buffer is full
+        void on_frames(int client_fd, Strand& strand, std::vector<Payload>& frames); // one read's worth
+        bool start_uring(Shard& shard);
+        void register_client(int client_fd, Shard& shard, bool with_outbound); // heartbeat timer and, once writable, its outbound queue
+        size_t fan_out(const std::vector<int>* client_fds, std::string message, SendPriority priority); // every client when null
+        size_t fan_out_datagrams(const std::vector<int>* client_fds, std::string message);
+        bool after_push(int client_fd, OutboundQueue::Push pushed, std::shared_ptr<OutboundQueue> queue,
+                        std::shared_ptr<TlsConnection> tls, Shard& shard); // starts a flush or drops an overflowing client
+        void queue_datagrams(std::vector<OutgoingDatagram> datagrams);
+        void start_flush(int client_fd, std::shared_ptr<OutboundQueue> queue, std::shared_ptr<TlsConnection> tls,
+                         Shard& shard);
+        CoTask<void> flush_socket(int client_fd, std::shared_ptr<OutboundQueue> queue, Shard& shard);
+        CoTask<void> flush_tls(int client_fd, std::shared_ptr<TlsConnection> tls, std::shared_ptr<OutboundQueue> queue,
+                               Shard& shard);
+        void flush_uring(int client_fd, std::shared_ptr<OutboundQueue> queue, Shard& shard, bool failed = false);
+        void refresh_heartbeat(int client_fd); // lock-free
+        void sweep_heartbeats();               // every heartbeat interval: drops clients past their deadline
+        void begin_work();
+        void end_work();
+        void handle_task(const Payload &message);
+        void on_heartbeat_timeout(int client_fd); // the client may have closed since its deadline was checked
+        void close_socket(int fd, Shard& shard);
+        void release_socket(int fd, const std::shared_ptr<TlsConnection>& tls, Shard& shard); // closes for good; no flush may still be using fd
 
         int port_;
-        int server_fd_;
         ProtocolType protocol_;
         bool use_ssl_;
-        std::shared_ptr<MessageQueue<std::string>> message_queue_;
+        std::shared_ptr<MessageQueue<Payload>> message_queue_;
         std::shared_ptr<Dispatcher> dispatcher_;
+        IoBackend backend_;
+        size_t shard_count_;
+        std::vector<std::unique_ptr<Shard>> shards_; // built by start(); the UDP socket is shards_[0]
 
-        std::thread accept_thread_;
-        std::thread heartbeat_thread_;
-        std::unordered_map<int, std::chrono::steady_clock::time_point> client_heartbeat_;
-        std::unordered_map<int, SSL*> ssl_clients_;
+        // UDP mode: sessions are keyed by peer address and expire after a
+        // heartbeat timeout without datagrams
+        struct UdpSession {
+            sockaddr_in peer;
+            Strand strand;
+        };
+        std::unique_ptr<DatagramSocket> datagram_socket_;
+        bool udp_offload_ = false;
+        std::unordered_map<uint64_t, int> udp_session_ids_; // peer address and port -> session id
+        std::unordered_map<int, UdpSession> udp_sessions_;
+        int next_udp_session_ = 1;
+        std::deque<int> free_udp_sessions_; // expired ids, reused oldest first so the heartbeat slots stay dense
+        std::mutex udp_mutex_;
+        std::vector<OutgoingDatagram> udp_outbox_; // replies waiting for the next sendmmsg
+        bool udp_flush_scheduled_ = false;
+        std::atomic<size_t> udp_dropped_{0};
+        std::mutex udp_outbox_mutex_;
+
+        std::unique_ptr<HeartbeatTable> heartbeats_; // TCP fds and UDP session ids
+        TimerWheel::TimerHandle heartbeat_sweep_;
+        std::unordered_set<int> clients_; // open TCP sockets
+        std::unordered_map<int, std::shared_ptr<TlsConnection>> ssl_clients_; // once the handshake is done
+        struct Outbound {
+            std::shared_ptr<OutboundQueue> queue;
+            Shard* shard; // the one that accepted the client
+        };
+        std::unordered_map<int, Outbound> outbound_; // TCP clients only
+        OutboundLimits outbound_limits_;
         std::mutex client_map_mutex_;
         std::atomic<bool> running_;
 
+        // Client sessions and their queued messages; stop() waits for them to drain
+        size_t outstanding_work_ = 0;
+        std::mutex session_mutex_;
+        std::condition_variable session_cv_;
+
         SSL_CTX *ssl_ctx_; // SSL Context for secure communication
+        std::atomic<size_t> tls_handshakes_{0};
+        std::atomic<size_t> tls_resumed_{0};
+        std::atomic<size_t> tls_ktls_{0};
 
 #ifdef _WIN32
         WSADATA wsa_data_;
@@ -0,0 +1,96 @@
+// include/network/OutboundQueue.hpp
+#ifndef CMQ_NETWORK_OUTBOUND_QUEUE_HPP
+#define CMQ_NETWORK_OUTBOUND_QUEUE_HPP
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <sys/uio.h>
+#include <vector>
+
+namespace CMQ {
+
+    // An encoded message queued to many connections (a broadcast): every
+    // queue holds the same immutable bytes
+    using SharedBuffer = std::shared_ptr<const std::string>;
+
+    // Low-priority messages (e.g. position updates superseded by the next
+    // one) are the first thing a congested connection sheds
+    enum class SendPriority { Normal, Low };
+
+    // Per-connection limits on bytes written but not yet accepted by the
+    // socket. Above high_watermark the connection is congested and new Low
+    // messages are dropped until it drains below low_watermark; a client
+    // that lets max_queued pile up is disconnected.
+    struct OutboundLimits {
+        size_t low_watermark = 64 * 1024;
+        size_t high_watermark = 256 * 1024;
+        size_t max_queued = 1024 * 1024;
+    };
+
+    // Messages waiting to be written to one connection. Any thread may
+    // push; one flusher at a time (whoever push() told to start one) gathers
+    // everything pending into a single write and consumes what went out.
+    class OutboundQueue {
+    public:
+        enum class Push {
+            Queued,   // a flush already running will write it
+            Flush,    // queued; the caller must start a flush
+            Dropped,  // Low priority on a congested connection, or closed
+            Overflow, // over max_queued: the caller should disconnect
+        };
+
+        // Returned when the flusher stops
+        enum class FlushEnd {
+            More,    // new data arrived meanwhile; keep flushing
+            Idle,    // nothing left
+            Release, // the connection closed during the flush: the flusher releases the socket
+        };
+
+        explicit OutboundQueue(OutboundLimits limits = {});
+
+        Push push(std::string message, SendPriority priority = SendPriority::Normal);
+        Push push(SharedBuffer message, SendPriority priority = SendPriority::Normal);
+
+        // Flusher side. gather views pending bytes in place; the views stay
+        // valid until consume() releases them.
+        size_t gather(std::vector<iovec>& out, size_t max_iovecs);
+        size_t gather(std::string& out, size_t max_bytes); // copies, for TLS records and io_uring
+        void consume(size_t bytes);
+        FlushEnd end_flush(bool failed = false); // failed: the socket is broken, drop everything
+
+        // Drops everything. Returns false while a flush is running: the
+        // flusher then releases the socket when it ends.
+        bool close();
+
+        size_t queued_bytes() const;
+        bool congested() const;
+
+    private:
+        // Exactly one of the two is used
+        struct Entry {
+            std::string bytes;
+            SharedBuffer shared;
+
+            std::string_view view() const { return shared ? std::string_view(*shared) : std::string_view(bytes); }
+        };
+
+        Push push_entry(Entry entry, SendPriority priority);
+        void clear();
+
+        const OutboundLimits limits_;
+        std::deque<Entry> messages_; // push_back keeps gathered views valid
+        size_t head_offset_ = 0;           // bytes of the front message already written
+        size_t queued_bytes_ = 0;
+        bool congested_ = false;
+        bool flushing_ = false;
+        bool closed_ = false;
+        mutable std::mutex mutex_;
+    };
+
+}
+
+#endif
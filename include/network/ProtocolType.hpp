@@ -4,6 +4,10 @@
 
 namespace CMQ {
     enum class ProtocolType { TCP, UDP };
+
+    // Readiness-based epoll reactor, or completion-based io_uring where the
+    // kernel supports it (falls back to Epoll otherwise)
+    enum class IoBackend { Epoll, IoUring };
 }
 
 #endif
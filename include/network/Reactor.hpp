@@ -0,0 +1,81 @@
+// include/network/Reactor.hpp
+#ifndef CMQ_NETWORK_REACTOR_HPP
+#define CMQ_NETWORK_REACTOR_HPP
+
+#include "engine/Dispatcher.hpp"
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace CMQ {
+
+    // Edge-triggered epoll loop for coroutine socket I/O. A coroutine
+    // awaiting readable(fd) / writable(fd) is parked here instead of
+    // blocking a worker. Each fd is registered once; an edge that arrives
+    // while nobody waits is remembered, so callers must only wait after the
+    // socket reported EAGAIN.
+    class Reactor {
+    public:
+        class IoAwaitable {
+        public:
+            IoAwaitable(Reactor& reactor, int fd, uint32_t events) : reactor_(reactor), fd_(fd), events_(events) {}
+
+            bool await_ready() const noexcept { return false; }
+            bool await_suspend(std::coroutine_handle<> handle);
+            bool await_resume() const noexcept { return ready_; } // false if the wait was cancelled
+
+        private:
+            friend class Reactor;
+            Reactor& reactor_;
+            int fd_;
+            uint32_t events_;
+            bool ready_ = false;
+            std::coroutine_handle<> handle_;
+        };
+
+        Reactor(); // waiters resume on the reactor thread itself
+        explicit Reactor(Dispatcher& dispatcher); // waiters resume on dispatcher's NetworkIO lane
+        ~Reactor();
+
+        Reactor(const Reactor&) = delete;
+        Reactor& operator=(const Reactor&) = delete;
+
+        void start();
+        void stop(); // cancels every pending wait
+        bool is_running() const;
+
+        IoAwaitable readable(int fd);
+        IoAwaitable writable(int fd);
+
+        // Forget fd before it is closed; pending waits on it are cancelled
+        void remove(int fd);
+
+    private:
+        struct Watch {
+            IoAwaitable* reader = nullptr;
+            IoAwaitable* writer = nullptr;
+            bool readable = false; // edge seen with no reader parked
+            bool writable = false;
+        };
+
+        explicit Reactor(Dispatcher* dispatcher);
+
+        bool watch(IoAwaitable* waiter);
+        void resume(IoAwaitable* waiter, bool ready);
+        void run();
+
+        Dispatcher* dispatcher_;
+        int epoll_fd_;
+        int wake_fd_; // eventfd that interrupts epoll_wait on stop
+        std::unordered_map<int, Watch> watches_;
+        std::mutex mutex_;
+        std::atomic<bool> running_;
+        std::thread thread_;
+    };
+
+}
+
+#endif
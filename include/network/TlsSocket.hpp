@@ -0,0 +1,19 @@
+// include/network/TlsSocket.hpp
+#ifndef CMQ_NETWORK_TLS_SOCKET_HPP
+#define CMQ_NETWORK_TLS_SOCKET_HPP
+
+#include <openssl/ssl.h>
+
+namespace CMQ {
+
+    // SSL_set_fd for the library's sockets. OpenSSL's own socket BIO
+    // writes with plain send(), so a peer that resets mid-record would raise
+    // SIGPIPE in whatever process hosts us; this one sends with
+    // MSG_NOSIGNAL and the write fails with EPIPE instead. Once kTLS takes
+    // over a socket OpenSSL writes its control records itself, and those
+    // run with SIGPIPE blocked on the calling thread. False if OpenSSL
+    // could not allocate the BIO.
+    bool set_tls_socket(SSL* ssl, int fd);
+}
+
+#endif // CMQ_NETWORK_TLS_SOCKET_HPP
@@ -0,0 +1,90 @@
+// include/network/UringBackend.hpp
+#ifndef CMQ_NETWORK_URING_BACKEND_HPP
+#define CMQ_NETWORK_URING_BACKEND_HPP
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <sys/types.h>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace CMQ {
+
+    // io_uring loop for one listening socket (needs Linux 6.1). A multishot
+    // accept feeds connections. Each client has one multishot recv that
+    // reads into a shared ring of provided buffers, so an idle client holds
+    // no buffer and costs no syscall. Sends queued from any thread go out
+    // together in the loop's next io_uring_enter, one in flight per client
+    // so they stay ordered. Callbacks run on the loop thread.
+    class UringBackend {
+    public:
+        struct Callbacks {
+            std::function<void(int fd)> on_accept;
+            std::function<void(int fd, std::string_view data)> on_data; // data is only valid during the call
+            std::function<void(int fd)> on_close; // EOF, error or stop; the callee closes fd
+        };
+
+        explicit UringBackend(Callbacks callbacks);
+        ~UringBackend();
+
+        UringBackend(const UringBackend&) = delete;
+        UringBackend& operator=(const UringBackend&) = delete;
+
+        // Sets the ring up on the loop thread. Returns false, with nothing
+        // left running, when the kernel lacks the io_uring features used.
+        bool start(int listen_fd);
+        void stop(); // cancels every operation, reports open clients closed, joins the loop
+        bool is_running() const;
+
+        // done (optional) runs on the loop thread once data has fully gone
+        // out, with its size, or with -errno if it failed or was dropped
+        using SendDone = std::function<void(ssize_t result)>;
+        void send(int fd, std::string data, SendDone done = nullptr);
+
+    private:
+        struct Ring;
+        struct SendOp {
+            int fd;
+            std::string data;
+            SendDone done;
+            size_t offset = 0;
+        };
+
+        void run(int listen_fd, std::promise<bool> ready);
+        void arm_accept();
+        void arm_recv(int fd);
+        void arm_wake();
+        void arm_accept_retry();
+        void submit_send(SendOp* op);
+        void flush_sends();
+        void drop_sends(int fd);
+        static void finish(SendOp* op, ssize_t result);
+        void reap();
+        void complete(uint64_t user_data, int result, uint32_t flags);
+        void cancel_all();
+
+        Callbacks callbacks_;
+        std::unique_ptr<Ring> ring_;
+        int listen_fd_;
+        int wake_fd_; // eventfd read by the ring; written to interrupt the loop
+        size_t inflight_; // submitted operations still owed a final completion
+        std::unordered_map<int, std::deque<SendOp*>> send_queues_; // front is in flight
+
+        std::mutex send_mutex_;
+        std::vector<SendOp*> pending_sends_; // queued by send(), not yet submitted
+
+        std::atomic<bool> running_;
+        std::atomic<bool> stopping_;
+        std::thread thread_;
+    };
+
+}
+
+#endif
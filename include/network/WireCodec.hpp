@@ -0,0 +1,175 @@
+// include/network/WireCodec.hpp
+#ifndef CMQ_NETWORK_WIRE_CODEC_HPP
+#define CMQ_NETWORK_WIRE_CODEC_HPP
+
+#include <charconv>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace CMQ {
+
+    // Binary message bodies. A message type lists its fields once and the
+    // same list drives encoding, decoding and the debug text form:
+    //
+    //     struct MoveMessage {
+    //         static constexpr uint16_t kOpcode = 1;
+    //         int32_t x = 0;
+    //         int32_t y = 0;
+    //         static bool visit(auto& self, auto& field) { return field(self.x) && field(self.y); }
+    //     };
+    //
+    // On the wire a message is its opcode as a varint (one byte below 128,
+    // two below 16384, three up to 65535) followed by its fields: integers
+    // as varints (signed ones zigzagged, so small negatives stay short) and
+    // strings as a varint length plus bytes. Decoded strings are views into
+    // the payload, so a message must not outlive the buffer it was decoded
+    // from.
+
+    class WireWriter {
+    public:
+        explicit WireWriter(std::string& out) : out_(out) {}
+
+        void varint(uint64_t value) {
+            while (value >= 0x80) {
+                out_.push_back(static_cast<char>(value | 0x80));
+                value >>= 7;
+            }
+            out_.push_back(static_cast<char>(value));
+        }
+
+        bool operator()(uint32_t value) {
+            varint(value);
+            return true;
+        }
+
+        bool operator()(int32_t value) {
+            varint((static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31));
+            return true;
+        }
+
+        bool operator()(std::string_view value) {
+            varint(value.size());
+            out_.append(value);
+            return true;
+        }
+
+    private:
+        std::string& out_;
+    };
+
+    class WireReader {
+    public:
+        explicit WireReader(std::string_view data) : data_(data) {}
+
+        bool varint(uint64_t& value) {
+            value = 0;
+            for (unsigned shift = 0; shift < 64 && !data_.empty(); shift += 7) {
+                auto byte = static_cast<unsigned char>(data_.front());
+                data_.remove_prefix(1);
+                if (shift == 63 && (byte & 0x7e)) return false; // the 10th byte has room for one bit
+                value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+                if (!(byte & 0x80)) return true;
+            }
+            return false;
+        }
+
+        bool operator()(uint32_t& value) {
+            uint64_t raw;
+            if (!varint(raw) || raw > UINT32_MAX) return false;
+            value = static_cast<uint32_t>(raw);
+            return true;
+        }
+
+        bool operator()(int32_t& value) {
+            uint32_t raw;
+            if (!(*this)(raw)) return false;
+            value = static_cast<int32_t>((raw >> 1) ^ (~(raw & 1) + 1));
+            return true;
+        }
+
+        bool operator()(std::string_view& value) {
+            uint64_t size;
+            if (!varint(size) || size > data_.size()) return false;
+            value = data_.substr(0, size);
+            data_.remove_prefix(size);
+            return true;
+        }
+
+        std::string_view rest() const { return data_; }
+
+    private:
+        std::string_view data_;
+    };
+
+    // Debug text form of the same fields: "100 200" for a move. Integers
+    // are whitespace-separated tokens; a string field takes the rest of the
+    // line, so it should come last.
+    class TextReader {
+    public:
+        explicit TextReader(std::string_view text) : text_(text) {}
+
+        template<typename Integer>
+        bool operator()(Integer& value) {
+            skip_spaces();
+            auto [end, error] = std::from_chars(text_.data(), text_.data() + text_.size(), value);
+            if (error != std::errc()) return false;
+            text_.remove_prefix(static_cast<size_t>(end - text_.data()));
+            return true;
+        }
+
+        bool operator()(std::string_view& value) {
+            skip_spaces();
+            value = text_;
+            text_ = {};
+            return true;
+        }
+
+    private:
+        void skip_spaces() {
+            while (!text_.empty() && (text_.front() == ' ' || text_.front() == '\t')) text_.remove_prefix(1);
+        }
+
+        std::string_view text_;
+    };
+
+    template<typename Message>
+    void append_message(std::string& out, const Message& message) {
+        WireWriter writer(out);
+        writer.varint(Message::kOpcode);
+        Message::visit(message, writer);
+    }
+
+    template<typename Message>
+    std::string encode_message(const Message& message) {
+        std::string out;
+        append_message(out, message);
+        return out;
+    }
+
+    // Splits a payload into its opcode and the encoded fields after it
+    inline bool read_opcode(std::string_view payload, uint16_t& opcode, std::string_view& fields) {
+        WireReader reader(payload);
+        uint64_t value;
+        if (!reader.varint(value) || value > UINT16_MAX) return false;
+        opcode = static_cast<uint16_t>(value);
+        fields = reader.rest();
+        return true;
+    }
+
+    // Trailing bytes are ignored so newer peers can append fields
+    template<typename Message>
+    bool decode_fields(std::string_view fields, Message& message) {
+        WireReader reader(fields);
+        return Message::visit(message, reader);
+    }
+
+    template<typename Message>
+    bool parse_text_fields(std::string_view text, Message& message) {
+        TextReader reader(text);
+        return Message::visit(message, reader);
+    }
+
+}
+
+#endif
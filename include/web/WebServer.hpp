@@ -3,6 +3,7 @@
 #define CMQ_WEBSERVER_HPP
 
 #include "engine/MessageQueue.hpp"
+#include <atomic>
 #include <thread>
 #include <memory>
 #include <vector>
@@ -36,7 +37,7 @@ namespace CMQ {
         int port_;
         int server_fd_;
         int epoll_fd_;
-        bool running_;
+        std::atomic<bool> running_;
         ProtocolType protocol_;
 
         std::thread accept_thread_;
@@ -8,6 +8,7 @@
 #include <csignal>
 #include <mutex>
 #include <condition_variable>
+#include <sys/resource.h>
 
 using namespace CMQ;
 
@@ -25,19 +26,36 @@ void signal_handler(int signal) {
     }
 }
 
+// Tens of thousands of idle players need more than the usual soft limit
+// of 1024 descriptors; go as high as the hard limit allows. The server
+// library leaves process limits to its host.
+void raise_fd_limit() {
+    rlimit limit{};
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
 int main() {
+    raise_fd_limit();
+
     // Register signal handler for Ctrl+C and SIGTERM
     std::signal(SIGINT, signal_handler);
     std::signal(SIGTERM, signal_handler);
 
-    // Initialize Dispatcher (thread pool)
-    std::cout << "[INFO] Starting Dispatcher with 4 threads..." << std::endl;
+    // Gameplay runs on the default pool, socket work on its own "io" pool
+    std::cout << "[INFO] Starting sim Dispatcher with 4 threads..." << std::endl;
     Dispatcher::get_instance().start(4);
 
+    std::cout << "[INFO] Starting io Dispatcher with 4 threads..." << std::endl;
+    auto io_dispatcher = std::make_shared<Dispatcher>("io");
+    io_dispatcher->start(4);
+
     // Set up the Game Server
     std::cout << "[INFO] Initializing Game Server on port 8080..." << std::endl;
-    auto message_queue = std::make_shared<MessageQueue<std::string>>(100);
-    GameServer server(8080, message_queue, ProtocolType::TCP, false);
+    auto message_queue = std::make_shared<MessageQueue<Payload>>(100);
+    GameServer server(8080, message_queue, ProtocolType::TCP, false, io_dispatcher);
 
     // Start the Game Server
     server.start();
@@ -52,8 +70,9 @@ int main() {
     // Graceful shutdown
     std::cout << "[INFO] Shutting down Game Server..." << std::endl;
     server.stop();
+    io_dispatcher->stop();
     Dispatcher::get_instance().stop();
-    std::cout << "[INFO] Server and Dispatcher stopped gracefully.\n";
+    std::cout << "[INFO] Server and Dispatchers stopped gracefully.\n";
 
     return 0;
 }
@@ -0,0 +1,151 @@
+// src/benchmarks/AcceptStormBenchmark.cpp
+// Accept rate during a reconnect storm, as after a server restart: every
+// client connects, sends one framed message and waits for the reply, then
+// drops the connection and is replaced by the next one until `clients`
+// have been served. `window` connections are in flight at once, so the
+// listeners always have a full accept queue to drain. Runs each backend
+// with 1, 2, 4 ... listener shards up to max_shards (default: the core
+// count).
+//
+// Usage: AcceptStormBenchmark [clients] [window] [client_threads] [port] [max_shards]
+#include "engine/Dispatcher.hpp"
+#include "network/Framing.hpp"
+#include "network/NetworkServer.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+
+using namespace CMQ;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+    // `window` clients plus the server's ends of them need more than the
+    // usual soft limit of 1024 descriptors
+    void raise_fd_limit() {
+        rlimit limit{};
+        if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+            limit.rlim_cur = limit.rlim_max;
+            setrlimit(RLIMIT_NOFILE, &limit);
+        }
+    }
+
+    class ReplyServer : public NetworkServer {
+    public:
+        using NetworkServer::NetworkServer;
+        ~ReplyServer() override { stop(); }
+
+    protected:
+        void handle_message(int client_fd, const Payload&) override {
+            send_to_client(client_fd, "ok");
+        }
+    };
+
+    // Blocking connect (loopback completes it from the accept queue, before
+    // the server accepts), then the reply is awaited on epoll
+    int open_client(const sockaddr_in& addr, const std::string& hello) {
+        int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) return -1;
+        // Reset on close: 20k closed connections in TIME_WAIT would use up
+        // the ephemeral ports before the second run
+        linger reset{1, 0};
+        setsockopt(fd, SOL_SOCKET, SO_LINGER, &reset, sizeof(reset));
+        if (connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) < 0 ||
+            send(fd, hello.data(), hello.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(hello.size())) {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    // Serves `clients` connections with up to `window` open; returns how
+    // many got their reply
+    size_t storm(const sockaddr_in& addr, size_t clients, size_t window) {
+        const std::string hello = encode_frame("hello");
+        int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        size_t started = 0, served = 0, open = 0;
+        epoll_event events[256];
+
+        while (served < clients) {
+            while (open < window && started < clients) {
+                ++started;
+                int fd = open_client(addr, hello);
+                if (fd < 0) continue;
+                epoll_event event{};
+                event.events = EPOLLIN;
+                event.data.fd = fd;
+                epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event);
+                ++open;
+            }
+            if (open == 0) break; // every remaining connect failed
+
+            int count = epoll_wait(epoll_fd, events, 256, 5000);
+            if (count <= 0) break; // the server stalled
+            for (int i = 0; i < count; ++i) {
+                char reply[16];
+                if (recv(events[i].data.fd, reply, sizeof(reply), 0) > 0) ++served;
+                close(events[i].data.fd);
+                --open;
+            }
+        }
+        close(epoll_fd);
+        return served;
+    }
+
+    void run(IoBackend backend, size_t shards, size_t clients, size_t window, size_t client_threads, int port) {
+        auto queue = std::make_shared<MessageQueue<Payload>>(16);
+        ReplyServer server(port, queue, ProtocolType::TCP, false, nullptr, backend);
+        server.set_listener_shards(shards);
+        server.start();
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+
+        std::atomic<size_t> served{0};
+        std::vector<std::thread> threads;
+        auto start = Clock::now();
+        for (size_t t = 0; t < client_threads; ++t) {
+            size_t share = clients / client_threads + (t < clients % client_threads ? 1 : 0);
+            threads.emplace_back([&, share]() {
+                served += storm(addr, share, std::max<size_t>(window / client_threads, 1));
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        std::printf("%-9s %7zu %9zu %10.3f %12.0f\n",
+                    server.io_backend() == IoBackend::IoUring ? "io_uring" : "epoll",
+                    server.listener_shards(), served.load(), seconds, served.load() / seconds);
+        server.stop();
+    }
+
+}
+
+int main(int argc, char** argv) {
+    size_t clients = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+    size_t window = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1024;
+    size_t client_threads = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 2;
+    int port = argc > 4 ? std::atoi(argv[4]) : 8190;
+
+    const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    size_t max_shards = argc > 5 ? std::max<size_t>(std::strtoul(argv[5], nullptr, 10), 1) : cores;
+    raise_fd_limit();
+    std::printf("%zu clients, %zu in flight, %zu client threads, %zu cores\n", clients, window, client_threads, cores);
+    std::printf("%-9s %7s %9s %10s %12s\n", "backend", "shards", "served", "seconds", "accepts/s");
+    for (IoBackend backend : {IoBackend::Epoll, IoBackend::IoUring}) {
+        for (size_t shards = 1; ; shards *= 2) {
+            run(backend, std::min(shards, max_shards), clients, window, client_threads, port);
+            if (shards >= max_shards) break;
+        }
+    }
+    Dispatcher::get_instance().stop();
+    return 0;
+}
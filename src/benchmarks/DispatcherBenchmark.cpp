@@ -0,0 +1,88 @@
+// src/benchmarks/DispatcherBenchmark.cpp
+// Compares tasks/sec of the shared TaskQueue against the work-stealing
+// scheduler for 1..64 worker threads.
+//
+// Usage: DispatcherBenchmark [tasks_per_run]
+#include "engine/Dispatcher.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+using namespace CMQ;
+
+namespace {
+
+    const char* mode_name(SchedulingMode mode) {
+        return mode == SchedulingMode::WorkStealing ? "work-stealing" : "shared-queue";
+    }
+
+    void wait_for(const std::atomic<size_t>& done, size_t target) {
+        while (done.load(std::memory_order_acquire) < target) {
+            std::this_thread::yield();
+        }
+    }
+
+    // All tasks submitted from a thread outside the pool
+    double run_external(SchedulingMode mode, size_t threads, size_t tasks) {
+        Dispatcher& dispatcher = Dispatcher::get_instance();
+        dispatcher.start(threads, mode);
+
+        std::atomic<size_t> done{0};
+        auto begin = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < tasks; ++i) {
+            dispatcher.dispatch([&done]() { done.fetch_add(1, std::memory_order_release); });
+        }
+        wait_for(done, tasks);
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+        dispatcher.stop();
+        return tasks / elapsed;
+    }
+
+    // One seed task per worker fans out the rest from inside the pool
+    double run_spawned(SchedulingMode mode, size_t threads, size_t tasks) {
+        Dispatcher& dispatcher = Dispatcher::get_instance();
+        dispatcher.start(threads, mode);
+
+        std::atomic<size_t> done{0};
+        const size_t per_seed = tasks / threads;
+        auto begin = std::chrono::steady_clock::now();
+        for (size_t s = 0; s < threads; ++s) {
+            dispatcher.dispatch([&dispatcher, &done, per_seed]() {
+                for (size_t i = 0; i < per_seed; ++i) {
+                    dispatcher.dispatch([&done]() { done.fetch_add(1, std::memory_order_release); });
+                }
+            });
+        }
+        wait_for(done, per_seed * threads);
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+        dispatcher.stop();
+        return (per_seed * threads) / elapsed;
+    }
+
+}
+
+int main(int argc, char** argv) {
+    size_t tasks = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+    const std::vector<size_t> thread_counts = {1, 2, 4, 8, 16, 32, 64};
+    const SchedulingMode modes[] = {SchedulingMode::SharedQueue, SchedulingMode::WorkStealing};
+
+    std::printf("%-10s %-14s %8s %16s\n", "scenario", "mode", "threads", "tasks/sec");
+    for (size_t threads : thread_counts) {
+        for (SchedulingMode mode : modes) {
+            std::printf("%-10s %-14s %8zu %16.0f\n", "external", mode_name(mode), threads,
+                        run_external(mode, threads, tasks));
+        }
+    }
+    for (size_t threads : thread_counts) {
+        for (SchedulingMode mode : modes) {
+            std::printf("%-10s %-14s %8zu %16.0f\n", "spawned", mode_name(mode), threads,
+                        run_spawned(mode, threads, tasks));
+        }
+    }
+    return 0;
+}
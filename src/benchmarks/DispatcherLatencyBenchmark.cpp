@@ -0,0 +1,86 @@
+// src/benchmarks/DispatcherLatencyBenchmark.cpp
+// Dispatch-to-execution latency (p50/p99/p99.9) of an idle pool for each
+// idle strategy and scheduling mode. Every sample waits for the previous
+// task to finish and then for an idle gap, so each dispatch has to wake a
+// worker from whatever state the idle strategy left it in.
+//
+// Usage: DispatcherLatencyBenchmark [samples] [threads] [idle_gap_us]
+#include "engine/Dispatcher.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+using namespace CMQ;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+    struct Percentiles {
+        double p50, p99, p999, max;
+    };
+
+    Percentiles summarize(std::vector<double>& samples) {
+        std::sort(samples.begin(), samples.end());
+        auto at = [&](double q) { return samples[static_cast<size_t>(q * (samples.size() - 1))]; };
+        return {at(0.50), at(0.99), at(0.999), samples.back()};
+    }
+
+    // Busy-waits so the producer's own timer slack does not blur the gap
+    void spin_for(std::chrono::microseconds gap) {
+        auto until = Clock::now() + gap;
+        while (Clock::now() < until) {}
+    }
+
+    Percentiles run(SchedulingMode mode, IdleStrategy strategy, size_t threads, size_t samples,
+                    std::chrono::microseconds gap) {
+        Dispatcher dispatcher("latency");
+        DispatcherOptions options;
+        options.thread_count = threads;
+        options.mode = mode;
+        options.idle.strategy = strategy;
+        dispatcher.start(options);
+
+        std::vector<double> latencies(samples);
+        std::atomic<size_t> done{0};
+        for (size_t i = 0; i < samples; ++i) {
+            spin_for(gap);
+            auto sent = Clock::now();
+            dispatcher.dispatch([&latencies, &done, sent, i]() {
+                latencies[i] = std::chrono::duration<double, std::micro>(Clock::now() - sent).count();
+                done.store(i + 1, std::memory_order_release);
+            }, TaskLane::NetworkIO);
+            while (done.load(std::memory_order_acquire) <= i) {}
+        }
+
+        dispatcher.stop();
+        return summarize(latencies);
+    }
+
+}
+
+int main(int argc, char** argv) {
+    size_t samples = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+    size_t threads = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 4;
+    std::chrono::microseconds gap(argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 50);
+
+    const SchedulingMode modes[] = {SchedulingMode::SharedQueue, SchedulingMode::WorkStealing};
+    const IdleStrategy strategies[] = {IdleStrategy::Block, IdleStrategy::SpinThenPark};
+
+    std::printf("%zu samples, %zu threads, %lld us idle gap\n", samples, threads,
+                static_cast<long long>(gap.count()));
+    std::printf("%-14s %-16s %10s %10s %10s %10s\n", "mode", "idle", "p50 us", "p99 us", "p99.9 us", "max us");
+    for (SchedulingMode mode : modes) {
+        for (IdleStrategy strategy : strategies) {
+            Percentiles p = run(mode, strategy, threads, samples, gap);
+            std::printf("%-14s %-16s %10.2f %10.2f %10.2f %10.2f\n",
+                        mode == SchedulingMode::WorkStealing ? "work-stealing" : "shared-queue",
+                        strategy == IdleStrategy::SpinThenPark ? "spin-then-park" : "block",
+                        p.p50, p.p99, p.p999, p.max);
+        }
+    }
+    return 0;
+}
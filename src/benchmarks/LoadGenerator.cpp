@@ -0,0 +1,502 @@
+// src/benchmarks/LoadGenerator.cpp
+// End-to-end load on a GameServer over localhost: `players` connections,
+// each sending move/chat/attack commands in the given mix at `rate` per
+// second (Poisson arrivals, so players do not fire in lockstep). The server
+// answers every command with a broadcast that repeats the tag the sender
+// put in it, so the sender spots its own among everyone else's. Round trip
+// runs from when a command was due, not when it went out: a generator that
+// falls behind shows up as latency instead of quietly sending less.
+//
+// Players are non-blocking sockets spread over `threads` epoll loops, not a
+// GameClient each (those block a reader thread per connection). They speak
+// what a GameClient speaks: frames, GameClient::encode_command in the
+// server's encoding, and a PONG every few seconds to stay clear of the
+// heartbeat timeout.
+//
+// Each command is broadcast to every player, so deliveries grow as
+// players x players x rate: 10k players at 0.01 commands/s each already
+// ask for a million deliveries a second. The server's rate limit (5
+// commands per 2 s per client) drops a player's bursts past that, which
+// shows up as unanswered from a rate of about 1 per second.
+//
+// Usage: cmq_loadgen [--players N] [--rate R] [--mix move:chat:attack]
+//                    [--duration S] [--warmup S] [--threads T] [--port P]
+//                    [--external] [--text]
+// --external drives a server that is already listening on the port instead
+// of starting one in this process.
+#include "engine/Dispatcher.hpp"
+#include "gameplay/GameClient.hpp"
+#include "gameplay/GameServer.hpp"
+#include "network/Framing.hpp"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <queue>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+using namespace CMQ;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+    // Outstanding commands tracked per player; one still unanswered when its
+    // slot comes round again counts as lost
+    constexpr size_t kWindow = 64;
+    // Every player sends a PONG this often, well inside the server's default
+    // 10 s heartbeat timeout
+    constexpr auto kKeepalive = std::chrono::seconds(3);
+    // After the last command, how long answers are still waited for
+    constexpr auto kGrace = std::chrono::seconds(2);
+
+    enum Kind : uint8_t { Move, Chat, Attack, kKinds };
+    constexpr std::array<const char*, kKinds> kKindNames{"move", "chat", "attack"};
+
+    struct Options {
+        size_t players = 1000;
+        double rate = 1.0; // commands per second per player
+        std::array<double, kKinds> mix{80, 15, 5};
+        double duration = 10; // measured seconds
+        double warmup = 2;
+        size_t threads = std::max(1u, std::thread::hardware_concurrency() / 2);
+        int port = 8200;
+        bool external = false;
+        CommandEncoding encoding = CommandEncoding::Binary;
+    };
+
+    bool parse_mix(std::string_view text, std::array<double, kKinds>& mix) {
+        double total = 0;
+        for (size_t kind = 0; kind < kKinds; ++kind) {
+            size_t end = std::min(text.find(':'), text.size());
+            std::string field(text.substr(0, end));
+            char* parsed = nullptr;
+            mix[kind] = std::strtod(field.c_str(), &parsed);
+            if (field.empty() || *parsed || mix[kind] < 0) return false;
+            total += mix[kind];
+            text.remove_prefix(std::min(end + 1, text.size()));
+        }
+        return text.empty() && total > 0;
+    }
+
+    bool parse_options(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; ++i) {
+            std::string_view flag = argv[i];
+            if (flag == "--external") {
+                options.external = true;
+                continue;
+            }
+            if (flag == "--text") {
+                options.encoding = CommandEncoding::Text;
+                continue;
+            }
+            if (i + 1 == argc) return false;
+            const char* value = argv[++i];
+            if (flag == "--players") options.players = std::strtoul(value, nullptr, 10);
+            else if (flag == "--rate") options.rate = std::strtod(value, nullptr);
+            else if (flag == "--mix") { if (!parse_mix(value, options.mix)) return false; }
+            else if (flag == "--duration") options.duration = std::strtod(value, nullptr);
+            else if (flag == "--warmup") options.warmup = std::strtod(value, nullptr);
+            else if (flag == "--threads") options.threads = std::strtoul(value, nullptr, 10);
+            else if (flag == "--port") options.port = std::atoi(value);
+            else return false;
+        }
+        return options.players > 0 && options.rate > 0 && options.duration > 0 && options.warmup >= 0 &&
+               options.threads > 0 && options.port > 0;
+    }
+
+    // Every player holds a socket, and an in-process server holds the other end
+    bool raise_fd_limit(size_t needed) {
+        rlimit limit{};
+        if (getrlimit(RLIMIT_NOFILE, &limit) != 0) return false;
+        if (limit.rlim_cur < needed && limit.rlim_cur < limit.rlim_max) {
+            limit.rlim_cur = std::min<rlim_t>(limit.rlim_max, std::max<rlim_t>(needed, limit.rlim_cur));
+            setrlimit(RLIMIT_NOFILE, &limit);
+            getrlimit(RLIMIT_NOFILE, &limit);
+        }
+        return limit.rlim_cur >= needed;
+    }
+
+    int connect_player(const sockaddr_in& addr) {
+        int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) return -1;
+        if (connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) < 0) {
+            close(fd);
+            return -1;
+        }
+        int on = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        return fd;
+    }
+
+    // Tags are "#<player>.<seq>"; a move carries them as its coordinates
+    std::string command_params(Kind kind, uint32_t player, uint32_t seq) {
+        std::string tag = std::to_string(player) + (kind == Move ? " " : ".") + std::to_string(seq);
+        if (kind == Move) return tag;
+        if (kind == Attack) return "#" + tag;
+        return "#" + tag + " gg, see you at the bridge";
+    }
+
+    // Finds the tag in a broadcast: "Player 7 moves to: <player>, <seq>",
+    // "Player 7 attacks #<player>.<seq>!" or "Player 7: #<player>.<seq> ..."
+    bool parse_tag(std::string_view frame, uint32_t& player, uint32_t& seq) {
+        constexpr std::string_view kMoved = " moves to: ";
+        size_t at = frame.find(kMoved);
+        char separator = ',';
+        if (at != std::string_view::npos) {
+            at += kMoved.size();
+        } else if ((at = frame.find('#')) != std::string_view::npos) {
+            ++at;
+            separator = '.';
+        } else {
+            return false;
+        }
+        const char* end = frame.data() + frame.size();
+        auto [after_player, error] = std::from_chars(frame.data() + at, end, player);
+        if (error != std::errc() || after_player == end || *after_player != separator) return false;
+        const char* digits = after_player + 1;
+        while (digits != end && *digits == ' ') ++digits;
+        return std::from_chars(digits, end, seq).ec == std::errc();
+    }
+
+    struct Pending {
+        Clock::time_point due;
+        uint32_t seq = 0;
+        Kind kind = Move;
+        bool open = false;
+    };
+
+    struct Player {
+        int fd = -1;
+        uint32_t id = 0;
+        uint32_t next_seq = 0;
+        FrameDecoder decoder;
+        std::string out; // frames the socket has not taken yet
+        std::array<Pending, kWindow> pending{};
+        std::mt19937 rng;
+    };
+
+    struct Results {
+        std::array<std::vector<int64_t>, kKinds> latency; // ns, commands due inside the measured window
+        std::vector<int64_t> send_lag;                    // ns from due to written
+        size_t sent = 0;                                  // inside the measured window
+        size_t answered = 0;
+        size_t lost = 0;
+        size_t delivered = 0; // frames received inside the measured window, anyone's broadcast
+        size_t bytes = 0;     // inside the measured window
+        size_t disconnected = 0;
+
+        void merge(Results& other) {
+            for (size_t kind = 0; kind < kKinds; ++kind) {
+                latency[kind].insert(latency[kind].end(), other.latency[kind].begin(), other.latency[kind].end());
+            }
+            send_lag.insert(send_lag.end(), other.send_lag.begin(), other.send_lag.end());
+            sent += other.sent;
+            answered += other.answered;
+            lost += other.lost;
+            delivered += other.delivered;
+            bytes += other.bytes;
+            disconnected += other.disconnected;
+        }
+    };
+
+    // One epoll loop driving a slice of the players: sends whatever is due,
+    // then waits for replies until the next command is
+    class Swarm {
+    public:
+        Swarm(const Options& options, Clock::time_point measure_from, Clock::time_point measure_to)
+            : options_(options), measure_from_(measure_from), measure_to_(measure_to),
+              epoll_fd_(epoll_create1(EPOLL_CLOEXEC)), pick_kind_(options.mix.begin(), options.mix.end()),
+              next_gap_(options.rate) {}
+
+        ~Swarm() {
+            for (Player& player : players_) {
+                if (player.fd >= 0) close(player.fd);
+            }
+            close(epoll_fd_);
+        }
+
+        void add(int fd, uint32_t id) {
+            Player& player = players_.emplace_back();
+            player.fd = fd;
+            player.id = id;
+            player.rng.seed(id);
+        }
+
+        // Runs until measure_to, then waits out the grace period for answers
+        void run() {
+            const Clock::time_point start = Clock::now();
+            for (size_t index = 0; index < players_.size(); ++index) {
+                Player& player = players_[index];
+                epoll_event event{EPOLLIN | EPOLLOUT | EPOLLET, {.u64 = index}};
+                epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, player.fd, &event);
+                // Uniform first arrival, so the swarm starts at its full rate
+                std::uniform_real_distribution<double> offset(0, 1 / options_.rate);
+                due_.push({start + to_duration(offset(player.rng)), index});
+            }
+
+            std::vector<epoll_event> events(256);
+            const Clock::time_point stop = measure_to_ + kGrace;
+            Clock::time_point keepalive = start + kKeepalive;
+            for (Clock::time_point now = Clock::now(); now < stop; now = Clock::now()) {
+                if (now >= keepalive) {
+                    for (Player& player : players_) {
+                        if (player.fd < 0) continue;
+                        append_frame(player.out, "PONG");
+                        flush(player);
+                    }
+                    keepalive = now + kKeepalive;
+                }
+
+                while (!due_.empty() && due_.top().first <= now && now < measure_to_) {
+                    auto [due, index] = due_.top();
+                    due_.pop();
+                    Player& player = players_[index];
+                    if (player.fd < 0) continue;
+                    send_command(player, due, now);
+                    due_.push({due + to_duration(next_gap_(player.rng)), index});
+                }
+
+                Clock::time_point wake = std::min(keepalive, stop);
+                if (!due_.empty() && now < measure_to_) wake = std::min(wake, due_.top().first);
+                auto wait = std::chrono::ceil<std::chrono::milliseconds>(wake - Clock::now()).count();
+                int ready = epoll_wait(epoll_fd_, events.data(), static_cast<int>(events.size()),
+                                       static_cast<int>(std::max<int64_t>(wait, 0)));
+                for (int i = 0; i < ready; ++i) {
+                    Player& player = players_[events[i].data.u64];
+                    if (player.fd < 0) continue;
+                    if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) receive(player);
+                    if (player.fd >= 0 && (events[i].events & EPOLLOUT)) flush(player);
+                }
+            }
+
+            for (Player& player : players_) {
+                for (Pending& pending : player.pending) {
+                    if (pending.open && measured(pending.due)) ++results_.lost;
+                }
+            }
+        }
+
+        Results& results() { return results_; }
+
+    private:
+        static Clock::duration to_duration(double seconds) {
+            return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+        }
+
+        bool measured(Clock::time_point due) const { return due >= measure_from_ && due < measure_to_; }
+
+        void send_command(Player& player, Clock::time_point due, Clock::time_point now) {
+            const Kind kind = static_cast<Kind>(pick_kind_(player.rng));
+            const uint32_t seq = player.next_seq++;
+            if (!GameClient::encode_command(kKindNames[kind], command_params(kind, player.id, seq), options_.encoding,
+                                            message_)) {
+                return;
+            }
+
+            Pending& slot = player.pending[seq % kWindow];
+            if (slot.open && measured(slot.due)) ++results_.lost;
+            slot = Pending{due, seq, kind, true};
+            if (measured(due)) {
+                ++results_.sent;
+                results_.send_lag.push_back((now - due).count());
+            }
+
+            append_frame(player.out, message_);
+            flush(player);
+        }
+
+        void flush(Player& player) {
+            while (!player.out.empty()) {
+                ssize_t written = send(player.fd, player.out.data(), player.out.size(), MSG_NOSIGNAL);
+                if (written > 0) {
+                    player.out.erase(0, static_cast<size_t>(written));
+                } else {
+                    if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return; // EPOLLOUT resumes it
+                    drop(player);
+                    return;
+                }
+            }
+        }
+
+        void receive(Player& player) {
+            while (true) {
+                std::span<char> space = player.decoder.prepare();
+                ssize_t bytes = recv(player.fd, space.data(), space.size(), 0);
+                if (bytes < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+                if (bytes <= 0) {
+                    drop(player);
+                    return;
+                }
+                player.decoder.commit(static_cast<size_t>(bytes));
+                if (!player.decoder.drain(frames_)) {
+                    drop(player);
+                    return;
+                }
+                const Clock::time_point now = Clock::now();
+                for (const Payload& frame : frames_) answer(player, frame.view(), now);
+                if (measured(now)) {
+                    results_.delivered += frames_.size();
+                    results_.bytes += static_cast<size_t>(bytes);
+                }
+                frames_.clear();
+            }
+            player.decoder.release();
+        }
+
+        void answer(Player& player, std::string_view frame, Clock::time_point now) {
+            uint32_t id, seq;
+            if (!parse_tag(frame, id, seq) || id != player.id) return;
+            Pending& slot = player.pending[seq % kWindow];
+            if (!slot.open || slot.seq != seq) return;
+            slot.open = false;
+            if (!measured(slot.due)) return;
+            ++results_.answered;
+            results_.latency[slot.kind].push_back((now - slot.due).count());
+        }
+
+        void drop(Player& player) {
+            epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, player.fd, nullptr);
+            close(player.fd);
+            player.fd = -1;
+            ++results_.disconnected;
+        }
+
+        const Options& options_;
+        const Clock::time_point measure_from_;
+        const Clock::time_point measure_to_;
+        int epoll_fd_;
+        std::vector<Player> players_;
+        std::priority_queue<std::pair<Clock::time_point, size_t>, std::vector<std::pair<Clock::time_point, size_t>>,
+                            std::greater<>> due_;
+        std::discrete_distribution<int> pick_kind_;
+        std::exponential_distribution<double> next_gap_;
+        std::string message_;
+        std::vector<Payload> frames_;
+        Results results_;
+    };
+
+    double percentile_ms(const std::vector<int64_t>& sorted, double quantile) {
+        if (sorted.empty()) return 0;
+        size_t rank = static_cast<size_t>(std::ceil(quantile * sorted.size()));
+        return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1] / 1e6;
+    }
+
+    void print_latency(const char* name, std::vector<int64_t>& samples) {
+        std::sort(samples.begin(), samples.end());
+        std::printf("%-8s %10zu %10.3f %10.3f %10.3f %10.3f\n", name, samples.size(), percentile_ms(samples, 0.5),
+                    percentile_ms(samples, 0.99), percentile_ms(samples, 0.999), percentile_ms(samples, 1.0));
+    }
+
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        std::fprintf(stderr,
+                     "Usage: %s [--players N] [--rate R] [--mix move:chat:attack] [--duration S] [--warmup S]\n"
+                     "          [--threads T] [--port P] [--external] [--text]\n", argv[0]);
+        return 2;
+    }
+    options.threads = std::min(options.threads, options.players);
+    if (!raise_fd_limit(options.players * (options.external ? 1 : 2) + 64)) {
+        std::fprintf(stderr, "Not enough file descriptors for %zu players; raise ulimit -n\n", options.players);
+        return 1;
+    }
+
+    std::shared_ptr<Dispatcher> io_dispatcher;
+    std::unique_ptr<GameServer> server;
+    if (!options.external) {
+        const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+        Dispatcher::get_instance().start(cores);
+        io_dispatcher = std::make_shared<Dispatcher>("io");
+        io_dispatcher->start(cores);
+        auto message_queue = std::make_shared<MessageQueue<Payload>>(100);
+        server = std::make_unique<GameServer>(options.port, message_queue, ProtocolType::TCP, false, io_dispatcher);
+        server->set_command_encoding(options.encoding);
+        server->start();
+    }
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(options.port));
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+
+    // Connect everyone before the clock starts, then hand the sockets out
+    std::vector<int> fds;
+    fds.reserve(options.players);
+    const Clock::time_point connect_start = Clock::now();
+    for (size_t i = 0; i < options.players; ++i) {
+        int fd = connect_player(addr);
+        if (fd < 0) {
+            std::fprintf(stderr, "Connect failed after %zu players: %s\n", i, std::strerror(errno));
+            for (int open_fd : fds) close(open_fd);
+            return 1;
+        }
+        fds.push_back(fd);
+    }
+    const double connect_seconds = std::chrono::duration<double>(Clock::now() - connect_start).count();
+
+    const Clock::time_point measure_from =
+        Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.warmup));
+    const Clock::time_point measure_to =
+        measure_from + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.duration));
+    std::vector<std::unique_ptr<Swarm>> swarms;
+    for (size_t i = 0; i < options.threads; ++i) swarms.push_back(std::make_unique<Swarm>(options, measure_from, measure_to));
+    for (size_t i = 0; i < fds.size(); ++i) swarms[i % swarms.size()]->add(fds[i], static_cast<uint32_t>(i));
+
+    std::vector<std::thread> threads;
+    for (auto& swarm : swarms) threads.emplace_back([&swarm]() { swarm->run(); });
+    for (std::thread& thread : threads) thread.join();
+
+    Results results;
+    for (auto& swarm : swarms) results.merge(swarm->results());
+    swarms.clear(); // closes the players
+    if (server) {
+        server->stop();
+        io_dispatcher->stop();
+        Dispatcher::get_instance().stop();
+    }
+
+    const double total = options.mix[Move] + options.mix[Chat] + options.mix[Attack];
+    std::printf("\n%zu players on %zu threads, %.3g commands/s each (move %.0f%%, chat %.0f%%, attack %.0f%%), %s\n",
+                options.players, options.threads, options.rate, 100 * options.mix[Move] / total,
+                100 * options.mix[Chat] / total, 100 * options.mix[Attack] / total,
+                options.encoding == CommandEncoding::Text ? "text" : "binary");
+    std::printf("connected in %.2f s; measured %.3g s after %.3g s warm-up\n", connect_seconds, options.duration,
+                options.warmup);
+    std::printf("sent %.0f commands/s, answered %.0f/s, %zu unanswered, %zu players disconnected\n",
+                results.sent / options.duration, results.answered / options.duration, results.lost,
+                results.disconnected);
+    std::printf("received %.0f broadcasts/s (%.1f MB/s)\n", results.delivered / options.duration,
+                results.bytes / options.duration / 1e6);
+    std::printf("\n%-8s %10s %10s %10s %10s %10s\n", "command", "answered", "p50 ms", "p99 ms", "p99.9 ms", "max ms");
+    std::vector<int64_t> all;
+    for (size_t kind = 0; kind < kKinds; ++kind) {
+        all.insert(all.end(), results.latency[kind].begin(), results.latency[kind].end());
+        print_latency(kKindNames[kind], results.latency[kind]);
+    }
+    print_latency("all", all);
+    std::sort(results.send_lag.begin(), results.send_lag.end());
+    // The generator's own delay is part of every round trip above; when it
+    // is large the generator, not the server, is the bottleneck
+    std::printf("\nsend lag p50 %.3f ms, p99 %.3f ms\n", percentile_ms(results.send_lag, 0.5),
+                percentile_ms(results.send_lag, 0.99));
+    return 0;
+}
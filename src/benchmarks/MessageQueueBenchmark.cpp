@@ -0,0 +1,73 @@
+// src/benchmarks/MessageQueueBenchmark.cpp
+// Throughput of MessageQueue<std::string> on the locked priority_queue
+// backend versus the lock-free ring, for 1..16 producers and consumers.
+//
+// Usage: MessageQueueBenchmark [messages_per_run] [capacity]
+#include "engine/MessageQueue.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace CMQ;
+
+namespace {
+
+    const char* backend_name(QueueBackend backend) {
+        return backend == QueueBackend::LockFreeRing ? "lock-free-ring" : "locked";
+    }
+
+    double run(QueueBackend backend, size_t producers, size_t consumers, size_t messages, size_t capacity) {
+        MessageQueue<std::string> queue(capacity, backend);
+        std::atomic<size_t> consumed{0};
+        const size_t per_producer = messages / producers;
+        const std::string payload = "move 100 200";
+
+        std::vector<std::thread> threads;
+        auto begin = std::chrono::steady_clock::now();
+        for (size_t c = 0; c < consumers; ++c) {
+            threads.emplace_back([&]() {
+                std::string item;
+                size_t local = 0;
+                while (queue.pop(item)) ++local;
+                consumed.fetch_add(local);
+            });
+        }
+
+        std::vector<std::thread> producer_threads;
+        for (size_t p = 0; p < producers; ++p) {
+            producer_threads.emplace_back([&]() {
+                for (size_t i = 0; i < per_producer; ++i) queue.push(payload);
+            });
+        }
+        for (auto& t : producer_threads) t.join();
+
+        // Consumers keep draining after close() and exit once the queue is empty
+        queue.close();
+        for (auto& t : threads) t.join();
+
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        return consumed.load() / elapsed;
+    }
+
+}
+
+int main(int argc, char** argv) {
+    size_t messages = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 400000;
+    size_t capacity = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1024;
+    const std::vector<size_t> counts = {1, 2, 4, 8, 16};
+
+    std::printf("%-16s %10s %10s %16s\n", "backend", "producers", "consumers", "msgs/sec");
+    for (size_t producers : counts) {
+        for (size_t consumers : counts) {
+            for (QueueBackend backend : {QueueBackend::Locked, QueueBackend::LockFreeRing}) {
+                std::printf("%-16s %10zu %10zu %16.0f\n", backend_name(backend), producers, consumers,
+                            run(backend, producers, consumers, messages, capacity));
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,197 @@
+// src/benchmarks/ReceivePathBenchmark.cpp
+// Heap allocations and bytes copied per message on the server's receive
+// path, from the bytes a read returns to the message popped off the
+// MessageQueue. Compares the previous path (a std::vector decoder, each
+// frame copied into a std::string and copied again into
+// MessageQueue<std::string>) with pooled slabs, where frames stay in the
+// slab they were read into and travel as Payloads. The handler pops either
+// on the reading thread or on a thread of its own, as the gameplay pool
+// does; then slabs are freed on one thread and acquired on another. The
+// copy out of the kernel is the same for both and is not counted.
+//
+// Usage: ReceivePathBenchmark [messages] [read_bytes]
+#include "engine/BufferPool.hpp"
+#include "engine/MessageQueue.hpp"
+#include "network/Framing.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <span>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace {
+    std::atomic<size_t> g_allocations{0};
+}
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+using namespace CMQ;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+    // The decoder as it was before slabs: a growing std::vector, partial
+    // frames slid back to the front, every frame copied out as a string
+    class LegacyFrameDecoder {
+    public:
+        std::span<char> prepare(size_t min_space = 4096) {
+            if (buffer_.size() - end_ < min_space) {
+                if (begin_ > 0) {
+                    std::memmove(buffer_.data(), buffer_.data() + begin_, end_ - begin_);
+                    copied += end_ - begin_;
+                    end_ -= begin_;
+                    begin_ = 0;
+                }
+                if (buffer_.size() - end_ < min_space) buffer_.resize(std::max(buffer_.size() * 2, end_ + min_space));
+            }
+            return std::span<char>(buffer_.data() + end_, buffer_.size() - end_);
+        }
+
+        void commit(size_t bytes) { end_ += bytes; }
+
+        void drain(std::vector<std::string>& frames) {
+            while (begin_ < end_) {
+                size_t length = 0, header = 0;
+                while (true) {
+                    if (begin_ + header == end_) return;
+                    auto byte = static_cast<unsigned char>(buffer_[begin_ + header]);
+                    length |= static_cast<size_t>(byte & 0x7f) << (7 * header);
+                    ++header;
+                    if (!(byte & 0x80)) break;
+                }
+                if (end_ - begin_ < header + length) return;
+                frames.emplace_back(buffer_.data() + begin_ + header, length);
+                copied += length;
+                begin_ += header + length;
+            }
+            if (begin_ == end_) begin_ = end_ = 0;
+        }
+
+        size_t copied = 0;
+
+    private:
+        std::vector<char> buffer_;
+        size_t begin_ = 0;
+        size_t end_ = 0;
+    };
+
+    // Game commands are mostly short, with the odd chat line
+    std::string make_stream(size_t messages) {
+        std::string stream;
+        for (size_t i = 0; i < messages; ++i) append_frame(stream, std::string(16 + (i * 7919) % 200, 'm'));
+        return stream;
+    }
+
+    struct Result {
+        double allocations = 0; // per message
+        double copied = 0;      // bytes per message
+        double rate = 0;        // messages per second
+    };
+
+    // Feeds stream to the decoder read_bytes at a time and hands each frame
+    // to the queue; the handler pops them inline or on its own thread
+    template<typename T, typename Decode>
+    Result run(const std::string& stream, size_t messages, size_t read_bytes, bool handler_thread,
+               Decode decode, const size_t& copied) {
+        MessageQueue<T> queue(4096, QueueBackend::LockFreeRing);
+        std::atomic<size_t> handled{0};
+        std::thread handler;
+        if (handler_thread) {
+            handler = std::thread([&]() {
+                std::vector<T> batch;
+                while (handled < messages) {
+                    batch.clear();
+                    handled += queue.pop_bulk(batch, 256, std::chrono::milliseconds(100));
+                }
+            });
+        }
+
+        size_t allocations = g_allocations.load();
+        size_t copied_before = copied;
+        size_t queue_copied = 0;
+        auto start = Clock::now();
+        std::vector<T> frames;
+        for (size_t offset = 0; offset < stream.size();) {
+            offset += decode(std::string_view(stream).substr(offset, read_bytes), frames);
+            for (T& frame : frames) {
+                queue.push(frame); // handle_task keeps its own reference (or copy)
+                if constexpr (std::is_same_v<T, std::string>) queue_copied += frame.size();
+                if (!handler_thread) {
+                    T popped;
+                    queue.try_pop(popped);
+                    ++handled;
+                }
+            }
+            frames.clear();
+        }
+        if (handler.joinable()) handler.join();
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        Result result;
+        result.allocations = double(g_allocations.load() - allocations) / messages;
+        result.copied = double(copied - copied_before + queue_copied) / messages;
+        result.rate = messages / seconds;
+        return result;
+    }
+
+    void print(const char* path, bool handler_thread, const Result& result) {
+        std::printf("%-8s %-8s %12.3f %14.1f %12.0f\n", path, handler_thread ? "thread" : "inline",
+                    result.allocations, result.copied, result.rate);
+    }
+
+}
+
+int main(int argc, char** argv) {
+    size_t messages = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    size_t read_bytes = argc > 2 ? std::max<size_t>(std::strtoul(argv[2], nullptr, 10), 1) : 4096;
+    const std::string stream = make_stream(messages);
+
+    std::printf("%zu messages, %zu bytes per read\n", messages, read_bytes);
+    std::printf("%-8s %-8s %12s %14s %12s\n", "path", "handler", "allocs/msg", "copied B/msg", "msgs/s");
+    for (bool handler_thread : {false, true}) {
+        LegacyFrameDecoder legacy;
+        legacy.prepare(); // warm up: the buffer's first growth is not per message
+        print("string", handler_thread,
+              run<std::string>(stream, messages, read_bytes, handler_thread,
+                               [&legacy](std::string_view bytes, std::vector<std::string>& frames) {
+                                   std::span<char> space = legacy.prepare();
+                                   size_t taken = std::min(bytes.size(), space.size());
+                                   std::memcpy(space.data(), bytes.data(), taken);
+                                   legacy.commit(taken);
+                                   legacy.drain(frames);
+                                   return taken;
+                               }, legacy.copied));
+
+        FrameDecoder decoder;
+        size_t carried = 0;
+        print("pooled", handler_thread,
+              run<Payload>(stream, messages, read_bytes, handler_thread,
+                           [&decoder, &carried](std::string_view bytes, std::vector<Payload>& frames) {
+                               std::span<char> space = decoder.prepare();
+                               size_t taken = std::min(bytes.size(), space.size());
+                               std::memcpy(space.data(), bytes.data(), taken);
+                               decoder.commit(taken);
+                               decoder.drain(frames);
+                               carried = decoder.carried();
+                               return taken;
+                           }, carried));
+    }
+
+    BufferPoolStats stats = BufferPool::get_instance().stats();
+    std::printf("slabs allocated %zu for %zu acquired\n", stats.allocations, stats.acquired);
+    return 0;
+}
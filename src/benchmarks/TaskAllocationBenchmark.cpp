@@ -0,0 +1,154 @@
+// src/benchmarks/TaskAllocationBenchmark.cpp
+// Counts heap allocations per dispatched task for std::function<void()>
+// (the previous CMQ::Task) and the small-buffer CMQ::Task, using captures
+// shaped like the real hot-path lambdas.
+//
+// Usage: TaskAllocationBenchmark [tasks_per_run]
+#include "engine/Dispatcher.hpp"
+#include "engine/TaskQueue.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+
+namespace {
+    std::atomic<size_t> g_allocations{0};
+}
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+using namespace CMQ;
+
+namespace {
+
+    // The queue as it was before CMQ::Task: std::deque of std::function under a mutex
+    class LegacyTaskQueue {
+    public:
+        void push(std::function<void()> task) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queue_.push_back(std::move(task));
+        }
+        bool try_pop(std::function<void()>& task) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (queue_.empty()) return false;
+            task = std::move(queue_.front());
+            queue_.pop_front();
+            return true;
+        }
+    private:
+        std::deque<std::function<void()>> queue_;
+        std::mutex mutex_;
+    };
+
+    // Capture shapes taken from the code base
+    struct Shapes {
+        void* self = nullptr;
+        int client_fd = 7;
+        std::string message = std::string(48, 'm');
+        std::function<void(const std::string&)> handler = [](const std::string&) {};
+    };
+
+    template<typename Queue, typename TaskT, typename MakeTask>
+    double allocations_per_task(Queue& queue, size_t tasks, MakeTask make_task) {
+        // Warm up so queue storage growth is not attributed to the steady state
+        for (size_t i = 0; i < 1024; ++i) queue.push(make_task());
+        TaskT drained;
+        while (queue.try_pop(drained)) drained();
+
+        size_t before = g_allocations.load();
+        for (size_t i = 0; i < tasks; ++i) {
+            queue.push(make_task());
+            TaskT task;
+            if (queue.try_pop(task)) task();
+        }
+        return double(g_allocations.load() - before) / tasks;
+    }
+
+    template<typename MakeTask>
+    void report(const char* shape, size_t capture_size, size_t tasks, MakeTask make_task) {
+        LegacyTaskQueue legacy;
+        TaskQueue current;
+        double before = allocations_per_task<LegacyTaskQueue, std::function<void()>>(
+            legacy, tasks, [&]() { return std::function<void()>(make_task()); });
+        double after = allocations_per_task<TaskQueue, Task>(
+            current, tasks, [&]() { return Task(make_task()); });
+        std::printf("%-22s %8zu %18.3f %18.3f\n", shape, capture_size, before, after);
+    }
+
+    // Allocations per task through the full Dispatcher (producer + workers)
+    double dispatcher_allocations_per_task(SchedulingMode mode, size_t tasks, const Shapes& shapes) {
+        Dispatcher& dispatcher = Dispatcher::get_instance();
+        dispatcher.start(4, mode);
+        std::atomic<size_t> done{0};
+
+        auto run_batch = [&](size_t count) {
+            size_t target = done.load() + count;
+            for (size_t i = 0; i < count; ++i) {
+                dispatcher.dispatch([&done, self = shapes.self, fd = shapes.client_fd, msg = &shapes.message]() {
+                    (void)self; (void)fd; (void)msg;
+                    done.fetch_add(1, std::memory_order_relaxed);
+                });
+            }
+            while (done.load() < target) std::this_thread::yield();
+        };
+
+        run_batch(4096);
+        size_t before = g_allocations.load();
+        run_batch(tasks);
+        double result = double(g_allocations.load() - before) / tasks;
+        dispatcher.stop();
+        return result;
+    }
+
+}
+
+int main(int argc, char** argv) {
+    size_t tasks = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    Shapes shapes;
+
+    std::printf("Task inline size: %zu bytes\n\n", Task::inline_size);
+    std::printf("%-22s %8s %18s %18s\n", "capture", "bytes", "std::function", "CMQ::Task");
+
+    report("small (this)", sizeof(void*), tasks, [&]() {
+        return [self = shapes.self]() { (void)self; };
+    });
+
+    // NetworkServer::handle_client: [this, client_fd, message] (empty message so only the closure is counted)
+    auto handle_client = [&]() {
+        return [self = shapes.self, fd = shapes.client_fd, message = std::string()]() {
+            (void)self; (void)fd; (void)message;
+        };
+    };
+    report("handle_client", sizeof(handle_client()), tasks, handle_client);
+
+    // EventBus::emit_event_async: [handler, data] (empty data so only the closure is counted)
+    auto emit_async = [&]() {
+        return [handler = shapes.handler, data = std::string()]() { handler(data); };
+    };
+    report("emit_event_async", sizeof(emit_async()), tasks, emit_async);
+
+    auto oversized = [&]() {
+        return [pad = std::array<char, 160>{}]() { (void)pad; };
+    };
+    report("oversized (160B)", sizeof(oversized()), tasks, oversized);
+
+    std::printf("\nDispatcher end-to-end allocations per task (handle_client-sized capture):\n");
+    std::printf("  shared-queue:  %.3f\n", dispatcher_allocations_per_task(SchedulingMode::SharedQueue, tasks, shapes));
+    std::printf("  work-stealing: %.3f\n", dispatcher_allocations_per_task(SchedulingMode::WorkStealing, tasks, shapes));
+    std::printf("Task heap fallbacks so far: %zu\n", Task::heap_allocations());
+    return 0;
+}
@@ -0,0 +1,133 @@
+// src/engine/BufferPool.cpp
+#include "engine/BufferPool.hpp"
+#include <cstring>
+#include <new>
+
+namespace CMQ {
+
+    namespace {
+        // Per thread: 1 MiB of slabs before half of them move to the shared list
+        constexpr size_t kThreadCacheSlabs = 64;
+        // Beyond this (64 MiB) the shared list frees what it is given
+        constexpr size_t kMaxSharedSlabs = 4096;
+
+        Slab* allocate_slab(size_t capacity) {
+            Slab* slab = new (::operator new(sizeof(Slab) + capacity)) Slab();
+            slab->capacity = capacity;
+            return slab;
+        }
+
+        void free_slab(Slab* slab) {
+            slab->~Slab();
+            ::operator delete(slab);
+        }
+    }
+
+    struct BufferPool::ThreadCache {
+        Slab* head = nullptr;
+        size_t count = 0;
+
+        ~ThreadCache() {
+            if (!head) return;
+            Slab* tail = head;
+            while (tail->next) tail = tail->next;
+            BufferPool::get_instance().give_back(head, tail, count);
+        }
+    };
+
+    thread_local BufferPool::ThreadCache BufferPool::thread_cache_;
+
+    Payload::Payload(std::string_view bytes)
+        : slab_(BufferPool::get_instance().acquire(bytes.size())), size_(bytes.size()) {
+        if (!bytes.empty()) std::memcpy(slab_.data(), bytes.data(), bytes.size());
+        data_ = slab_.data();
+    }
+
+    BufferPool& BufferPool::get_instance() {
+        static BufferPool* instance = new BufferPool();
+        return *instance;
+    }
+
+    SlabRef BufferPool::acquire(size_t min_capacity) {
+        acquired_.fetch_add(1, std::memory_order_relaxed);
+        if (min_capacity > kSlabSize) {
+            allocations_.fetch_add(1, std::memory_order_relaxed);
+            return SlabRef(allocate_slab(min_capacity));
+        }
+
+        ThreadCache& cache = thread_cache_;
+        if (!cache.head) cache.count = take_shared(cache.head, kThreadCacheSlabs / 2);
+        if (Slab* slab = cache.head) {
+            cache.head = slab->next;
+            --cache.count;
+            slab->next = nullptr;
+            slab->refs.store(1, std::memory_order_relaxed);
+            return SlabRef(slab);
+        }
+        allocations_.fetch_add(1, std::memory_order_relaxed);
+        return SlabRef(allocate_slab(kSlabSize));
+    }
+
+    BufferPoolStats BufferPool::stats() const {
+        BufferPoolStats stats;
+        stats.allocations = allocations_.load(std::memory_order_relaxed);
+        stats.acquired = acquired_.load(std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats.shared = shared_count_;
+        return stats;
+    }
+
+    void BufferPool::release(Slab* slab) {
+        if (slab->capacity != kSlabSize) {
+            free_slab(slab);
+            return;
+        }
+        ThreadCache& cache = thread_cache_;
+        slab->next = cache.head;
+        cache.head = slab;
+        if (++cache.count <= kThreadCacheSlabs) return;
+
+        // Keep the most recently freed half: it is the warmest in cache
+        Slab* keep_tail = cache.head;
+        for (size_t i = 1; i < kThreadCacheSlabs / 2; ++i) keep_tail = keep_tail->next;
+        Slab* head = keep_tail->next;
+        Slab* tail = head;
+        while (tail->next) tail = tail->next;
+        keep_tail->next = nullptr;
+        get_instance().give_back(head, tail, cache.count - kThreadCacheSlabs / 2);
+        cache.count = kThreadCacheSlabs / 2;
+    }
+
+    void BufferPool::give_back(Slab* head, Slab* tail, size_t count) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (shared_count_ + count <= kMaxSharedSlabs) {
+                tail->next = shared_;
+                shared_ = head;
+                shared_count_ += count;
+                return;
+            }
+        }
+        while (head) {
+            Slab* next = head->next;
+            free_slab(head);
+            head = next;
+        }
+    }
+
+    // Moves up to max slabs from the shared list onto head (which is empty)
+    size_t BufferPool::take_shared(Slab*& head, size_t max) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t taken = 0;
+        while (shared_ && taken < max) {
+            Slab* slab = shared_;
+            shared_ = slab->next;
+            slab->next = head;
+            head = slab;
+            ++taken;
+        }
+        shared_count_ -= taken;
+        return taken;
+    }
+
+}
@@ -1,33 +1,180 @@
 // src/engine/Dispatcher.cpp
 #include "engine/Dispatcher.hpp"
 #include "engine/TaskQueue.hpp"
+#include <algorithm>
+#include <fstream>
 #include <iostream>
+#include <sstream>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 
 namespace CMQ {
 
-    // Singleton Instance Access
+    namespace {
+        // Identifies the Dispatcher worker (if any) running on this thread, so
+        // tasks spawned from a worker can go straight to its local deque
+        thread_local Dispatcher* current_dispatcher = nullptr;
+        thread_local size_t current_worker = 0;
+
+        // Local tasks run before the injection queue is polled again
+        constexpr size_t kInjectionPollInterval = 32;
+
+        // Adaptive spin budgets never drop below this many polls
+        constexpr uint32_t kMinSpinBudget = 16;
+
+        // Live pools, for all_stats()
+        struct Registry {
+            std::mutex mutex;
+            std::vector<Dispatcher*> pools;
+        };
+
+        Registry& registry() {
+            static Registry instance;
+            return instance;
+        }
+
+        uint64_t nanoseconds(std::chrono::steady_clock::duration duration) {
+            return static_cast<uint64_t>(std::max<int64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count(), 0));
+        }
+
+        // Parses a sysfs cpulist such as "0-7,16-23"
+        std::vector<int> numa_node_cpus(int node) {
+            std::vector<int> cpus;
+            std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+            std::string range;
+            while (std::getline(file, range, ',')) {
+                int first = 0, last = 0;
+                char dash = 0;
+                std::istringstream iss(range);
+                if (!(iss >> first)) continue;
+                last = (iss >> dash >> last) ? last : first;
+                for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+            }
+            return cpus;
+        }
+
+        // Tells the core we are spinning: saves power and frees the sibling hyperthread
+        inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+            _mm_pause();
+#elif defined(__aarch64__)
+            asm volatile("yield" ::: "memory");
+#endif
+        }
+
+        void configure_worker_thread(const std::string& name, size_t index, int cpu) {
+#ifdef __linux__
+            // Linux caps thread names at 15 characters
+            std::string thread_name = (name + "-" + std::to_string(index)).substr(0, 15);
+            pthread_setname_np(pthread_self(), thread_name.c_str());
+
+            if (cpu >= 0) {
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                CPU_SET(cpu, &set);
+                if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+                    std::cerr << "Dispatcher " << name << ": failed to pin worker " << index
+                              << " to CPU " << cpu << std::endl;
+                }
+            }
+#else
+            (void)name; (void)index; (void)cpu;
+#endif
+        }
+    }
+
     Dispatcher& Dispatcher::get_instance() {
-        static Dispatcher instance;
+        static Dispatcher instance("default");
         return instance;
     }
 
-    // Private constructor for Singleton
-    Dispatcher::Dispatcher()
-        : task_queue_(std::make_shared<TaskQueue>()), running_(false) {}
+    Dispatcher::Dispatcher(std::string name)
+        : name_(std::move(name)), task_queue_(std::make_shared<TaskQueue>()), running_(false),
+          mode_(SchedulingMode::SharedQueue), pending_(0), spinners_(0), sleepers_(0), collect_stats_(false) {
+        for (size_t i = 0; i < kTaskLaneCount; ++i) {
+            lane_weights_[i] = task_queue_->weight(static_cast<TaskLane>(i));
+        }
+        Registry& pools = registry();
+        std::lock_guard<std::mutex> lock(pools.mutex);
+        pools.pools.push_back(this);
+    }
 
     Dispatcher::~Dispatcher() {
         stop();
+        Registry& pools = registry();
+        std::lock_guard<std::mutex> lock(pools.mutex);
+        pools.pools.erase(std::remove(pools.pools.begin(), pools.pools.end(), this), pools.pools.end());
     }
 
-    void Dispatcher::start(size_t thread_count) {
+    void Dispatcher::start(size_t thread_count, SchedulingMode mode) {
+        DispatcherOptions options;
+        options.thread_count = thread_count;
+        options.mode = mode;
+        start(options);
+    }
+
+    void Dispatcher::start(const DispatcherOptions& options) {
         if (running_) return;
+        size_t thread_count = std::max<size_t>(options.thread_count, 1);
+        SchedulingMode mode = options.mode;
+
+        std::vector<int> cpus = options.cpus;
+        if (cpus.empty() && options.numa_node >= 0) {
+            cpus = numa_node_cpus(options.numa_node);
+            if (cpus.empty()) {
+                std::cerr << "Dispatcher " << name_ << ": NUMA node " << options.numa_node
+                          << " not found, workers left unpinned" << std::endl;
+            }
+        }
+
+        // A stopped queue stays closed, so every start gets a fresh one.
+        // The queues are built first and published under stats_mutex_,
+        // which stats() and queue_depth() read them under.
+        auto task_queue = std::make_shared<TaskQueue>();
+        task_queue->set_record_enqueue_time(options.collect_stats);
+        std::vector<std::unique_ptr<WorkStealingQueue>> local_queues;
+        if (mode == SchedulingMode::WorkStealing) {
+            local_queues.reserve(thread_count);
+            for (size_t i = 0; i < thread_count; ++i) {
+                local_queues.push_back(std::make_unique<WorkStealingQueue>());
+            }
+        }
+        std::vector<std::unique_ptr<WorkerCounters>> counters;
+        for (size_t i = 0; i < thread_count; ++i) {
+            counters.push_back(std::make_unique<WorkerCounters>());
+        }
+
+        mode_ = mode;
+        idle_ = options.idle;
+        pending_ = 0;
+        collect_stats_ = options.collect_stats;
+        {
+            std::lock_guard<std::mutex> lock(stats_mutex_);
+            for (size_t i = 0; i < kTaskLaneCount; ++i) {
+                task_queue->set_weight(static_cast<TaskLane>(i), lane_weights_[i]);
+            }
+            task_queue_ = std::move(task_queue);
+            local_queues_ = std::move(local_queues);
+            counters_ = std::move(counters);
+        }
 
         running_ = true;
         threads_.reserve(thread_count);
         for (size_t i = 0; i < thread_count; ++i) {
-            threads_.emplace_back(&Dispatcher::worker_thread, this);
+            int cpu = cpus.empty() ? -1 : cpus[i % cpus.size()];
+            threads_.emplace_back(&Dispatcher::worker_thread, this, i, cpu);
         }
-        std::cout << "Dispatcher started with " << threads_.size() << " threads." << std::endl;
+        std::cout << "Dispatcher " << name_ << " started with " << threads_.size() << " threads"
+                  << (mode_ == SchedulingMode::WorkStealing ? " (work stealing)" : "")
+                  << (cpus.empty() ? "." : " (pinned).") << std::endl;
     }
 
     void Dispatcher::stop() {
@@ -35,6 +182,10 @@ namespace CMQ {
 
         running_ = false;
         task_queue_->close();
+        {
+            std::lock_guard<std::mutex> lock(idle_mutex_);
+        }
+        idle_cv_.notify_all();
 
         for (auto& thread : threads_) {
             if (thread.joinable()) {
@@ -43,24 +194,274 @@ namespace CMQ {
         }
 
         threads_.clear();
-        std::cout << "Dispatcher stopped." << std::endl;
+        std::cout << "Dispatcher " << name_ << " stopped." << std::endl;
     }
 
-    void Dispatcher::dispatch(Task task, bool high_priority) {
-        if (!running_) return;
-        task_queue_->push(std::move(task), high_priority);
+    bool Dispatcher::dispatch(Task task, bool high_priority) {
+        return dispatch(std::move(task), high_priority ? TaskLane::NetworkIO : TaskLane::GameplayTick);
+    }
+
+    bool Dispatcher::dispatch(Task task, TaskLane lane, Deadline deadline) {
+        if (!running_) return false;
+
+        if (mode_ == SchedulingMode::SharedQueue && idle_.strategy == IdleStrategy::Block) {
+            return task_queue_->push(std::move(task), lane, deadline);
+        }
+
+        // Count the task before publishing it so a worker that sees it also sees pending_ > 0
+        pending_.fetch_add(1);
+        if (mode_ == SchedulingMode::WorkStealing && current_dispatcher == this &&
+            lane == TaskLane::GameplayTick && deadline == kNoDeadline) {
+            // Plain work spawned by a worker stays local; anything that needs
+            // lane fairness or a deadline goes through the lane scheduler
+            local_queues_[current_worker]->push(std::move(task), false,
+                collect_stats_ ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{});
+        } else if (!task_queue_->push(std::move(task), lane, deadline)) {
+            pending_.fetch_sub(1); // stopped since the check above
+            return false;
+        }
+        notify_idle_worker();
+        return true;
+    }
+
+    ScheduleAwaitable Dispatcher::schedule(TaskLane lane) {
+        return ScheduleAwaitable{*this, lane};
+    }
+
+    size_t Dispatcher::queue_depth(TaskLane lane) const {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        return queue_depth_locked(lane);
+    }
+
+    size_t Dispatcher::queue_depth_locked(TaskLane lane) const {
+        size_t depth = task_queue_->depth(lane);
+        if (lane == TaskLane::GameplayTick) {
+            for (const auto& local : local_queues_) depth += local->size();
+        }
+        return depth;
+    }
+
+    void Dispatcher::set_lane_weight(TaskLane lane, unsigned weight) {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        lane_weights_[static_cast<size_t>(lane)] = weight;
+        task_queue_->set_weight(lane, weight);
+    }
+
+    SchedulingMode Dispatcher::mode() const {
+        return mode_;
+    }
+
+    IdlePolicy Dispatcher::idle_policy() const {
+        return idle_;
+    }
+
+    bool Dispatcher::is_running() const {
+        return running_;
+    }
+
+    const std::string& Dispatcher::name() const {
+        return name_;
+    }
+
+    size_t Dispatcher::thread_count() const {
+        return threads_.size();
+    }
+
+    DispatcherStats Dispatcher::stats() const {
+        DispatcherStats stats;
+        stats.name = name_;
+        stats.running = running_;
+
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        for (size_t lane = 0; lane < kTaskLaneCount; ++lane) {
+            stats.lanes[lane].depth = queue_depth_locked(static_cast<TaskLane>(lane));
+        }
+        for (const auto& counters : counters_) {
+            stats.workers.push_back(WorkerStats{counters->executed.load(std::memory_order_relaxed),
+                                                counters->failed.load(std::memory_order_relaxed),
+                                                counters->steals.load(std::memory_order_relaxed),
+                                                counters->parks.load(std::memory_order_relaxed)});
+            for (size_t lane = 0; lane < kTaskLaneCount; ++lane) {
+                LaneStats& out = stats.lanes[lane];
+                out.executed += counters->lane_executed[lane].load(std::memory_order_relaxed);
+                out.failed += counters->lane_failed[lane].load(std::memory_order_relaxed);
+                counters->queue_wait[lane].snapshot_into(out.queue_wait);
+                counters->run_time[lane].snapshot_into(out.run_time);
+            }
+        }
+        return stats;
+    }
+
+    std::vector<DispatcherStats> Dispatcher::all_stats() {
+        Registry& pools = registry();
+        std::lock_guard<std::mutex> lock(pools.mutex);
+        std::vector<DispatcherStats> stats;
+        for (const Dispatcher* pool : pools.pools) {
+            stats.push_back(pool->stats());
+        }
+        return stats;
+    }
+
+    void Dispatcher::worker_thread(size_t index, int cpu) {
+        configure_worker_thread(name_, index, cpu);
+        current_dispatcher = this;
+        current_worker = index;
+
+        if (mode_ == SchedulingMode::WorkStealing) {
+            run_work_stealing(index);
+        } else {
+            run_shared_queue();
+        }
+
+        current_dispatcher = nullptr;
     }
 
-    void Dispatcher::worker_thread() {
+    void Dispatcher::run_shared_queue() {
+        if (idle_.strategy == IdleStrategy::Block) {
+            while (running_) {
+                Task task;
+                TaskInfo info;
+                if (task_queue_->pop(task, &info)) {
+                    execute(task, info, current_worker);
+                }
+            }
+            return;
+        }
+
+        uint32_t spin_budget = idle_.spin_iterations;
         while (running_) {
             Task task;
-            if (task_queue_->pop(task)) {
-                try {
-                    task();
-                } catch (const std::exception& e) {
-                    std::cerr << "Task execution error: " << e.what() << std::endl;
-                }
+            TaskInfo info;
+            if (has_pending_work() && task_queue_->try_pop(task, &info)) {
+                pending_.fetch_sub(1);
+                execute(task, info, current_worker);
+                continue;
+            }
+            wait_for_work(spin_budget);
+        }
+    }
+
+    void Dispatcher::run_work_stealing(size_t index) {
+        uint32_t spin_budget = idle_.spin_iterations;
+        while (running_) {
+            Task task;
+            TaskInfo info;
+            if (find_task(index, task, info)) {
+                pending_.fetch_sub(1);
+                execute(task, info, index);
+                continue;
+            }
+            wait_for_work(spin_budget);
+        }
+    }
+
+    bool Dispatcher::find_task(size_t index, Task& task, TaskInfo& info) {
+        thread_local size_t local_runs = 0;
+
+        // Latency-sensitive lanes preempt local work; periodic polling keeps
+        // the remaining lanes from starving behind a busy local deque
+        bool poll_injection = task_queue_->depth(TaskLane::NetworkIO) > 0 ||
+                              task_queue_->depth(TaskLane::Heartbeat) > 0 ||
+                              ++local_runs % kInjectionPollInterval == 0;
+        if (poll_injection && task_queue_->try_pop(task, &info)) return true;
+
+        if (local_queues_[index]->pop(task, &info)) return true;
+        if (task_queue_->try_pop(task, &info)) return true;
+
+        const size_t count = local_queues_.size();
+        for (size_t i = 1; i < count; ++i) {
+            if (local_queues_[(index + i) % count]->steal(task, &info)) {
+                if (collect_stats_) bump_counter(counters_[index]->steals);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool Dispatcher::has_pending_work() const {
+        return pending_.load() > 0;
+    }
+
+    // Returns once pending_ > 0 or the pool is stopping. A spinner leaves
+    // spinners_ before joining sleepers_ and re-checks pending_ under the
+    // lock, so a producer that skipped the wake because it saw the spinner
+    // is always caught by that re-check.
+    void Dispatcher::wait_for_work(uint32_t& spin_budget) {
+        static const bool multi_core = std::thread::hardware_concurrency() > 1;
+
+        if (idle_.strategy == IdleStrategy::SpinThenPark && multi_core) {
+            spinners_.fetch_add(1);
+            bool found = false;
+            for (uint32_t i = 0; i < spin_budget && !found; ++i) {
+                found = has_pending_work() || !running_;
+                if (!found) cpu_relax();
+            }
+            for (uint32_t i = 0; i < idle_.yield_iterations && !found; ++i) {
+                found = has_pending_work() || !running_;
+                if (!found) std::this_thread::yield();
+            }
+            spinners_.fetch_sub(1);
+
+            if (found) {
+                spin_budget = std::min(std::max(spin_budget * 2, kMinSpinBudget), idle_.spin_iterations);
+                return;
             }
+            spin_budget = std::max(spin_budget / 2, std::min(kMinSpinBudget, idle_.spin_iterations));
+        }
+
+        std::unique_lock<std::mutex> lock(idle_mutex_);
+        sleepers_.fetch_add(1);
+        auto ready = [this]() { return has_pending_work() || !running_; };
+        if (!ready()) {
+            if (collect_stats_) bump_counter(counters_[current_worker]->parks);
+            idle_cv_.wait(lock, ready);
+        }
+        sleepers_.fetch_sub(1);
+    }
+
+    // A spinning worker will pick the task up on its own; only wake a
+    // parked one (a futex call) when nobody is spinning
+    void Dispatcher::notify_idle_worker() {
+        if (spinners_.load() > 0) return;
+        if (sleepers_.load() == 0) return;
+        {
+            // Taking the lock orders this notify after a parking worker's predicate check
+            std::lock_guard<std::mutex> lock(idle_mutex_);
+        }
+        idle_cv_.notify_one();
+    }
+
+    void Dispatcher::execute(Task& task, const TaskInfo& info, size_t index) {
+        if (!collect_stats_) {
+            try {
+                task();
+            } catch (const std::exception& e) {
+                std::cerr << "Task execution error: " << e.what() << std::endl;
+            }
+            return;
+        }
+
+        WorkerCounters& counters = *counters_[index];
+        const size_t lane = static_cast<size_t>(info.lane);
+        auto started = std::chrono::steady_clock::now();
+        if (info.enqueued != std::chrono::steady_clock::time_point{}) {
+            counters.queue_wait[lane].record(nanoseconds(started - info.enqueued));
+        }
+
+        bool failed = false;
+        try {
+            task();
+        } catch (const std::exception& e) {
+            failed = true;
+            std::cerr << "Task execution error: " << e.what() << std::endl;
+        }
+
+        counters.run_time[lane].record(nanoseconds(std::chrono::steady_clock::now() - started));
+        bump_counter(counters.executed);
+        bump_counter(counters.lane_executed[lane]);
+        if (failed) {
+            bump_counter(counters.failed);
+            bump_counter(counters.lane_failed[lane]);
         }
     }
 
@@ -1,62 +1,209 @@
 // src/engine/MessageQueue.cpp
 #include "engine/MessageQueue.hpp"
+#include "engine/BufferPool.hpp"
+#include <algorithm>
+#include <string>
+#include <thread>
 
 namespace CMQ {
 
+    namespace {
+        // Retries on a full/empty ring before falling back to the condition variables
+        constexpr int kRingSpinTries = 64;
+    }
+
     template<typename T>
     MessageQueue<T>::MessageQueue(size_t capacity, Comparator comp)
-        : capacity_(capacity), closed_(false),
-          comparator_(comp ? comp : [](const T&, const T&) { return false; }),
-          queue_(comparator_) {}
+        : capacity_(capacity), backend_(QueueBackend::Locked), comparator_(std::move(comp)),
+          closed_(false), push_waiters_(0), pop_waiters_(0) {}
+
+    template<typename T>
+    MessageQueue<T>::MessageQueue(size_t capacity, QueueBackend backend)
+        : MessageQueue(capacity) {
+        backend_ = backend;
+        if (backend_ == QueueBackend::LockFreeRing) {
+            ring_ = std::make_unique<BoundedMPMCQueue<T>>(capacity);
+        }
+    }
 
     template<typename T>
     void MessageQueue<T>::push(const T& item) {
-        std::unique_lock<std::mutex> lock(mutex_);
-        cv_.wait(lock, [this]() { return queue_.size() < capacity_ || closed_; });
+        if (ring_) {
+            push_ring(item);
+        } else {
+            push_locked(item);
+        }
+    }
 
-        if (closed_) return;
+    template<typename T>
+    void MessageQueue<T>::push(T&& item) {
+        if (ring_) {
+            push_ring(std::move(item));
+        } else {
+            push_locked(std::move(item));
+        }
+    }
+
+    template<typename T>
+    size_t MessageQueue<T>::push_bulk(std::span<T> items) {
+        size_t pushed = 0;
 
-        queue_.push(item);
-        cv_.notify_one();
+        if (ring_) {
+            for (; pushed < items.size(); ++pushed) {
+                if (closed_) break;
+                if (!ring_->try_push(std::move(items[pushed]))) {
+                    notify_ring_consumer(); // let consumers drain what is already in
+                    if (!push_ring(std::move(items[pushed]))) break; // closed while waiting for space
+                }
+            }
+            notify_ring_consumer(pushed > 1);
+            return pushed;
+        }
+
+        while (pushed < items.size()) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            not_full_.wait(lock, [this]() { return locked_size() < capacity_ || closed_; });
+            if (closed_) break;
+
+            size_t batch = 0;
+            while (pushed < items.size() && locked_size() < capacity_) {
+                store_locked(std::move(items[pushed++]));
+                ++batch;
+            }
+            lock.unlock();
+
+            if (batch == 1) {
+                not_empty_.notify_one();
+            } else {
+                not_empty_.notify_all();
+            }
+        }
+        return pushed;
     }
 
     template<typename T>
     bool MessageQueue<T>::pop(T& item) {
+        if (ring_) {
+            for (int i = 0; i < kRingSpinTries; ++i) {
+                if (ring_->try_pop(item)) {
+                    notify_ring_producer();
+                    return true;
+                }
+                if (closed_) break;
+                std::this_thread::yield();
+            }
+
+            std::unique_lock<std::mutex> lock(mutex_);
+            pop_waiters_.fetch_add(1);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            bool popped = false;
+            not_empty_.wait(lock, [&]() { return (popped = ring_->try_pop(item)) || closed_; });
+            pop_waiters_.fetch_sub(1);
+            lock.unlock();
+
+            if (!popped) popped = ring_->try_pop(item); // drain after close
+            if (popped) notify_ring_producer();
+            return popped;
+        }
+
         std::unique_lock<std::mutex> lock(mutex_);
-        cv_.wait(lock, [this]() { return !queue_.empty() || closed_; });
+        not_empty_.wait(lock, [this]() { return locked_size() > 0 || closed_; });
 
-        if (queue_.empty()) return false;
+        if (locked_size() == 0) return false;
 
-        item = queue_.top();
-        queue_.pop();
+        item = take_locked();
+        lock.unlock();
+        not_full_.notify_one();
         return true;
     }
 
     template<typename T>
     bool MessageQueue<T>::try_pop(T& item) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        if (queue_.empty()) return false;
-        item = queue_.top();
-        queue_.pop();
+        if (ring_) {
+            if (!ring_->try_pop(item)) return false;
+            notify_ring_producer();
+            return true;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (locked_size() == 0) return false;
+        item = take_locked();
+        lock.unlock();
+        not_full_.notify_one();
         return true;
     }
 
+    template<typename T>
+    size_t MessageQueue<T>::pop_bulk(std::vector<T>& out, size_t max_n, std::chrono::milliseconds timeout) {
+        if (max_n == 0) return 0;
+        size_t popped = 0;
+
+        if (ring_) {
+            T item;
+            while (popped < max_n && ring_->try_pop(item)) {
+                out.push_back(std::move(item));
+                ++popped;
+            }
+            if (popped == 0) {
+                std::unique_lock<std::mutex> lock(mutex_);
+                pop_waiters_.fetch_add(1);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                bool got = false;
+                not_empty_.wait_for(lock, timeout, [&]() { return (got = ring_->try_pop(item)) || closed_; });
+                pop_waiters_.fetch_sub(1);
+                lock.unlock();
+
+                if (!got) got = ring_->try_pop(item);
+                if (!got) return 0;
+                out.push_back(std::move(item));
+                ++popped;
+                while (popped < max_n && ring_->try_pop(item)) {
+                    out.push_back(std::move(item));
+                    ++popped;
+                }
+            }
+            notify_ring_producer(popped > 1);
+            return popped;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait_for(lock, timeout, [this]() { return locked_size() > 0 || closed_; });
+
+        size_t available = std::min(max_n, locked_size());
+        out.reserve(out.size() + available);
+        for (; popped < available; ++popped) {
+            out.push_back(take_locked());
+        }
+        lock.unlock();
+
+        if (popped == 1) {
+            not_full_.notify_one();
+        } else if (popped > 1) {
+            not_full_.notify_all();
+        }
+        return popped;
+    }
+
     template<typename T>
     void MessageQueue<T>::close() {
-        closed_ = true;
-        cv_.notify_all();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        not_empty_.notify_all();
+        not_full_.notify_all();
     }
 
     template<typename T>
     bool MessageQueue<T>::empty() const {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return queue_.empty();
+        return size() == 0;
     }
 
     template<typename T>
     size_t MessageQueue<T>::size() const {
+        if (ring_) return ring_->size();
         std::lock_guard<std::mutex> lock(mutex_);
-        return queue_.size();
+        return locked_size();
     }
 
     template<typename T>
@@ -64,8 +211,114 @@ namespace CMQ {
         return closed_;
     }
 
+    template<typename T>
+    QueueBackend MessageQueue<T>::backend() const {
+        return backend_;
+    }
+
+    template<typename T>
+    template<typename U>
+    void MessageQueue<T>::push_locked(U&& item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_full_.wait(lock, [this]() { return locked_size() < capacity_ || closed_; });
+
+        if (closed_) return;
+
+        if constexpr (std::is_same_v<std::decay_t<U>, T> && !std::is_lvalue_reference_v<U>) {
+            store_locked(std::move(item));
+        } else {
+            store_locked(T(item));
+        }
+        lock.unlock();
+        not_empty_.notify_one();
+    }
+
+    template<typename T>
+    template<typename U>
+    bool MessageQueue<T>::push_ring(U&& item) {
+        if (closed_) return false;
+
+        // A failed try_push leaves item untouched, so it is safe to retry with it
+        bool pushed = ring_->try_push(std::forward<U>(item));
+        for (int i = 0; !pushed && i < kRingSpinTries; ++i) {
+            std::this_thread::yield();
+            if (closed_) return false;
+            pushed = ring_->try_push(std::forward<U>(item));
+        }
+
+        if (!pushed) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            push_waiters_.fetch_add(1);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            not_full_.wait(lock, [&]() { return closed_ || (pushed = ring_->try_push(std::forward<U>(item))); });
+            push_waiters_.fetch_sub(1);
+        }
+
+        if (pushed) notify_ring_consumer();
+        return pushed;
+    }
+
+    template<typename T>
+    void MessageQueue<T>::store_locked(T&& item) {
+        if (comparator_) {
+            heap_.push_back(std::move(item));
+            std::push_heap(heap_.begin(), heap_.end(), comparator_);
+        } else {
+            fifo_.push_back(std::move(item));
+        }
+    }
+
+    // Moves the next item out; priority_queue::top() only allowed a copy
+    template<typename T>
+    T MessageQueue<T>::take_locked() {
+        if (comparator_) {
+            std::pop_heap(heap_.begin(), heap_.end(), comparator_);
+            T item = std::move(heap_.back());
+            heap_.pop_back();
+            return item;
+        }
+        T item = std::move(fifo_.front());
+        fifo_.pop_front();
+        return item;
+    }
+
+    template<typename T>
+    size_t MessageQueue<T>::locked_size() const {
+        return comparator_ ? heap_.size() : fifo_.size();
+    }
+
+    // The fences pair with the ones taken by a waiter after registering itself,
+    // so either the waiter sees the new slot state or we see the waiter.
+    template<typename T>
+    void MessageQueue<T>::notify_ring_consumer(bool all) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (pop_waiters_.load(std::memory_order_relaxed) == 0) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+        }
+        if (all) {
+            not_empty_.notify_all();
+        } else {
+            not_empty_.notify_one();
+        }
+    }
+
+    template<typename T>
+    void MessageQueue<T>::notify_ring_producer(bool all) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (push_waiters_.load(std::memory_order_relaxed) == 0) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+        }
+        if (all) {
+            not_full_.notify_all();
+        } else {
+            not_full_.notify_one();
+        }
+    }
+
     // Explicit instantiation (required for template source file)
     template class MessageQueue<int>; // You can change T to any type used
     template class MessageQueue<std::string>;
+    template class MessageQueue<Payload>;
 }
-
@@ -0,0 +1,80 @@
+// src/engine/Stats.cpp
+#include "engine/Stats.hpp"
+#include <algorithm>
+#include <bit>
+
+namespace CMQ {
+
+    HistogramSnapshot::HistogramSnapshot()
+        : buckets_(LatencyHistogram::kBucketCount, 0), count_(0), sum_(0), max_(0) {}
+
+    void HistogramSnapshot::merge(const HistogramSnapshot& other) {
+        for (size_t i = 0; i < buckets_.size(); ++i) buckets_[i] += other.buckets_[i];
+        count_ += other.count_;
+        sum_ += other.sum_;
+        max_ = std::max(max_, other.max_);
+    }
+
+    double HistogramSnapshot::mean() const {
+        return count_ ? static_cast<double>(sum_) / count_ : 0.0;
+    }
+
+    uint64_t HistogramSnapshot::percentile(double q) const {
+        // Bucket totals and count_ are read separately, so trust the buckets
+        uint64_t total = 0;
+        for (uint64_t bucket : buckets_) total += bucket;
+        if (total == 0) return 0;
+
+        auto rank = static_cast<uint64_t>(std::clamp(q, 0.0, 1.0) * (total - 1)) + 1;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < buckets_.size(); ++i) {
+            seen += buckets_[i];
+            if (seen >= rank) return std::min(LatencyHistogram::bucket_upper_bound(i), max_);
+        }
+        return max_;
+    }
+
+    // Values below 2 * kSubBuckets get a bucket each; above that, a value
+    // with highest set bit e lands in sub-bucket (value >> (e - 3)) of octave e
+    size_t LatencyHistogram::bucket_index(uint64_t value) {
+        if (value < 2 * kSubBuckets) return static_cast<size_t>(value);
+        unsigned exponent = 63u - static_cast<unsigned>(std::countl_zero(value));
+        if (exponent > kMaxExponent) return kBucketCount - 1;
+        return (exponent - kSubBucketBits) * kSubBuckets + static_cast<size_t>(value >> (exponent - kSubBucketBits));
+    }
+
+    uint64_t LatencyHistogram::bucket_upper_bound(size_t index) {
+        if (index < 2 * kSubBuckets) return index;
+        unsigned exponent = static_cast<unsigned>(index / kSubBuckets) + kSubBucketBits - 1;
+        uint64_t mantissa = index % kSubBuckets + kSubBuckets;
+        unsigned shift = exponent - kSubBucketBits;
+        return ((mantissa + 1) << shift) - 1;
+    }
+
+    void LatencyHistogram::record(uint64_t value) {
+        bump_counter(buckets_[bucket_index(value)]);
+        bump_counter(count_);
+        bump_counter(sum_, value);
+        if (value > max_.load(std::memory_order_relaxed)) max_.store(value, std::memory_order_relaxed);
+    }
+
+    void LatencyHistogram::snapshot_into(HistogramSnapshot& snapshot) const {
+        for (size_t i = 0; i < kBucketCount; ++i) {
+            snapshot.buckets_[i] += buckets_[i].load(std::memory_order_relaxed);
+        }
+        snapshot.count_ += count_.load(std::memory_order_relaxed);
+        snapshot.sum_ += sum_.load(std::memory_order_relaxed);
+        snapshot.max_ = std::max(snapshot.max_, max_.load(std::memory_order_relaxed));
+    }
+
+    const char* lane_name(TaskLane lane) {
+        switch (lane) {
+            case TaskLane::NetworkIO: return "network_io";
+            case TaskLane::GameplayTick: return "gameplay_tick";
+            case TaskLane::Heartbeat: return "heartbeat";
+            case TaskLane::Background: return "background";
+            default: return "unknown";
+        }
+    }
+
+}
@@ -0,0 +1,83 @@
+// src/engine/Strand.cpp
+#include "engine/Strand.hpp"
+#include <iostream>
+
+namespace CMQ {
+
+    namespace {
+        // Tasks run per drain before the strand yields its worker to other work
+        constexpr size_t kStrandBatch = 16;
+
+        thread_local const void* current_strand = nullptr;
+    }
+
+    Strand::Strand(Dispatcher& dispatcher, TaskLane lane)
+        : state_(std::make_shared<State>(dispatcher, lane)) {}
+
+    void Strand::post(Task task) {
+        {
+            std::lock_guard<std::mutex> lock(state_->mutex);
+            state_->queue.push_back(std::move(task));
+            if (state_->scheduled) return;
+            state_->scheduled = true;
+        }
+        schedule(state_);
+    }
+
+    size_t Strand::pending() const {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        return state_->queue.size();
+    }
+
+    bool Strand::running_in_this_thread() const {
+        return current_strand == state_.get();
+    }
+
+    void Strand::schedule(const std::shared_ptr<State>& state) {
+        // Without a running pool the strand drains on the posting thread,
+        // also when the pool stops between the check and the dispatch:
+        // otherwise scheduled would stay set and the strand never run again
+        if (!state->dispatcher.is_running() || !state->dispatcher.dispatch([state]() { drain(state); }, state->lane)) {
+            drain(state);
+        }
+    }
+
+    // Only one drain per strand exists at a time (guarded by scheduled), so
+    // tasks never overlap; the mutex hands each task's effects to the next
+    void Strand::drain(const std::shared_ptr<State>& state) {
+        const void* outer = current_strand;
+        current_strand = state.get();
+
+        for (size_t i = 0; i < kStrandBatch; ++i) {
+            Task task;
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if (state->queue.empty()) {
+                    state->scheduled = false;
+                    current_strand = outer;
+                    return;
+                }
+                task = std::move(state->queue.front());
+                state->queue.pop_front();
+            }
+
+            try {
+                task();
+            } catch (const std::exception& e) {
+                std::cerr << "Strand task error: " << e.what() << std::endl;
+            }
+        }
+        current_strand = outer;
+
+        // Batch used up: requeue behind other work instead of hogging the worker
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (state->queue.empty()) {
+                state->scheduled = false;
+                return;
+            }
+        }
+        schedule(state);
+    }
+
+}
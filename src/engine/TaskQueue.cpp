@@ -1,45 +1,73 @@
 // src/engine/TaskQueue.cpp
 #include "engine/TaskQueue.hpp"
+#include <algorithm>
 
 namespace CMQ {
 
-    TaskQueue::TaskQueue() : closed_(false) {}
+    namespace {
+        // Default share of worker time when every lane is backlogged
+        constexpr unsigned kDefaultLaneWeights[kTaskLaneCount] = {8, 4, 2, 1};
+
+        struct LaterDeadline {
+            template<typename Entry>
+            bool operator()(const Entry& a, const Entry& b) const {
+                return a.deadline != b.deadline ? a.deadline > b.deadline : a.sequence > b.sequence;
+            }
+        };
+    }
+
+    TaskQueue::TaskQueue() : size_(0), sequence_(0), closed_(false), record_enqueue_time_(false) {
+        for (size_t i = 0; i < kTaskLaneCount; ++i) {
+            lanes_[i].weight = kDefaultLaneWeights[i];
+        }
+    }
 
     TaskQueue::~TaskQueue() {
         close();
     }
 
-    void TaskQueue::push(Task task, bool high_priority) {
+    bool TaskQueue::push(Task task, bool high_priority) {
+        return push(std::move(task), high_priority ? TaskLane::NetworkIO : TaskLane::GameplayTick);
+    }
+
+    bool TaskQueue::push(Task task, TaskLane lane, Deadline deadline) {
+        std::chrono::steady_clock::time_point enqueued{};
+        if (record_enqueue_time_.load(std::memory_order_relaxed)) enqueued = std::chrono::steady_clock::now();
         {
             std::lock_guard<std::mutex> lock(mutex_);
-            if (closed_) return;
+            if (closed_) return false;
 
-            if (high_priority) {
-                queue_.push_front(std::move(task));
+            Lane& target = lanes_[static_cast<size_t>(lane)];
+            if (deadline == kNoDeadline) {
+                target.fifo.push_back(Entry{std::move(task), deadline, sequence_++, enqueued});
             } else {
-                queue_.push_back(std::move(task));
+                target.deadlines.push_back(Entry{std::move(task), deadline, sequence_++, enqueued});
+                std::push_heap(target.deadlines.begin(), target.deadlines.end(), LaterDeadline{});
             }
+            target.depth.fetch_add(1, std::memory_order_relaxed);
+            ++size_;
         }
         cv_.notify_one();
+        return true;
     }
 
-    bool TaskQueue::pop(Task& task) {
+    bool TaskQueue::pop(Task& task, TaskInfo* info) {
         std::unique_lock<std::mutex> lock(mutex_);
-        cv_.wait(lock, [this]() { return !queue_.empty() || closed_; });
+        cv_.wait(lock, [this]() { return size_ > 0 || closed_; });
 
-        if (queue_.empty()) return false;
+        Lane* lane = select_lane();
+        if (!lane) return false;
 
-        task = std::move(queue_.front());
-        queue_.pop_front();
+        take(*lane, task, info);
         return true;
     }
 
-    bool TaskQueue::try_pop(Task& task) {
+    bool TaskQueue::try_pop(Task& task, TaskInfo* info) {
         std::lock_guard<std::mutex> lock(mutex_);
-        if (queue_.empty()) return false;
+        Lane* lane = select_lane();
+        if (!lane) return false;
 
-        task = std::move(queue_.front());
-        queue_.pop_front();
+        take(*lane, task, info);
         return true;
     }
 
@@ -53,7 +81,67 @@ namespace CMQ {
 
     bool TaskQueue::empty() const {
         std::lock_guard<std::mutex> lock(mutex_);
-        return queue_.empty();
+        return size_ == 0;
+    }
+
+    size_t TaskQueue::depth(TaskLane lane) const {
+        return lanes_[static_cast<size_t>(lane)].depth.load(std::memory_order_relaxed);
+    }
+
+    void TaskQueue::set_weight(TaskLane lane, unsigned weight) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        lanes_[static_cast<size_t>(lane)].weight = std::max(1u, weight);
+    }
+
+    unsigned TaskQueue::weight(TaskLane lane) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return lanes_[static_cast<size_t>(lane)].weight;
+    }
+
+    void TaskQueue::set_record_enqueue_time(bool enabled) {
+        record_enqueue_time_.store(enabled, std::memory_order_relaxed);
+    }
+
+    // Smooth weighted round-robin over the non-empty lanes: every backlogged
+    // lane earns its weight in credit, the richest lane runs and pays back the
+    // total. Over time each lane gets weight/total of the picks and no lane
+    // can be starved, while bursts stay interleaved instead of clumped.
+    TaskQueue::Lane* TaskQueue::select_lane() {
+        if (size_ == 0) return nullptr;
+
+        Lane* best = nullptr;
+        int64_t total = 0;
+        for (Lane& lane : lanes_) {
+            if (lane.fifo.empty() && lane.deadlines.empty()) continue;
+            lane.credit += lane.weight;
+            total += lane.weight;
+            if (!best || lane.credit > best->credit) best = &lane;
+        }
+        best->credit -= total;
+        return best;
+    }
+
+    void TaskQueue::take(Lane& lane, Task& task, TaskInfo* info) {
+        const bool from_deadlines = !lane.deadlines.empty();
+        if (from_deadlines) {
+            std::pop_heap(lane.deadlines.begin(), lane.deadlines.end(), LaterDeadline{});
+        }
+        Entry& entry = from_deadlines ? lane.deadlines.back() : lane.fifo.front();
+        task = std::move(entry.task);
+        if (info) {
+            info->lane = static_cast<TaskLane>(&lane - lanes_.data());
+            info->enqueued = entry.enqueued;
+        }
+        if (from_deadlines) {
+            lane.deadlines.pop_back();
+        } else {
+            lane.fifo.pop_front();
+        }
+        lane.depth.fetch_sub(1, std::memory_order_relaxed);
+        --size_;
+
+        // An idle lane neither banks credit nor carries debt into its next burst
+        if (lane.fifo.empty() && lane.deadlines.empty()) lane.credit = 0;
     }
 
 } // namespace CMQ
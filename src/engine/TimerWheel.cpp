@@ -0,0 +1,264 @@
+// src/engine/TimerWheel.cpp
+#include "engine/TimerWheel.hpp"
+#include <algorithm>
+
+namespace CMQ {
+
+    struct TimerWheel::Timer {
+        Task callback;
+        TaskLane lane = TaskLane::GameplayTick;
+        uint64_t expiry = 0;   // absolute tick
+        uint64_t interval = 0; // ticks between periodic firings, 0 for one-shot
+
+        // Intrusive slot list; self keeps the timer alive while it is linked
+        Timer* prev = nullptr;
+        Timer* next = nullptr;
+        size_t level = 0;
+        size_t slot = 0;
+        bool linked = false;
+        TimerHandle self;
+
+        std::atomic<bool> cancelled{false};
+        std::recursive_mutex run_mutex; // held while the callback runs
+    };
+
+    TimerWheel& TimerWheel::get_instance() {
+        static TimerWheel instance(Dispatcher::get_instance());
+        return instance;
+    }
+
+    TimerWheel::TimerWheel(Dispatcher& dispatcher, std::chrono::nanoseconds tick)
+        : dispatcher_(dispatcher), tick_(std::max(tick, std::chrono::nanoseconds(1))),
+          start_(Clock::now()), current_(0), next_wakeup_(UINT64_MAX), active_(0), running_(true) {
+        thread_ = std::thread(&TimerWheel::run, this);
+    }
+
+    TimerWheel::~TimerWheel() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_ = false;
+        }
+        cv_.notify_all();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+
+        // Break the self references of timers still armed
+        for (auto& level : slots_) {
+            for (Timer*& head : level) {
+                while (head) {
+                    Timer* timer = head;
+                    head = timer->next;
+                    timer->linked = false;
+                    timer->prev = timer->next = nullptr;
+                    timer->self.reset();
+                }
+            }
+        }
+    }
+
+    TimerWheel::TimerHandle TimerWheel::schedule(std::chrono::nanoseconds delay, Task callback, TaskLane lane) {
+        return arm(delay, std::chrono::nanoseconds(0), std::move(callback), lane);
+    }
+
+    TimerWheel::TimerHandle TimerWheel::schedule_periodic(std::chrono::nanoseconds interval, Task callback,
+                                                          TaskLane lane) {
+        return arm(interval, std::max(interval, tick_), std::move(callback), lane);
+    }
+
+    TimerWheel::TimerHandle TimerWheel::arm(std::chrono::nanoseconds delay, std::chrono::nanoseconds interval,
+                                            Task callback, TaskLane lane) {
+        auto timer = std::make_shared<Timer>();
+        timer->callback = std::move(callback);
+        timer->lane = lane;
+        timer->interval = interval.count() > 0 ? ticks_for(interval) : 0;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        timer->expiry = std::max(now_tick() + ticks_for(delay), current_ + 1);
+        timer->self = timer;
+        link(timer.get());
+        wake_if_earlier(timer->expiry);
+        return timer;
+    }
+
+    void TimerWheel::cancel(const TimerHandle& timer) {
+        if (!timer) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            timer->cancelled = true;
+            if (timer->linked) unlink(timer.get());
+        }
+        // Wait out a callback already running on a worker
+        std::lock_guard<std::recursive_mutex> run_lock(timer->run_mutex);
+    }
+
+    bool TimerWheel::reschedule(const TimerHandle& timer, std::chrono::nanoseconds delay) {
+        if (!timer) return false;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (timer->cancelled) return false;
+        if (timer->linked) unlink(timer.get());
+
+        timer->expiry = std::max(now_tick() + ticks_for(delay), current_ + 1);
+        timer->self = timer;
+        link(timer.get());
+        wake_if_earlier(timer->expiry);
+        return true;
+    }
+
+    size_t TimerWheel::active_timers() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return active_;
+    }
+
+    std::chrono::nanoseconds TimerWheel::tick() const {
+        return tick_;
+    }
+
+    // Rounds up so a timer never fires early
+    uint64_t TimerWheel::ticks_for(std::chrono::nanoseconds duration) const {
+        if (duration.count() <= 0) return 0;
+        return static_cast<uint64_t>((duration.count() + tick_.count() - 1) / tick_.count());
+    }
+
+    uint64_t TimerWheel::now_tick() const {
+        return static_cast<uint64_t>((Clock::now() - start_) / tick_);
+    }
+
+    TimerWheel::Clock::time_point TimerWheel::time_of(uint64_t tick) const {
+        return start_ + std::chrono::duration_cast<Clock::duration>(tick_ * tick);
+    }
+
+    // A timer goes on the lowest level whose span covers its remaining delay,
+    // in the slot its expiry maps to at that level. Higher levels are
+    // cascaded down as the lower level wraps, so each timer is touched at
+    // most once per level.
+    void TimerWheel::link(Timer* timer) {
+        uint64_t delta = timer->expiry > current_ ? timer->expiry - current_ : 0;
+        uint64_t expiry = timer->expiry;
+
+        size_t level = 0;
+        while (level + 1 < kLevels && delta >= (uint64_t(1) << (kSlotBits * (level + 1)))) {
+            ++level;
+        }
+        uint64_t max_delta = (uint64_t(1) << (kSlotBits * kLevels)) - 1;
+        if (delta > max_delta) {
+            expiry = current_ + max_delta; // re-cascaded until actually due
+        }
+
+        size_t slot = (expiry >> (kSlotBits * level)) & kSlotMask;
+        Timer*& head = slots_[level][slot];
+        timer->level = level;
+        timer->slot = slot;
+        timer->prev = nullptr;
+        timer->next = head;
+        if (head) head->prev = timer;
+        head = timer;
+        timer->linked = true;
+        ++active_;
+    }
+
+    void TimerWheel::unlink(Timer* timer) {
+        if (timer->prev) {
+            timer->prev->next = timer->next;
+        } else {
+            slots_[timer->level][timer->slot] = timer->next;
+        }
+        if (timer->next) timer->next->prev = timer->prev;
+        timer->prev = timer->next = nullptr;
+        timer->linked = false;
+        --active_;
+        timer->self.reset(); // caller holds its own reference
+    }
+
+    void TimerWheel::advance(std::vector<TimerHandle>& expired) {
+        ++current_;
+        if ((current_ & kSlotMask) == 0) cascade(1);
+
+        Timer* timer = slots_[0][current_ & kSlotMask];
+        while (timer) {
+            Timer* next = timer->next;
+            TimerHandle handle = timer->self;
+            unlink(timer);
+            if (handle->interval > 0) {
+                handle->expiry = std::max(handle->expiry + handle->interval, current_ + 1);
+                handle->self = handle;
+                link(handle.get());
+            }
+            expired.push_back(std::move(handle));
+            timer = next;
+        }
+    }
+
+    void TimerWheel::cascade(size_t level) {
+        size_t slot = (current_ >> (kSlotBits * level)) & kSlotMask;
+        if (slot == 0 && level + 1 < kLevels) cascade(level + 1);
+
+        Timer* timer = slots_[level][slot];
+        slots_[level][slot] = nullptr;
+        while (timer) {
+            Timer* next = timer->next;
+            timer->prev = timer->next = nullptr;
+            --active_;
+            link(timer); // lands on a lower level now that it is closer
+            timer = next;
+        }
+    }
+
+    // First tick in the current level-0 rotation with a timer, or the next
+    // cascade boundary if the rotation is empty
+    uint64_t TimerWheel::next_wakeup_tick() const {
+        uint64_t boundary = (current_ | kSlotMask) + 1;
+        for (uint64_t tick = current_ + 1; tick < boundary; ++tick) {
+            if (slots_[0][tick & kSlotMask]) return tick;
+        }
+        return boundary;
+    }
+
+    void TimerWheel::wake_if_earlier(uint64_t expiry) {
+        if (expiry < next_wakeup_) {
+            next_wakeup_ = expiry;
+            cv_.notify_one();
+        }
+    }
+
+    void TimerWheel::run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (running_) {
+            std::vector<TimerHandle> expired;
+            uint64_t target = now_tick();
+            while (current_ < target) advance(expired);
+
+            if (!expired.empty()) {
+                lock.unlock();
+                fire(expired);
+                lock.lock();
+                continue;
+            }
+
+            if (active_ == 0) {
+                next_wakeup_ = UINT64_MAX;
+                cv_.wait(lock, [this]() { return !running_ || active_ > 0; });
+            } else {
+                next_wakeup_ = next_wakeup_tick();
+                cv_.wait_until(lock, time_of(next_wakeup_));
+            }
+        }
+    }
+
+    void TimerWheel::fire(std::vector<TimerHandle>& expired) {
+        for (TimerHandle& timer : expired) {
+            TaskLane lane = timer->lane;
+            // Copyable, so it can still run here if dispatch rejects its copy
+            auto run = [timer = std::move(timer)]() {
+                std::lock_guard<std::recursive_mutex> run_lock(timer->run_mutex);
+                if (!timer->cancelled) timer->callback();
+            };
+
+            // Without a running pool, or one that stops before taking it,
+            // the callback still fires, on this thread
+            if (!dispatcher_.is_running() || !dispatcher_.dispatch(Task(run), lane)) run();
+        }
+    }
+
+}
@@ -0,0 +1,59 @@
+// src/engine/WorkStealingQueue.cpp
+#include "engine/WorkStealingQueue.hpp"
+
+namespace CMQ {
+
+    WorkStealingQueue::WorkStealingQueue() : size_(0) {}
+
+    void WorkStealingQueue::push(Task task, bool high_priority, std::chrono::steady_clock::time_point enqueued) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (high_priority) {
+            queue_.push_front(Entry{std::move(task), enqueued});
+        } else {
+            queue_.push_back(Entry{std::move(task), enqueued});
+        }
+        size_.store(queue_.size(), std::memory_order_release);
+    }
+
+    bool WorkStealingQueue::pop(Task& task, TaskInfo* info) {
+        if (size_.load(std::memory_order_acquire) == 0) return false;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (queue_.empty()) return false;
+
+        task = std::move(queue_.front().task);
+        if (info) *info = TaskInfo{TaskLane::GameplayTick, queue_.front().enqueued};
+        queue_.pop_front();
+        size_.store(queue_.size(), std::memory_order_release);
+        return true;
+    }
+
+    bool WorkStealingQueue::steal(Task& task, TaskInfo* info) {
+        // Cheap check first so scanning idle peers does not bounce their locks
+        if (size_.load(std::memory_order_acquire) == 0) return false;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (queue_.empty()) return false;
+
+        task = std::move(queue_.back().task);
+        if (info) *info = TaskInfo{TaskLane::GameplayTick, queue_.back().enqueued};
+        queue_.pop_back();
+        size_.store(queue_.size(), std::memory_order_release);
+        return true;
+    }
+
+    void WorkStealingQueue::clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.clear();
+        size_.store(0, std::memory_order_release);
+    }
+
+    size_t WorkStealingQueue::size() const {
+        return size_.load(std::memory_order_acquire);
+    }
+
+    bool WorkStealingQueue::empty() const {
+        return size() == 0;
+    }
+
+} // namespace CMQ
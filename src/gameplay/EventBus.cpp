@@ -9,13 +9,18 @@ namespace CMQ {
         handlers_[event_name].emplace_back(std::move(handler));
     }
 
+    // Handlers run outside the bus lock, so events from different client
+    // strands are handled concurrently rather than one at a time
     void EventBus::emit_event(const std::string& event_name, const std::string& data) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto it = handlers_.find(event_name);
-        if (it != handlers_.end()) {
-            for (const auto& handler : it->second) {
-                handler(data);
-            }
+        std::vector<EventHandler> handlers;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = handlers_.find(event_name);
+            if (it == handlers_.end()) return;
+            handlers = it->second;
+        }
+        for (const auto& handler : handlers) {
+            handler(data);
         }
     }
 
@@ -5,8 +5,9 @@
 
 namespace CMQ {
 
-    GameClient::GameClient(const std::string &server_ip, int port, ProtocolType protocol, bool use_ssl)
-        : NetworkClient(server_ip, port, protocol, use_ssl) {
+    GameClient::GameClient(const std::string &server_ip, int port, ProtocolType protocol, bool use_ssl,
+                           std::shared_ptr<Dispatcher> io_dispatcher)
+        : NetworkClient(server_ip, port, protocol, use_ssl, std::move(io_dispatcher)) {
         register_commands();
         std::cout << "GameClient initialized.\n";
     }
@@ -18,23 +19,52 @@ namespace CMQ {
     }
 
     void GameClient::send_command(const std::string &command, const std::string &params) {
-        auto it = command_registry_.find(command);
-        if (it != command_registry_.end()) {
-            std::string message = command + " " + params;
+        std::string message;
+        if (!command_registry_.count(command)) {
+            std::cerr << "Unknown command: " << command << std::endl;
+        } else if (encode_command(command, params, command_encoding_, message)) {
             send_message(message);
         } else {
-            std::cerr << "Unknown command: " << command << std::endl;
+            std::cerr << "Invalid parameters for " << command << ": " << params << std::endl;
         }
     }
 
+    bool GameClient::encode_command(const std::string &command, std::string_view params, CommandEncoding encoding,
+                                    std::string &message) {
+        const auto& commands = CommandFactory::get_instance().get_registered_commands();
+        auto it = commands.find(command);
+        if (it == commands.end()) return false;
+        if (encoding == CommandEncoding::Text) {
+            message = command + " ";
+            message.append(params);
+            return true;
+        }
+        message.clear();
+        return it->second->encode_text(params, message);
+    }
+
+    void GameClient::set_command_encoding(CommandEncoding encoding) {
+        command_encoding_ = encoding;
+    }
+
     void GameClient::receive_message_async() {
         std::cout << "[DEBUG] receive_message_async started." << std::endl;
+        FrameDecoder decoder;
+        std::vector<std::string> frames;
         while (connected_ && running_) {
-            char buffer[1024];
-            int bytes = recv(client_fd_, buffer, sizeof(buffer), 0);
+            std::span<char> space = decoder.prepare();
+            int bytes = recv(client_fd_, space.data(), space.size(), 0);
             if (bytes > 0) {
-                std::string message(buffer, bytes);
-                std::cout << "[DEBUG] Client received: " << message << std::endl;
+                decoder.commit(static_cast<size_t>(bytes));
+                bool intact = decoder.drain(frames);
+                for (const std::string& message : frames) {
+                    std::cout << "[DEBUG] Client received: " << message << std::endl;
+                }
+                frames.clear();
+                if (!intact) {
+                    std::cerr << "[DEBUG] Malformed frame from server.\n";
+                    break;
+                }
             } else if (bytes == 0) {
                 std::cerr << "[DEBUG] Server closed connection.\n";
                 break;
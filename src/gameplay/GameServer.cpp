@@ -5,14 +5,37 @@
 
 namespace CMQ {
 
-    GameServer::GameServer(int port, std::shared_ptr<MessageQueue<std::string>> queue, ProtocolType protocol, bool use_ssl)
-        : NetworkServer(port, queue, protocol, use_ssl),
+    GameServer::GameServer(int port, std::shared_ptr<MessageQueue<Payload>> queue, ProtocolType protocol, bool use_ssl,
+                           std::shared_ptr<Dispatcher> io_dispatcher, IoBackend backend)
+        : NetworkServer(port, queue, protocol, use_ssl, std::move(io_dispatcher), backend),
           gameplay_system_(std::make_shared<GameplaySystem>()) {
+        gameplay_system_->set_outlet(MessageOutlet{
+            [this](int client_id, std::string message) { return send_to_client(client_id, std::move(message)); },
+            [this](std::string message) { return broadcast(std::move(message)); }});
         std::cout << "GameServer initialized." << std::endl;
     }
 
-    void GameServer::handle_player_message(int client_fd, const std::string &message) {
-        std::istringstream iss(message);
+    // Stop here, while handle_message still reaches this class, so no
+    // session or queued message outlives gameplay_system_
+    GameServer::~GameServer() {
+        stop();
+    }
+
+    void GameServer::handle_message(int client_fd, const Payload &message) {
+        handle_player_message(client_fd, message);
+    }
+
+    void GameServer::set_command_encoding(CommandEncoding encoding) {
+        command_encoding_ = encoding;
+    }
+
+    void GameServer::handle_player_message(int client_fd, std::string_view message) {
+        if (command_encoding_ == CommandEncoding::Binary) {
+            gameplay_system_->execute_command(client_fd, message);
+            return;
+        }
+
+        std::istringstream iss{std::string(message)};
         std::string command_name, params;
         iss >> command_name;
         std::getline(iss, params);
@@ -34,32 +34,68 @@ namespace CMQ {
         event_bus_->emit_event(event_name, data);
     }
 
+    // The text path is the only one that carries client ids as strings
     void GameplaySystem::execute_command(const std::string& command_name, const std::string& params, const std::string& client_id) {
-        if (!rate_limiter_->allow_request(client_id)) {
+        const int id = std::stoi(client_id);
+        if (!rate_limiter_->allow_request(id)) {
             std::cerr << "Client " << client_id << " exceeded rate limit.\n";
             return;
         }
 
         auto command = CommandFactory::get_instance().create_command(command_name);
-        if (command) {
-            command->execute(this, std::stoi(client_id), params); // Pass GameplaySystem
-        } else {
+        if (!command) {
             std::cerr << "Unknown command: " << command_name << std::endl;
+        } else if (!command->execute_text(this, id, params)) {
+            std::cerr << "Malformed " << command_name << " command from client " << client_id << std::endl;
+        }
+    }
+
+    // Binary commands skip the event bus: the opcode indexes the command
+    // directly and its fields are decoded in place from the payload
+    void GameplaySystem::execute_command(int client_id, std::string_view payload) {
+        uint16_t opcode;
+        std::string_view fields;
+        Command* command = read_opcode(payload, opcode, fields) ? CommandFactory::get_instance().find_command(opcode) : nullptr;
+        if (!command) {
+            std::cerr << "Unknown command from client " << client_id << std::endl;
+            return;
+        }
+        if (!rate_limiter_->allow_request(client_id)) {
+            std::cerr << "Client " << client_id << " exceeded rate limit.\n";
+            return;
+        }
+        if (!command->execute(this, client_id, fields)) {
+            std::cerr << "Malformed command " << opcode << " from client " << client_id << std::endl;
         }
     }
 
-    // Broadcast message to all connected players
-    void GameplaySystem::broadcast_message(const std::string& message) {
-        std::lock_guard<std::mutex> lock(player_map_mutex_);
-        for (const auto& [client_id, _] : player_map_) {
+    void GameplaySystem::set_outlet(MessageOutlet outlet) {
+        outlet_ = std::move(outlet);
+    }
+
+    // Broadcast message to all connected players. The outlet encodes it
+    // once and fans it out on the network threads, so no gameplay lock is
+    // held while 2,000 players are queued to.
+    void GameplaySystem::broadcast_message(std::string message) {
+        if (outlet_.broadcast) {
+            outlet_.broadcast(std::move(message));
+        } else {
             std::cout << "[Broadcast] " << message << std::endl;
         }
     }
 
-    // Send a direct message to a specific player
+    // Send a direct message to a specific player; called from that player's
+    // strand, so it needs no lock of its own
+    void GameplaySystem::send_message(int client_id, std::string message) {
+        if (outlet_.send) {
+            outlet_.send(client_id, std::move(message));
+        } else {
+            std::cout << "[Private] to " << client_id << ": " << message << std::endl;
+        }
+    }
+
     void GameplaySystem::send_message(const std::string& client_id, const std::string& message) {
-        std::lock_guard<std::mutex> lock(player_map_mutex_);
-        std::cout << "[Private] to " << client_id << ": " << message << std::endl;
+        send_message(std::stoi(client_id), message);
     }
 
 }
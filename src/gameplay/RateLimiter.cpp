@@ -3,20 +3,23 @@
 
 namespace CMQ {
 
+    namespace {
+        constexpr std::chrono::seconds kCleanupInterval(10); // 每10秒检查
+    }
+
     RateLimiter::RateLimiter(int max_requests, double time_window, size_t max_clients)
         : max_requests_(max_requests), time_window_(time_window),
-          max_clients_(max_clients), running_(true) {
-        cleanup_thread_ = std::thread(&RateLimiter::cleanup_expired_clients, this);
+          max_clients_(max_clients) {
+        cleanup_timer_ = TimerWheel::get_instance().schedule_periodic(
+            kCleanupInterval, [this]() { cleanup_expired_clients(); }, TaskLane::Background);
     }
 
     RateLimiter::~RateLimiter() {
-        running_ = false;
-        if (cleanup_thread_.joinable()) {
-            cleanup_thread_.join();
-        }
+        // Returns once no sweep is running, so the callback never sees a dead this
+        TimerWheel::get_instance().cancel(cleanup_timer_);
     }
 
-    bool RateLimiter::allow_request(const std::string& client_id) {
+    bool RateLimiter::allow_request(int client_id) {
         std::lock_guard<std::mutex> lock(mutex_);
         auto now = std::chrono::steady_clock::now();
 
@@ -54,26 +57,22 @@ namespace CMQ {
 
     void RateLimiter::cleanup_expired_clients() {
         using namespace std::chrono;
-        while (running_) {
-            std::this_thread::sleep_for(seconds(10)); // 每10秒检查
-
-            std::lock_guard<std::mutex> lock(mutex_);
-            auto now = steady_clock::now();
-            for (auto it = request_records_.begin(); it != request_records_.end();) {
-                auto& [record, lru_it] = it->second;
-                if (duration<double>(now - record.second).count() > time_window_) {
-                    lru_list_.erase(lru_it);
-                    it = request_records_.erase(it);
-                } else {
-                    ++it;
-                }
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto now = steady_clock::now();
+        for (auto it = request_records_.begin(); it != request_records_.end();) {
+            auto& [record, lru_it] = it->second;
+            if (duration<double>(now - record.second).count() > time_window_) {
+                lru_list_.erase(lru_it);
+                it = request_records_.erase(it);
+            } else {
+                ++it;
             }
         }
     }
 
     void RateLimiter::cleanup_lru() {
         if (!lru_list_.empty()) {
-            auto lru_client = lru_list_.back();
+            int lru_client = lru_list_.back();
             request_records_.erase(lru_client);
             lru_list_.pop_back();
         }
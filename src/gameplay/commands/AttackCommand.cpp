@@ -3,7 +3,6 @@
 #include "gameplay/commands/CommandFactory.hpp"
 #include "gameplay/GameplaySystem.hpp"
 #include <iostream>
-#include <sstream>
 
 namespace CMQ {
 
@@ -13,18 +12,14 @@ namespace CMQ {
         return true;
     }();
 
-    void AttackCommand::execute(GameplaySystem* system, int client_id, const std::string& params) {
+    void AttackCommand::run(GameplaySystem* system, int client_id, const AttackMessage& message) {
         if (system) {
-            std::istringstream iss(params);
-            std::string target;
-            iss >> target;
-
-            if (target.empty()) {
-                system->send_message(std::to_string(client_id), "Attack failed: No target specified.");
+            if (message.target.empty()) {
+                system->send_message(client_id, "Attack failed: No target specified.");
                 return;
             }
 
-            system->broadcast_message("Player " + std::to_string(client_id) + " attacks " + target + "!");
+            system->broadcast_message("Player " + std::to_string(client_id) + " attacks " + std::string(message.target) + "!");
         }
     }
 
@@ -12,9 +12,9 @@ namespace CMQ {
         return true;
     }();
 
-    void ChatCommand::execute(GameplaySystem* system, int client_id, const std::string& params) {
+    void ChatCommand::run(GameplaySystem* system, int client_id, const ChatMessage& message) {
         if (system) {
-            system->broadcast_message("Player " + std::to_string(client_id) + ": " + params);
+            system->broadcast_message("Player " + std::to_string(client_id) + ": " + std::string(message.text));
         }
     }
 
@@ -17,7 +17,15 @@ namespace CMQ {
         return nullptr;
     }
 
+    Command* CommandFactory::find_command(uint16_t opcode) const {
+        return opcode < by_opcode_.size() ? by_opcode_[opcode] : nullptr;
+    }
+
     void CommandFactory::register_command(const std::string& name, std::shared_ptr<Command> command) {
+        uint16_t opcode = command->opcode();
+        if (opcode >= by_opcode_.size()) by_opcode_.resize(opcode + 1, nullptr);
+        if (by_opcode_[opcode]) std::cerr << "Opcode " << opcode << " reused by command " << name << std::endl;
+        by_opcode_[opcode] = command.get();
         command_registry_[name] = std::move(command);
         std::cout << "Registered command: " << name << std::endl;
     }
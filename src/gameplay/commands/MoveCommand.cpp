@@ -3,7 +3,6 @@
 #include "gameplay/commands/CommandFactory.hpp"
 #include "gameplay/GameplaySystem.hpp"
 #include <iostream>
-#include <sstream>
 
 namespace CMQ {
 
@@ -13,12 +12,9 @@ namespace CMQ {
         return true;
     }();
 
-    void MoveCommand::execute(GameplaySystem* system, int client_id, const std::string& params) {
+    void MoveCommand::run(GameplaySystem* system, int client_id, const MoveMessage& message) {
         if (system) {
-            std::istringstream iss(params);
-            int x, y;
-            iss >> x >> y;
-            system->broadcast_message("Player " + std::to_string(client_id) + " moves to: " + std::to_string(x) + ", " + std::to_string(y));
+            system->broadcast_message("Player " + std::to_string(client_id) + " moves to: " + std::to_string(message.x) + ", " + std::to_string(message.y));
         }
     }
 
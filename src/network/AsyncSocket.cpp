@@ -0,0 +1,63 @@
+// src/network/AsyncSocket.cpp
+#include "network/AsyncSocket.hpp"
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/socket.h>
+
+namespace CMQ {
+
+AsyncSocket::AsyncSocket(int fd, Reactor& reactor) : fd_(fd), reactor_(reactor) {
+    int flags = fcntl(fd_, F_GETFL, 0);
+    if (flags >= 0 && !(flags & O_NONBLOCK)) {
+        fcntl(fd_, F_SETFL, flags | O_NONBLOCK);
+    }
+}
+
+CoTask<ssize_t> AsyncSocket::read(std::span<char> buffer) {
+    while (true) {
+        ssize_t bytes = recv(fd_, buffer.data(), buffer.size(), 0);
+        if (bytes >= 0) co_return bytes;
+        if (errno == EINTR) continue;
+        if (errno != EAGAIN && errno != EWOULDBLOCK) co_return -errno;
+        if (!co_await reactor_.readable(fd_)) co_return -ECANCELED;
+    }
+}
+
+ssize_t AsyncSocket::try_read(std::span<char> buffer) {
+    while (true) {
+        ssize_t bytes = recv(fd_, buffer.data(), buffer.size(), 0);
+        if (bytes >= 0) return bytes;
+        if (errno == EINTR) continue;
+        return errno == EWOULDBLOCK ? -EAGAIN : -errno;
+    }
+}
+
+Reactor::IoAwaitable AsyncSocket::readable() {
+    return reactor_.readable(fd_);
+}
+
+CoTask<ssize_t> AsyncSocket::write(std::span<const char> buffer) {
+    while (true) {
+        ssize_t bytes = send(fd_, buffer.data(), buffer.size(), MSG_NOSIGNAL);
+        if (bytes >= 0) co_return bytes;
+        if (errno == EINTR) continue;
+        if (errno != EAGAIN && errno != EWOULDBLOCK) co_return -errno;
+        if (!co_await reactor_.writable(fd_)) co_return -ECANCELED;
+    }
+}
+
+CoTask<ssize_t> AsyncSocket::write_all(std::span<const char> buffer) {
+    size_t sent = 0;
+    while (sent < buffer.size()) {
+        ssize_t bytes = co_await write(buffer.subspan(sent));
+        if (bytes < 0) co_return bytes;
+        sent += static_cast<size_t>(bytes);
+    }
+    co_return static_cast<ssize_t>(sent);
+}
+
+int AsyncSocket::fd() const {
+    return fd_;
+}
+
+}
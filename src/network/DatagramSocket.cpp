@@ -0,0 +1,167 @@
+// src/network/DatagramSocket.cpp
+#include "network/DatagramSocket.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <netinet/udp.h>
+
+namespace CMQ {
+
+namespace {
+    // Without GRO nothing bigger than a single game datagram arrives; with
+    // it a slot must hold a whole coalesced run
+    constexpr size_t kDatagramSlot = 2048;
+    constexpr size_t kGroSlot = 65536;
+
+    // UDP_SEGMENT limits: segments per send, and a segment must fit an
+    // Ethernet frame or the kernel rejects the send
+    constexpr size_t kMaxSegments = 64;
+    constexpr size_t kMaxSegmentSize = 1472;
+    constexpr size_t kMaxGsoBytes = 65507;
+
+    bool same_peer(const sockaddr_in& a, const sockaddr_in& b) {
+        return a.sin_addr.s_addr == b.sin_addr.s_addr && a.sin_port == b.sin_port;
+    }
+}
+
+DatagramSocket::DatagramSocket(int fd, bool offload) : fd_(fd), gro_(false), gso_(false) {
+    if (offload) {
+        int on = 1, off = 0;
+        gro_ = setsockopt(fd_, SOL_UDP, UDP_GRO, &on, sizeof(on)) == 0;
+        gso_ = setsockopt(fd_, SOL_UDP, UDP_SEGMENT, &off, sizeof(off)) == 0; // probe only; size is set per send
+    }
+    slot_size_ = gro_ ? kGroSlot : kDatagramSlot;
+    receive_buffers_.resize(slot_size_ * kBatch);
+}
+
+int DatagramSocket::fd() const {
+    return fd_;
+}
+
+bool DatagramSocket::offload() const {
+    return gro_ || gso_;
+}
+
+int DatagramSocket::receive(std::vector<Datagram>& out) {
+    for (size_t i = 0; i < kBatch; ++i) {
+        receive_iovecs_[i] = iovec{receive_buffers_.data() + i * slot_size_, slot_size_};
+        msghdr& header = receive_headers_[i].msg_hdr;
+        header = msghdr{};
+        header.msg_name = &receive_peers_[i];
+        header.msg_namelen = sizeof(sockaddr_in);
+        header.msg_iov = &receive_iovecs_[i];
+        header.msg_iovlen = 1;
+        if (gro_) {
+            header.msg_control = receive_control_[i].data;
+            header.msg_controllen = sizeof(receive_control_[i].data);
+        }
+    }
+
+    int count;
+    do {
+        count = recvmmsg(fd_, receive_headers_.data(), kBatch, MSG_DONTWAIT, nullptr);
+    } while (count < 0 && errno == EINTR);
+    if (count < 0) return -errno;
+
+    int produced = 0;
+    for (int i = 0; i < count; ++i) {
+        const msghdr& header = receive_headers_[i].msg_hdr;
+        if (header.msg_flags & MSG_TRUNC) continue; // larger than a slot: not ours to guess at
+
+        const char* data = receive_buffers_.data() + i * slot_size_;
+        const size_t length = receive_headers_[i].msg_len;
+        size_t segment = length;
+        if (gro_) {
+            for (cmsghdr* cmsg = CMSG_FIRSTHDR(&header); cmsg; cmsg = CMSG_NXTHDR(const_cast<msghdr*>(&header), cmsg)) {
+                if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+                    int size;
+                    std::memcpy(&size, CMSG_DATA(cmsg), sizeof(size));
+                    if (size > 0) segment = static_cast<size_t>(size);
+                }
+            }
+        }
+
+        size_t offset = 0;
+        do {
+            size_t size = std::min(segment, length - offset);
+            out.push_back(Datagram{receive_peers_[i], std::string_view(data + offset, size)});
+            offset += size;
+            ++produced;
+        } while (offset < length);
+    }
+    return produced;
+}
+
+// A run of datagrams to one peer, all the size of the first except a
+// shorter last one, goes out as a single UDP_SEGMENT message whose iovecs
+// point at the datagrams themselves
+size_t DatagramSocket::send(std::span<const OutgoingDatagram> datagrams, int& error) {
+    error = 0;
+    size_t sent = 0;
+    while (sent < datagrams.size()) {
+        std::array<size_t, kBatch> run_end;
+        size_t messages = 0;
+        size_t next = sent;
+        send_iovecs_.clear();
+        send_iovecs_.reserve(std::min(datagrams.size() - sent, kBatch * kMaxSegments)); // iovecs must not move
+
+        while (messages < kBatch && next < datagrams.size()) {
+            const size_t first = next;
+            const size_t segment = datagrams[first].bytes().size();
+            size_t total = segment;
+            ++next;
+            if (gso_ && segment > 0 && segment <= kMaxSegmentSize) {
+                while (next < datagrams.size() && next - first < kMaxSegments &&
+                       same_peer(datagrams[next].peer, datagrams[first].peer)) {
+                    size_t size = datagrams[next].bytes().size();
+                    if (size == 0 || size > segment || total + size > kMaxGsoBytes) break;
+                    total += size;
+                    ++next;
+                    if (size < segment) break; // only the last segment may be short
+                }
+            }
+
+            const size_t iov_begin = send_iovecs_.size();
+            for (size_t i = first; i < next; ++i) {
+                std::string_view data = datagrams[i].bytes();
+                send_iovecs_.push_back(iovec{const_cast<char*>(data.data()), data.size()});
+            }
+
+            msghdr& header = send_headers_[messages].msg_hdr;
+            header = msghdr{};
+            header.msg_name = const_cast<sockaddr_in*>(&datagrams[first].peer);
+            header.msg_namelen = sizeof(sockaddr_in);
+            header.msg_iov = send_iovecs_.data() + iov_begin;
+            header.msg_iovlen = next - first;
+            if (next - first > 1) {
+                header.msg_control = send_control_[messages].data;
+                header.msg_controllen = sizeof(send_control_[messages].data);
+                cmsghdr* cmsg = CMSG_FIRSTHDR(&header);
+                cmsg->cmsg_level = SOL_UDP;
+                cmsg->cmsg_type = UDP_SEGMENT;
+                cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+                uint16_t size = static_cast<uint16_t>(segment);
+                std::memcpy(CMSG_DATA(cmsg), &size, sizeof(size));
+            }
+            run_end[messages++] = next;
+        }
+
+        int result = sendmmsg(fd_, send_headers_.data(), static_cast<unsigned>(messages), MSG_DONTWAIT);
+        if (result < 0) {
+            if (errno == EINTR) continue;
+            // No checksum offload on the route: segment in user space from now on
+            if (errno == EIO && gso_) {
+                gso_ = false;
+                continue;
+            }
+            error = errno;
+            return sent;
+        }
+        // A short batch stopped at an error; the next sendmmsg starts at
+        // that datagram and reports it
+        if (result > 0) sent = run_end[static_cast<size_t>(result) - 1];
+    }
+    return sent;
+}
+
+}
@@ -0,0 +1,132 @@
+// src/network/Framing.cpp
+#include "network/Framing.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace CMQ {
+
+namespace {
+    // A 32-bit length never needs more than five 7-bit groups
+    constexpr size_t kMaxHeaderBytes = 5;
+
+    enum class Header { Complete, Partial, Malformed };
+
+    Header read_header(const char* data, size_t size, size_t& length, size_t& header_bytes) {
+        length = 0;
+        for (size_t i = 0; i < kMaxHeaderBytes; ++i) {
+            if (i == size) return Header::Partial;
+            auto byte = static_cast<unsigned char>(data[i]);
+            length |= static_cast<size_t>(byte & 0x7f) << (7 * i);
+            if (!(byte & 0x80)) {
+                header_bytes = i + 1;
+                return Header::Complete;
+            }
+        }
+        return Header::Malformed;
+    }
+}
+
+void append_frame(std::string& out, std::string_view payload) {
+    size_t length = payload.size();
+    do {
+        auto byte = static_cast<char>(length & 0x7f);
+        length >>= 7;
+        out.push_back(length ? static_cast<char>(byte | 0x80) : byte);
+    } while (length);
+    out.append(payload);
+}
+
+std::string encode_frame(std::string_view payload) {
+    std::string frame;
+    frame.reserve(payload.size() + kMaxHeaderBytes);
+    append_frame(frame, payload);
+    return frame;
+}
+
+FrameDecoder::FrameDecoder(size_t max_frame) : max_frame_(max_frame) {}
+
+// Drained frames may still be reading the slab, so the partial frame only
+// slides back within a slab nobody else holds
+std::span<char> FrameDecoder::prepare(size_t min_space) {
+    const size_t capacity = slab_.capacity();
+    if (capacity - end_ < min_space) {
+        const size_t pending = end_ - begin_;
+        const size_t needed = pending + min_space;
+        if (slab_.unique() && needed <= capacity) {
+            std::memmove(slab_.data(), slab_.data() + begin_, pending);
+        } else {
+            size_t size = BufferPool::kSlabSize;
+            if (needed > size) size = needed > capacity ? std::max(needed, capacity * 2) : capacity;
+            SlabRef next = BufferPool::get_instance().acquire(size);
+            if (pending) std::memcpy(next.data(), slab_.data() + begin_, pending);
+            slab_ = std::move(next);
+        }
+        carried_ += pending;
+        begin_ = 0;
+        end_ = pending;
+    }
+    return std::span<char>(slab_.data() + end_, slab_.capacity() - end_);
+}
+
+void FrameDecoder::commit(size_t bytes) {
+    end_ += bytes;
+}
+
+void FrameDecoder::feed(std::string_view bytes) {
+    std::span<char> space = prepare(bytes.size());
+    std::memcpy(space.data(), bytes.data(), bytes.size());
+    commit(bytes.size());
+}
+
+bool FrameDecoder::drain(std::vector<Payload>& frames) {
+    size_t offset = 0, length = 0;
+    while (next_frame(offset, length)) frames.emplace_back(slab_, slab_.data() + offset, length);
+    rewind();
+    return !corrupt_;
+}
+
+bool FrameDecoder::drain(std::vector<std::string>& frames) {
+    size_t offset = 0, length = 0;
+    while (next_frame(offset, length)) frames.emplace_back(slab_.data() + offset, length);
+    rewind();
+    return !corrupt_;
+}
+
+void FrameDecoder::release() {
+    if (begin_ != end_) return;
+    slab_.reset();
+    begin_ = end_ = 0;
+}
+
+size_t FrameDecoder::buffered() const {
+    return end_ - begin_;
+}
+
+size_t FrameDecoder::carried() const {
+    return carried_;
+}
+
+bool FrameDecoder::next_frame(size_t& offset, size_t& length) {
+    if (corrupt_ || begin_ == end_) return false;
+    size_t header_bytes = 0;
+    Header header = read_header(slab_.data() + begin_, end_ - begin_, length, header_bytes);
+    if (header == Header::Partial) return false;
+    if (header == Header::Malformed || length > max_frame_) {
+        corrupt_ = true;
+        return false;
+    }
+    if (end_ - begin_ < header_bytes + length) return false;
+
+    offset = begin_ + header_bytes;
+    begin_ = offset + length;
+    return true;
+}
+
+// Once everything is consumed, reads start over at the front of a slab
+// this decoder alone holds; a shared one is filled on past the frames
+// still in use
+void FrameDecoder::rewind() {
+    if (begin_ == end_ && slab_.unique()) begin_ = end_ = 0;
+}
+
+}
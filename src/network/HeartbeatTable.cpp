@@ -0,0 +1,106 @@
+// src/network/HeartbeatTable.cpp
+#include "network/HeartbeatTable.hpp"
+#include <algorithm>
+
+namespace CMQ {
+
+namespace {
+    int64_t nanoseconds(HeartbeatTable::Clock::time_point time) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+    }
+}
+
+// A deadline is at most one timeout past the interval being checked, so
+// timeout / interval buckets plus two for rounding never wrap onto a live one
+HeartbeatTable::HeartbeatTable(HeartbeatOptions options)
+    : options_(options),
+      timeout_ns_(std::chrono::nanoseconds(options.timeout).count()),
+      interval_ns_(std::max<int64_t>(std::chrono::nanoseconds(options.interval).count(), 1)),
+      buckets_(static_cast<size_t>(timeout_ns_ / interval_ns_) + 3),
+      cursor_(nanoseconds(Clock::now()) / interval_ns_) {}
+
+HeartbeatTable::~HeartbeatTable() {
+    for (auto& chunk : chunks_) delete[] chunk.load(std::memory_order_relaxed);
+}
+
+bool HeartbeatTable::track(int id, Clock::time_point now) {
+    if (id < 0 || static_cast<size_t>(id) >= kChunkSize * kMaxChunks) return false;
+    const int64_t seen = nanoseconds(now);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::atomic<Slot*>& chunk = chunks_[static_cast<size_t>(id) >> kChunkBits];
+    if (!chunk.load(std::memory_order_relaxed)) chunk.store(new Slot[kChunkSize], std::memory_order_release);
+    Slot& entry = chunk.load(std::memory_order_relaxed)[static_cast<size_t>(id) & (kChunkSize - 1)];
+
+    entry.last_seen.store(seen, std::memory_order_relaxed);
+    uint32_t generation = entry.generation.load(std::memory_order_relaxed);
+    if (generation & 1) return true;
+    // forget() only ever moves an odd generation on, so this cannot race it
+    entry.generation.store(++generation, std::memory_order_relaxed);
+
+    const int64_t bucket = bucket_index(seen + timeout_ns_);
+    buckets_[static_cast<size_t>(bucket) % buckets_.size()].push_back(Entry{id, generation});
+    return true;
+}
+
+void HeartbeatTable::touch(int id, Clock::time_point now) {
+    if (Slot* entry = slot(id)) entry->last_seen.store(nanoseconds(now), std::memory_order_relaxed);
+}
+
+void HeartbeatTable::forget(int id) {
+    Slot* entry = slot(id);
+    if (!entry) return;
+    uint32_t generation = entry->generation.load(std::memory_order_relaxed);
+    while ((generation & 1) &&
+           !entry->generation.compare_exchange_weak(generation, generation + 1, std::memory_order_relaxed)) {}
+}
+
+bool HeartbeatTable::tracked(int id) const {
+    Slot* entry = slot(id);
+    return entry && (entry->generation.load(std::memory_order_relaxed) & 1);
+}
+
+// Walks the buckets from the last check up to now. After a long gap every
+// bucket is walked once: each entry checks its own deadline, so none is
+// missed, only late.
+void HeartbeatTable::expire(std::vector<int>& expired, Clock::time_point now) {
+    const int64_t now_ns = nanoseconds(now);
+    const int64_t current = now_ns / interval_ns_;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    const int64_t steps = std::min<int64_t>(current - cursor_ + 1, static_cast<int64_t>(buckets_.size()));
+    std::vector<Entry> due;
+    for (int64_t step = 0; step < steps; ++step) {
+        due.clear();
+        due.swap(buckets_[static_cast<size_t>(cursor_ + step) % buckets_.size()]);
+        for (const Entry& item : due) {
+            Slot& entry = *slot(item.id);
+            uint32_t generation = item.generation;
+            if (entry.generation.load(std::memory_order_relaxed) != generation) continue; // forgotten or re-tracked
+
+            const int64_t deadline = entry.last_seen.load(std::memory_order_relaxed) + timeout_ns_;
+            if (deadline > now_ns) {
+                buckets_[static_cast<size_t>(bucket_index(deadline)) % buckets_.size()].push_back(item);
+            } else if (entry.generation.compare_exchange_strong(generation, generation + 1, std::memory_order_relaxed)) {
+                expired.push_back(item.id);
+            }
+        }
+    }
+    cursor_ = std::max(cursor_, current + 1);
+}
+
+const HeartbeatOptions& HeartbeatTable::options() const {
+    return options_;
+}
+
+HeartbeatTable::Slot* HeartbeatTable::slot(int id) const {
+    if (id < 0 || static_cast<size_t>(id) >= kChunkSize * kMaxChunks) return nullptr;
+    Slot* chunk = chunks_[static_cast<size_t>(id) >> kChunkBits].load(std::memory_order_acquire);
+    return chunk ? &chunk[static_cast<size_t>(id) & (kChunkSize - 1)] : nullptr;
+}
+
+int64_t HeartbeatTable::bucket_index(int64_t deadline) const {
+    return (deadline + interval_ns_ - 1) / interval_ns_;
+}
+
+}
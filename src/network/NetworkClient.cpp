@@ -1,32 +1,66 @@
 // src/network/NetworkClient.cpp
 #include "network/NetworkClient.hpp"
+#include "network/TlsSocket.hpp"
 #include <iostream>
 #include <sstream>
 #include <chrono>
+#include <fcntl.h>
+#include <netinet/tcp.h>
+#include <poll.h>
 
 namespace CMQ {
 
-NetworkClient::NetworkClient(const std::string &server_ip, int port, ProtocolType protocol, bool use_ssl)
+namespace {
+    constexpr std::chrono::seconds kHeartbeatInterval(5);
+
+    // One flush writes at most this many messages (datagrams over UDP), or
+    // one TLS record
+    constexpr size_t kMaxFlushIovecs = 64;
+    constexpr size_t kTlsRecordBytes = 16 * 1024;
+
+    constexpr std::chrono::seconds kReconnectDelay(2);
+
+    // Blocks until fd is ready for what OpenSSL asked for, or broken
+    void wait_for_tls(int fd, int ssl_error) {
+        pollfd ready{fd, static_cast<short>(ssl_error == SSL_ERROR_WANT_READ ? POLLIN : POLLOUT), 0};
+        poll(&ready, 1, -1);
+    }
+}
+
+NetworkClient::NetworkClient(const std::string &server_ip, int port, ProtocolType protocol, bool use_ssl,
+                             std::shared_ptr<Dispatcher> dispatcher)
     : server_ip_(server_ip), port_(port), protocol_(protocol),
-      use_ssl_(use_ssl), connected_(false), running_(true),
-      heartbeat_active_(false), ssl_ctx_(nullptr), ssl_(nullptr) {
+      use_ssl_(use_ssl),
+      dispatcher_(dispatcher ? std::move(dispatcher)
+                             : std::shared_ptr<Dispatcher>(&Dispatcher::get_instance(), [](Dispatcher*){})),
+      connected_(false), running_(true),
+      ssl_ctx_(nullptr), ssl_(nullptr) {
 #ifdef _WIN32
     WSAStartup(MAKEWORD(2, 2), &wsa_data_);
 #endif
     if (use_ssl_) initialize_ssl();
-    Dispatcher::get_instance().start(2); // Use Singleton Dispatcher
+    dispatcher_->start(2); // no-op if the pool is already running
 }
 
+// Leaves the pool running: a server or other clients may still be using it
 NetworkClient::~NetworkClient() {
     disconnect();
     cleanup_ssl();
-    Dispatcher::get_instance().stop(); // Singleton Dispatcher shutdown
 #ifdef _WIN32
     WSACleanup();
 #endif
 }
 
+void NetworkClient::set_send_options(const SendOptions& options) {
+    send_options_ = options;
+}
+
 bool NetworkClient::connect_server() {
+    running_ = true;
+    return open_connection();
+}
+
+bool NetworkClient::open_connection() {
     client_fd_ = socket(AF_INET, (protocol_ == ProtocolType::TCP) ? SOCK_STREAM : SOCK_DGRAM, 0);
     if (client_fd_ < 0) {
         std::cerr << "Failed to create socket.\n";
@@ -38,65 +72,255 @@ bool NetworkClient::connect_server() {
     server_addr.sin_port = htons(port_);
     inet_pton(AF_INET, server_ip_.c_str(), &server_addr.sin_addr);
 
+    // A connected UDP socket sends to the server by default and only
+    // accepts datagrams from it
+    if (connect(client_fd_, (struct sockaddr *)&server_addr, sizeof(server_addr)) < 0) {
+        std::cerr << "Failed to connect to server.\n";
+        close_socket(client_fd_);
+        client_fd_ = -1;
+        return false;
+    }
+
     if (protocol_ == ProtocolType::TCP) {
-        if (connect(client_fd_, (struct sockaddr *)&server_addr, sizeof(server_addr)) < 0) {
-            std::cerr << "Failed to connect to TCP server.\n";
-            close_socket(client_fd_);
-            return false;
-        }
+        int no_delay = send_options_.no_delay ? 1 : 0;
+        setsockopt(client_fd_, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
 
         // Initialize SSL connection if enabled
+        // The handshake blocks; afterwards the socket is non-blocking so
+        // the reader and the flusher can take turns on the SSL object
         if (use_ssl_) {
-            ssl_ = SSL_new(ssl_ctx_);
-            SSL_set_fd(ssl_, client_fd_);
-            if (SSL_connect(ssl_) <= 0) {
+            SSL* ssl = SSL_new(ssl_ctx_);
+            set_tls_socket(ssl, client_fd_); // SIGPIPE-free writes
+            SSL_set_app_data(ssl, this);
+            {
+                std::lock_guard<std::mutex> lock(tls_session_mutex_);
+                if (tls_session_) SSL_set_session(ssl, tls_session_);
+            }
+            if (SSL_connect(ssl) <= 0) {
                 std::cerr << "SSL handshake failed.\n";
+                SSL_free(ssl);
                 close_socket(client_fd_);
+                client_fd_ = -1;
                 return false;
             }
+            tls_session_reused_ = SSL_session_reused(ssl);
+            fcntl(client_fd_, F_SETFL, fcntl(client_fd_, F_GETFL, 0) | O_NONBLOCK);
+
+            std::lock_guard<std::mutex> lock(ssl_mutex_);
+            ssl_ = ssl;
         }
     }
 
+    {
+        std::lock_guard<std::mutex> lock(outbound_mutex_);
+        outbound_ = std::make_shared<Outbound>(client_fd_);
+    }
     connected_ = true;
     std::cout << "Connected to server: " << server_ip_ << ":" << port_ << std::endl;
     start_heartbeat();
     return true;
 }
 
+// The shutdown wakes a reader blocked on the socket; it sees running_
+// cleared and stops instead of reconnecting
 void NetworkClient::disconnect() {
     running_ = false;
     connected_ = false;
-    heartbeat_active_ = false;
-    heartbeat_cv_.notify_all();
+    if (client_fd_ >= 0) shutdown(client_fd_, SHUT_RDWR);
+    wait_for_reader();
+    close_connection();
+}
+
+// A flush still running owns the socket from here: the shutdown ends any
+// write it is blocked in, and it closes the fd as it finishes. A flush
+// timer cancelled before it fired still owes its flush, which runs here
+// just to release the socket.
+void NetworkClient::close_connection() {
+    connected_ = false;
+    stop_heartbeat();
+    std::shared_ptr<Outbound> outbound;
+    TimerWheel::TimerHandle flush_timer;
+    {
+        std::lock_guard<std::mutex> lock(outbound_mutex_);
+        outbound = std::move(outbound_);
+        flush_timer = std::move(flush_timer_);
+    }
+    TimerWheel::get_instance().cancel(flush_timer);
 
-    if (heartbeat_thread_.joinable()) {
-        heartbeat_thread_.join();
+    // Without close_notify OpenSSL takes the connection for broken and
+    // marks its session unresumable
+    {
+        std::lock_guard<std::mutex> lock(ssl_mutex_);
+        if (ssl_) {
+            SSL_shutdown(ssl_);
+            SSL_free(ssl_);
+            ssl_ = nullptr;
+        }
     }
+    if (client_fd_ < 0) return;
 
-    close_socket(client_fd_);
-    if (ssl_) {
-        SSL_free(ssl_);
-        ssl_ = nullptr;
+    if (!outbound || outbound->queue.close()) {
+        close_socket(client_fd_);
+    } else {
+        shutdown(client_fd_, SHUT_RDWR);
+        if (outbound->timer_pending.exchange(false)) flush_outbound(outbound);
     }
+    client_fd_ = -1;
 }
 
 bool NetworkClient::is_connected() const {
     return connected_;
 }
 
+bool NetworkClient::has_tls_session() const {
+    std::lock_guard<std::mutex> lock(tls_session_mutex_);
+    return tls_session_ != nullptr;
+}
+
+bool NetworkClient::tls_session_reused() const {
+    return tls_session_reused_;
+}
+
 void NetworkClient::send_message(const std::string &message) {
     if (!connected_) {
         std::cerr << "Not connected to server.\n";
         return;
     }
 
-    dispatcher_->dispatch([this, message]() {
-        if (use_ssl_) {
-            SSL_write(ssl_, message.c_str(), message.size());
+    if (protocol_ == ProtocolType::UDP && message.empty()) return; // nothing for the server to read
+
+    std::shared_ptr<Outbound> outbound;
+    {
+        std::lock_guard<std::mutex> lock(outbound_mutex_);
+        outbound = outbound_;
+    }
+    if (!outbound) return; // closed since the check
+    switch (outbound->queue.push(protocol_ == ProtocolType::TCP ? encode_frame(message) : message)) {
+    case OutboundQueue::Push::Flush:
+        start_flush(outbound);
+        break;
+    case OutboundQueue::Push::Overflow:
+        std::cerr << "Server is not reading; message dropped.\n";
+        break;
+    default:
+        break;
+    }
+}
+
+// With a flush window the writer is a timer, so whatever is sent before it
+// fires joins the first write. Scheduling under outbound_mutex_ keeps
+// flush_timer_ on the newest writer: the next one cannot start before
+// this one has run. Whichever of the timer and close_connection claims
+// timer_pending first runs the flush. A connection that already closed,
+// or a stopped pool, gets its flush on this thread: it must still run to
+// release the socket.
+void NetworkClient::start_flush(const std::shared_ptr<Outbound>& outbound) {
+    if (send_options_.flush_window.count() <= 0) {
+        if (!dispatcher_->dispatch([this, outbound]() { flush_outbound(outbound); }, TaskLane::NetworkIO)) {
+            flush_outbound(outbound);
+        }
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(outbound_mutex_);
+        if (outbound_ == outbound) {
+            outbound->timer_pending = true;
+            flush_timer_ = TimerWheel::get_instance().schedule(send_options_.flush_window, [this, outbound]() {
+                if (outbound->timer_pending.exchange(false)) flush_outbound(outbound);
+            }, TaskLane::NetworkIO);
+            return;
+        }
+    }
+    flush_outbound(outbound);
+}
+
+// Messages sent while a flush runs join its next write, so a burst costs
+// one sendmsg (sendmmsg over UDP, or TLS record) instead of one task and
+// syscall each. Corked, even TLS records and writes past kMaxFlushIovecs
+// leave as full segments.
+void NetworkClient::flush_outbound(const std::shared_ptr<Outbound>& outbound) {
+    OutboundQueue& queue = outbound->queue;
+    const int fd = outbound->fd;
+    const bool tls = use_ssl_ && protocol_ == ProtocolType::TCP;
+    const bool cork = send_options_.cork && protocol_ == ProtocolType::TCP;
+    if (cork) set_cork(fd, true);
+
+    std::vector<iovec> iovecs;
+    std::string record;
+    auto end = OutboundQueue::FlushEnd::More;
+    while (end == OutboundQueue::FlushEnd::More) {
+        ssize_t written;
+        if (tls) {
+            record.clear();
+            if (queue.gather(record, kTlsRecordBytes) == 0) {
+                end = queue.end_flush();
+                continue;
+            }
+            written = write_tls(fd, record);
         } else {
-            send(client_fd_, message.c_str(), message.size(), 0);
+            iovecs.clear();
+            if (queue.gather(iovecs, kMaxFlushIovecs) == 0) {
+                end = queue.end_flush();
+                continue;
+            }
+            if (protocol_ == ProtocolType::UDP) {
+                written = write_datagrams(fd, iovecs);
+            } else {
+                msghdr message{};
+                message.msg_iov = iovecs.data();
+                message.msg_iovlen = iovecs.size();
+                written = sendmsg(fd, &message, MSG_NOSIGNAL);
+            }
+        }
+        if (written > 0) {
+            queue.consume(static_cast<size_t>(written));
+        } else if (!(written < 0 && !tls && errno == EINTR)) {
+            end = queue.end_flush(true); // the reader notices the broken connection
+        }
+    }
+    if (cork) set_cork(fd, false); // sends the partial segment left over
+    if (end == OutboundQueue::FlushEnd::Release) close_socket(fd); // the connection closed during the flush
+}
+
+// Each iovec is one whole message. Returns the bytes of the datagrams
+// sent; one the kernel refuses (e.g. after an ICMP unreachable) is counted
+// as sent, like a datagram lost on the way.
+ssize_t NetworkClient::write_datagrams(int fd, const std::vector<iovec>& datagrams) {
+    mmsghdr messages[kMaxFlushIovecs]{};
+    for (size_t i = 0; i < datagrams.size(); ++i) {
+        messages[i].msg_hdr.msg_iov = const_cast<iovec*>(&datagrams[i]);
+        messages[i].msg_hdr.msg_iovlen = 1;
+    }
+    int sent = sendmmsg(fd, messages, static_cast<unsigned>(datagrams.size()), MSG_NOSIGNAL);
+    if (sent < 0) return errno == EINTR ? -1 : static_cast<ssize_t>(datagrams[0].iov_len);
+
+    ssize_t bytes = 0;
+    for (int i = 0; i < sent; ++i) bytes += static_cast<ssize_t>(datagrams[i].iov_len);
+    return bytes;
+}
+
+void NetworkClient::set_cork(int fd, bool on) {
+    int cork = on ? 1 : 0;
+    setsockopt(fd, IPPROTO_TCP, TCP_CORK, &cork, sizeof(cork));
+}
+
+// A would-block write is retried with the same record, as OpenSSL requires.
+// An SSL object on another fd belongs to a newer connection: fd stays open
+// until this flush ends, so the new socket cannot have its number.
+ssize_t NetworkClient::write_tls(int fd, const std::string& record) {
+    while (true) {
+        int written;
+        int error = SSL_ERROR_SSL;
+        {
+            std::lock_guard<std::mutex> lock(ssl_mutex_);
+            if (!ssl_ || SSL_get_fd(ssl_) != fd) return -1;
+            written = SSL_write(ssl_, record.data(), static_cast<int>(record.size()));
+            if (written <= 0) error = SSL_get_error(ssl_, written);
         }
-    });
+        if (written > 0) return written;
+        if (error != SSL_ERROR_WANT_READ && error != SSL_ERROR_WANT_WRITE) return -1;
+        wait_for_tls(fd, error);
+    }
 }
 
 void NetworkClient::receive_message_async() {
@@ -104,30 +328,86 @@ void NetworkClient::receive_message_async() {
         std::cerr << "Not connected to server.\n";
         return;
     }
+    {
+        std::lock_guard<std::mutex> lock(reader_mutex_);
+        if (reading_) return;
+        reading_ = true;
+    }
 
-    dispatcher_->dispatch([this]() {
+    // Running the reader inline would block the caller for the whole
+    // connection, so a stopped pool just leaves the client unread
+    const bool dispatched = dispatcher_->dispatch([this]() {
+        {
+            std::lock_guard<std::mutex> lock(reader_mutex_);
+            reader_thread_ = std::this_thread::get_id();
+        }
         if (protocol_ == ProtocolType::TCP) {
             handle_tcp();
         } else {
             handle_udp();
         }
-    });
+        std::lock_guard<std::mutex> lock(reader_mutex_);
+        reading_ = false;
+        reader_thread_ = {};
+        reader_cv_.notify_all();
+    }, TaskLane::NetworkIO);
+    if (!dispatched) {
+        std::cerr << "Cannot start the reader: its dispatcher is stopped.\n";
+        std::lock_guard<std::mutex> lock(reader_mutex_);
+        reading_ = false;
+        reader_cv_.notify_all();
+    }
+}
+
+// disconnect() from the reader itself (e.g. a message handler) cannot wait
+void NetworkClient::wait_for_reader() {
+    std::unique_lock<std::mutex> lock(reader_mutex_);
+    if (reader_thread_ == std::this_thread::get_id()) return;
+    reader_cv_.wait(lock, [this]() { return !reading_; });
 }
 
 void NetworkClient::handle_tcp() {
-    char buffer[1024];
-    while (connected_) {
-        int bytes = use_ssl_ ? SSL_read(ssl_, buffer, sizeof(buffer)) : recv(client_fd_, buffer, sizeof(buffer), 0);
+    FrameDecoder decoder;
+    std::vector<std::string> frames;
+    while (connected_ && running_) {
+        std::span<char> space = decoder.prepare();
+        int bytes;
+        if (use_ssl_) {
+            int error = SSL_ERROR_SSL;
+            int fd;
+            {
+                std::lock_guard<std::mutex> lock(ssl_mutex_);
+                bytes = ssl_ ? SSL_read(ssl_, space.data(), static_cast<int>(space.size())) : 0;
+                if (bytes <= 0 && ssl_) error = SSL_get_error(ssl_, bytes);
+                fd = client_fd_;
+            }
+            if (bytes <= 0 && (error == SSL_ERROR_WANT_READ || error == SSL_ERROR_WANT_WRITE)) {
+                wait_for_tls(fd, error);
+                continue;
+            }
+        } else {
+            bytes = recv(client_fd_, space.data(), space.size(), 0);
+        }
         if (bytes > 0) {
-            std::string msg(buffer, bytes);
-            std::cout << "Received: " << msg << std::endl;
-            if (msg == "HEARTBEAT") {
-                send_message("PONG");
+            decoder.commit(static_cast<size_t>(bytes));
+            bool intact = decoder.drain(frames);
+            for (const std::string& msg : frames) {
+                std::cout << "Received: " << msg << std::endl;
+                if (msg == "HEARTBEAT") {
+                    send_message("PONG");
+                }
+            }
+            frames.clear();
+            if (!intact) {
+                std::cerr << "Malformed frame from server.\n";
+                if (!reconnect()) break;
+                decoder = FrameDecoder();
             }
         } else {
+            if (!running_) break;
             std::cerr << "Disconnected from server.\n";
-            reconnect();
-            break;
+            if (!reconnect()) break;
+            decoder = FrameDecoder();
         }
     }
 }
@@ -146,48 +426,76 @@ void NetworkClient::handle_udp() {
 }
 
 void NetworkClient::start_heartbeat() {
-    heartbeat_active_ = true;
-    heartbeat_thread_ = std::thread(&NetworkClient::monitor_heartbeat, this);
-}
-
-void NetworkClient::monitor_heartbeat() {
-    using namespace std::chrono_literals;
-    while (heartbeat_active_) {
-        std::this_thread::sleep_for(5s);
+    stop_heartbeat();
+    auto timer = TimerWheel::get_instance().schedule_periodic(kHeartbeatInterval, [this]() {
         if (connected_) {
             send_message("HEARTBEAT");
         }
+    }, TaskLane::Heartbeat);
+
+    std::lock_guard<std::mutex> lock(heartbeat_mutex_);
+    heartbeat_timer_ = std::move(timer);
+}
+
+void NetworkClient::stop_heartbeat() {
+    TimerWheel::TimerHandle timer;
+    {
+        std::lock_guard<std::mutex> lock(heartbeat_mutex_);
+        timer = std::move(heartbeat_timer_);
     }
+    TimerWheel::get_instance().cancel(timer);
 }
 
-void NetworkClient::reconnect() {
-    disconnect();
+// Keeps the reader going on the new connection. With TLS the saved
+// session makes the new handshake an abbreviated one.
+bool NetworkClient::reconnect() {
+    close_connection();
     std::cout << "Attempting to reconnect...\n";
-    std::this_thread::sleep_for(std::chrono::seconds(2)); // Reconnect delay
 
-    while (!connected_ && running_) {
+    while (running_) {
+        std::this_thread::sleep_for(kReconnectDelay);
+        if (!running_) break;
         std::cout << "Reconnecting...\n";
-        if (connect_server()) {
+        if (open_connection()) {
             std::cout << "Reconnected to server.\n";
-            return;
+            return true;
         }
-        std::this_thread::sleep_for(std::chrono::seconds(2));
     }
+    return false;
 }
 
+// Sessions live in this client rather than OpenSSL's internal store: the
+// server (and which port it is on) is fixed per client
 void NetworkClient::initialize_ssl() {
     SSL_load_error_strings();
     OpenSSL_add_ssl_algorithms();
     ssl_ctx_ = SSL_CTX_new(TLS_client_method());
+    if (!ssl_ctx_) return;
+    SSL_CTX_set_session_cache_mode(ssl_ctx_, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    SSL_CTX_sess_set_new_cb(ssl_ctx_, &NetworkClient::on_new_session);
 }
 
 void NetworkClient::cleanup_ssl() {
+    if (tls_session_) {
+        SSL_SESSION_free(tls_session_);
+        tls_session_ = nullptr;
+    }
     if (ssl_ctx_) {
         SSL_CTX_free(ssl_ctx_);
         EVP_cleanup();
     }
 }
 
+// Runs inside SSL_connect or SSL_read (TLS 1.3 tickets arrive after the
+// handshake); the newest session replaces the saved one
+int NetworkClient::on_new_session(SSL* ssl, SSL_SESSION* session) {
+    auto* client = static_cast<NetworkClient*>(SSL_get_app_data(ssl));
+    std::lock_guard<std::mutex> lock(client->tls_session_mutex_);
+    if (client->tls_session_) SSL_SESSION_free(client->tls_session_);
+    client->tls_session_ = session;
+    return 1; // the reference is ours
+}
+
 void NetworkClient::close_socket(int fd) {
 #ifdef _WIN32
     closesocket(fd);
@@ -1,133 +1,258 @@
 // src/network/NetworkServer.cpp
 #include "network/NetworkServer.hpp"
+#include "network/AsyncSocket.hpp"
+#include "network/TlsSocket.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <iostream>
 
 namespace CMQ {
 
-NetworkServer::NetworkServer(int port, std::shared_ptr<MessageQueue<std::string>> queue, ProtocolType protocol, bool use_ssl)
+namespace {
+    // One flush writes at most this much: iovecs per sendmsg, one TLS
+    // record, or one io_uring send buffer
+    constexpr size_t kMaxFlushIovecs = 64;
+    constexpr size_t kTlsRecordBytes = 16 * 1024;
+    constexpr size_t kUringSendBytes = 64 * 1024;
+
+    // How long stop() waits for client sessions and queued messages to finish
+    constexpr std::chrono::seconds kSessionDrainTimeout(2);
+
+    // Every player's datagrams queue on one socket; room for bursts while
+    // the loop is busy (the kernel caps this at net.core.rmem_max)
+    constexpr int kDatagramBufferBytes = 4 << 20;
+
+    // Resumed sessions must come from this server's cache or tickets
+    constexpr unsigned char kTlsSessionContext[] = "CMQ::NetworkServer";
+
+    // An SSL_write that needs a read (or SSL_read that needs a write) only
+    // happens around key updates; the other direction owns that reactor
+    // wait, so the call is simply retried after this
+    constexpr std::chrono::milliseconds kTlsRetryDelay(1);
+
+    // Back-off when the process is out of descriptors; the pending
+    // connection stays in the backlog until accept can take it
+    constexpr std::chrono::milliseconds kAcceptRetryDelay(100);
+
+    // The socket reuses its receive buffers for the next batch, so each
+    // datagram is copied out, packed into slabs shared with the rest of
+    // its batch (and the next, until the slab is full)
+    Payload copy_datagram(std::string_view data, SlabRef& slab, size_t& used) {
+        if (!slab || slab.capacity() - used < data.size()) {
+            slab = BufferPool::get_instance().acquire(std::max(data.size(), BufferPool::kSlabSize));
+            used = 0;
+        }
+        char* at = slab.data() + used;
+        std::memcpy(at, data.data(), data.size());
+        used += data.size();
+        return Payload(slab, at, data.size());
+    }
+
+    // Bound, listening (TCP) and non-blocking; -1 on failure
+    int open_listener(int port, bool datagram) {
+        int fd = socket(AF_INET, (datagram ? SOCK_DGRAM : SOCK_STREAM) | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            perror("Failed to create socket");
+            return -1;
+        }
+
+        sockaddr_in server_addr{};
+        server_addr.sin_family = AF_INET;
+        server_addr.sin_addr.s_addr = INADDR_ANY;
+        server_addr.sin_port = htons(port);
+
+        int opt = 1;
+#ifdef _WIN32
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, (const char*)&opt, sizeof(opt));
+#else
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+        setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt));
+#endif
+
+        if (datagram) {
+            setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &kDatagramBufferBytes, sizeof(kDatagramBufferBytes));
+            setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &kDatagramBufferBytes, sizeof(kDatagramBufferBytes));
+        }
+
+        if (bind(fd, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0 ||
+            (!datagram && listen(fd, SOMAXCONN) < 0)) {
+            perror("Failed to bind socket");
+            close(fd);
+            return -1;
+        }
+
+#ifdef _WIN32
+        u_long mode = 1;
+        ioctlsocket(fd, FIONBIO, &mode);
+#else
+        int flags = fcntl(fd, F_GETFL, 0);
+        if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+            perror("Failed to set non-blocking mode");
+            close(fd);
+            return -1;
+        }
+#endif
+        return fd;
+    }
+
+    size_t default_shard_count() {
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+NetworkServer::NetworkServer(int port, std::shared_ptr<MessageQueue<Payload>> queue, ProtocolType protocol, bool use_ssl,
+                             std::shared_ptr<Dispatcher> dispatcher, IoBackend backend)
     : port_(port), protocol_(protocol), running_(false),
       message_queue_(queue), use_ssl_(use_ssl), ssl_ctx_(nullptr),
-    dispatcher_(std::shared_ptr<Dispatcher>(&Dispatcher::get_instance(), [](Dispatcher*){})){
+    dispatcher_(dispatcher ? std::move(dispatcher)
+                           : std::shared_ptr<Dispatcher>(&Dispatcher::get_instance(), [](Dispatcher*){})),
+    backend_(backend), shard_count_(default_shard_count()), heartbeats_(std::make_unique<HeartbeatTable>()) {
 #ifdef _WIN32
     WSAStartup(MAKEWORD(2, 2), &wsa_data_);
 #endif
     if (use_ssl_) initialize_ssl();
-    Dispatcher::get_instance().start(4); // Use Singleton Dispatcher
 }
 
+// The pool may be shared with other servers and clients, so it is left
+// running; whoever created it stops it
 NetworkServer::~NetworkServer() {
     stop();
     cleanup_ssl();
-    Dispatcher::get_instance().stop(); // Singleton Dispatcher shutdown
 #ifdef _WIN32
     WSACleanup();
 #endif
     }
 
 void NetworkServer::start() {
+    initialize_socket();
+    if (shards_.empty()) return;
+
     running_ = true;
     dispatcher_->start();
-    accept_thread_ = std::thread(&NetworkServer::accept_connections, this);
-    heartbeat_thread_ = std::thread(&NetworkServer::monitor_heartbeat, this);
-    std::cout << "NetworkServer started on port " << port_ << std::endl;
+    heartbeat_sweep_ = TimerWheel::get_instance().schedule_periodic(heartbeats_->options().interval, [this]() {
+        sweep_heartbeats();
+    }, TaskLane::Heartbeat);
+    if (protocol_ == ProtocolType::UDP) {
+        Shard& shard = *shards_.front();
+        datagram_socket_ = std::make_unique<DatagramSocket>(shard.listen_fd, udp_offload_);
+        shard.reactor.start();
+        begin_work();
+        co_spawn(*dispatcher_, serve_datagrams(), TaskLane::NetworkIO);
+    } else {
+        for (auto& shard : shards_) {
+            if (start_uring(*shard)) continue;
+            shard->reactor.start();
+            begin_work();
+            co_spawn(*dispatcher_, accept_connections(*shard), TaskLane::NetworkIO);
+        }
+    }
+    std::cout << "NetworkServer started on port " << port_ << " with " << shards_.size()
+              << (shards_.size() == 1 ? " listener" : " listeners") << std::endl;
 }
 
 void NetworkServer::stop() {
     running_ = false;
     std::cout << "[INFO] Stopping NetworkServer..." << std::endl;
 
-    if (server_fd_ >= 0) {
+    // Cancels each accept or datagram loop's wait; it finishes like any
+    // other session. A UDP socket stays open until queued replies are out.
+    const bool datagram = protocol_ == ProtocolType::UDP;
+    for (auto& shard : shards_) {
+        if (shard->listen_fd < 0) continue;
+        shard->reactor.remove(shard->listen_fd);
+        if (!datagram) {
 #ifdef _WIN32
-        closesocket(server_fd_);
+            closesocket(shard->listen_fd);
 #else
-        close(server_fd_);
+            close(shard->listen_fd);
 #endif
-        server_fd_ = -1;
+            shard->listen_fd = -1;
+        }
     }
 
+    // Cancel outside the map lock: a running sweep may be waiting on it
+    TimerWheel::get_instance().cancel(heartbeat_sweep_);
+    heartbeat_sweep_.reset();
+
+    // Shutting a socket down wakes its session, which closes it. Every fd
+    // still in the set is open: sessions unregister before closing. UDP
+    // sessions own no socket; they simply go away below.
     {
         std::lock_guard<std::mutex> lock(client_map_mutex_);
-        for (auto& [fd, ssl] : ssl_clients_) {
-            if (ssl) {
-                SSL_shutdown(ssl);
-                SSL_free(ssl);
-            }
-#ifdef _WIN32
-            closesocket(fd);
-#else
-            close(fd);
-#endif
+        for (int fd : clients_) {
+            shutdown(fd, SHUT_RDWR);
         }
-        ssl_clients_.clear();
-        client_heartbeat_.clear();
     }
 
-    if (accept_thread_.joinable()) {
-        std::cout << "[INFO] Joining accept_thread_..." << std::endl;
-        accept_thread_.join();
-        std::cout << "[INFO] accept_thread_ stopped." << std::endl;
+    {
+        std::unique_lock<std::mutex> lock(session_mutex_);
+        if (!session_cv_.wait_for(lock, kSessionDrainTimeout, [this]() { return outstanding_work_ == 0; })) {
+            std::cerr << "[WARN] " << outstanding_work_ << " client sessions/messages still running." << std::endl;
+        }
     }
-
-    if (heartbeat_thread_.joinable()) {
-        std::cout << "[INFO] Joining heartbeat_thread_..." << std::endl;
-        heartbeat_thread_.join();
-        std::cout << "[INFO] heartbeat_thread_ stopped." << std::endl;
+    for (auto& shard : shards_) {
+        if (shard->uring) {
+            shard->uring->stop();
+            shard->uring.reset();
+        }
+        shard->reactor.stop();
+    }
+    if (datagram && !shards_.empty()) {
+        {
+            std::lock_guard<std::mutex> lock(udp_mutex_);
+            udp_sessions_.clear();
+            udp_session_ids_.clear();
+        }
+        datagram_socket_.reset();
+        Shard& shard = *shards_.front();
+        if (shard.listen_fd >= 0) {
+            close(shard.listen_fd);
+            shard.listen_fd = -1;
+        }
     }
 
     std::cout << "[INFO] NetworkServer stopped completely." << std::endl;
 }
 
 
-    void NetworkServer::initialize_socket() {
-    server_fd_ = socket(AF_INET, SOCK_STREAM, 0);
-    if (server_fd_ < 0) {
-        perror("Failed to create socket");
-        return;
-    }
-
-    sockaddr_in server_addr{};
-    server_addr.sin_family = AF_INET;
-    server_addr.sin_addr.s_addr = INADDR_ANY;
-    server_addr.sin_port = htons(port_);
-
-    int opt = 1;
-#ifdef _WIN32
-    setsockopt(server_fd_, SOL_SOCKET, SO_REUSEADDR, (const char*)&opt, sizeof(opt));
-#else
-    setsockopt(server_fd_, SOL_SOCKET, SO_REUSEADDR | SO_REUSEPORT, &opt, sizeof(opt));
-#endif
-
-    if (bind(server_fd_, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
-        perror("Failed to bind socket");
-        return;
-    }
-
-    listen(server_fd_, 128);
-
-#ifdef _WIN32
-    u_long mode = 1;
-    ioctlsocket(server_fd_, FIONBIO, &mode);
-#else
-    int flags = fcntl(server_fd_, F_GETFL, 0);
-    if (flags < 0) {
-        perror("Failed to get socket flags");
-        return;
-    }
-    if (fcntl(server_fd_, F_SETFL, flags | O_NONBLOCK) < 0) {
-        perror("Failed to set non-blocking mode");
-        return;
+// Opens one listener per shard on the same port. With SO_REUSEPORT each
+// has its own accept queue and the kernel hashes new connections across
+// them, so no loop contends on another's listener.
+void NetworkServer::initialize_socket() {
+    const bool datagram = protocol_ == ProtocolType::UDP;
+    const size_t count = datagram ? 1 : shard_count_;
+    shards_.clear();
+    for (size_t i = 0; i < count; ++i) {
+        int fd = open_listener(port_, datagram);
+        if (fd < 0) {
+            for (auto& shard : shards_) close(shard->listen_fd);
+            shards_.clear();
+            return;
+        }
+        shards_.push_back(std::make_unique<Shard>(*dispatcher_));
+        shards_.back()->listen_fd = fd;
     }
-#endif
 }
 
 
+// Resumption is on from the start: the session cache serves session-id
+// resumption and tickets (keys generated per context) serve the rest, so a
+// reconnecting client skips the full handshake. configure_tls sizes both.
 void NetworkServer::initialize_ssl() {
     SSL_load_error_strings();
     OpenSSL_add_ssl_algorithms();
     ssl_ctx_ = SSL_CTX_new(TLS_server_method());
     if (!ssl_ctx_) {
         std::cerr << "Failed to create SSL context." << std::endl;
+        return;
     }
+    SSL_CTX_set_min_proto_version(ssl_ctx_, TLS1_2_VERSION);
+    SSL_CTX_set_options(ssl_ctx_, SSL_OP_NO_RENEGOTIATION);
+    SSL_CTX_clear_options(ssl_ctx_, SSL_OP_NO_TICKET);
+    SSL_CTX_set_num_tickets(ssl_ctx_, 1); // one reconnect's worth
+    SSL_CTX_set_session_id_context(ssl_ctx_, kTlsSessionContext, sizeof(kTlsSessionContext) - 1);
+    SSL_CTX_set_session_cache_mode(ssl_ctx_, SSL_SESS_CACHE_SERVER);
 }
 
 void NetworkServer::cleanup_ssl() {
@@ -137,100 +262,696 @@ void NetworkServer::cleanup_ssl() {
     }
 }
 
-    void NetworkServer::accept_connections() {
-    std::cout << "[INFO] accept_thread_ starting..." << std::endl;
-    initialize_socket();
+bool NetworkServer::configure_tls(const TlsOptions& options) {
+    if (!ssl_ctx_) {
+        std::cerr << "configure_tls: the server was not created with use_ssl." << std::endl;
+        return false;
+    }
+    if (SSL_CTX_use_certificate_chain_file(ssl_ctx_, options.certificate_file.c_str()) != 1 ||
+        SSL_CTX_use_PrivateKey_file(ssl_ctx_, options.private_key_file.c_str(), SSL_FILETYPE_PEM) != 1 ||
+        SSL_CTX_check_private_key(ssl_ctx_) != 1) {
+        std::cerr << "Failed to load TLS certificate " << options.certificate_file << " / key "
+                  << options.private_key_file << ": " << ERR_error_string(ERR_get_error(), nullptr) << std::endl;
+        return false;
+    }
+
+    SSL_CTX_sess_set_cache_size(ssl_ctx_, static_cast<long>(options.session_cache_size));
+    SSL_CTX_set_timeout(ssl_ctx_, static_cast<long>(options.session_lifetime.count()));
+    if (options.ktls) {
+#ifdef SSL_OP_ENABLE_KTLS
+        SSL_CTX_set_options(ssl_ctx_, SSL_OP_ENABLE_KTLS);
+#else
+        std::cerr << "[WARN] This OpenSSL has no kTLS support; records stay in user space." << std::endl;
+#endif
+    } else {
+#ifdef SSL_OP_ENABLE_KTLS
+        SSL_CTX_clear_options(ssl_ctx_, SSL_OP_ENABLE_KTLS);
+#endif
+    }
+    return true;
+}
+
+TlsStats NetworkServer::tls_stats() const {
+    return TlsStats{tls_handshakes_.load(), tls_resumed_.load(), tls_ktls_.load()};
+}
+
+// Edge-triggered: accept until EAGAIN, then wait for the next edge
+CoTask<void> NetworkServer::accept_connections(Shard& shard) {
+    const int listen_fd = shard.listen_fd;
+    const int accept_flags = SOCK_CLOEXEC | SOCK_NONBLOCK;
 
     while (running_) {
         sockaddr_in client_addr{};
         socklen_t addr_len = sizeof(client_addr);
 
-        int client_fd = accept(server_fd_, (struct sockaddr*)&client_addr, &addr_len);
+        int client_fd = accept4(listen_fd, (struct sockaddr*)&client_addr, &addr_len, accept_flags);
         if (client_fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
             if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                if (!co_await shard.reactor.readable(listen_fd)) break;
+                continue;
+            }
+            if (errno == EMFILE || errno == ENFILE) {
+                std::cerr << "[WARN] Accept: out of file descriptors" << std::endl;
+                co_await sleep_for(kAcceptRetryDelay, TaskLane::NetworkIO);
                 continue;
-            } else {
-                std::cerr << "[ERROR] Accept error: " << strerror(errno) << std::endl;
-                break;
             }
+            std::cerr << "[ERROR] Accept error: " << strerror(errno) << std::endl;
+            break;
+        }
+
+        register_client(client_fd, shard, !use_ssl_);
+        begin_work();
+        if (use_ssl_) {
+            co_spawn(*dispatcher_, tls_session(client_fd, shard), TaskLane::NetworkIO);
+        } else {
+            co_spawn(*dispatcher_, client_session(client_fd, shard), TaskLane::NetworkIO);
         }
+    }
+    end_work();
+}
+
+
 
-        if (!running_) {
-            close(client_fd);
+// The handshake and every read are steps of OpenSSL's non-blocking state
+// machine: WANT_READ / WANT_WRITE park the session on the reactor, so a
+// slow or stalled handshaker holds no worker. A handshake that never
+// finishes is cut off by the heartbeat timeout like any silent client.
+CoTask<void> NetworkServer::tls_session(int client_fd, Shard& shard) {
+    auto tls = std::make_shared<TlsConnection>(SSL_new(ssl_ctx_));
+    set_tls_socket(tls->ssl, client_fd); // SIGPIPE-free writes
+    SSL_set_accept_state(tls->ssl);
+
+    // Nobody else knows the SSL object until the handshake is done
+    bool established = false;
+    while (running_) {
+        int result = SSL_do_handshake(tls->ssl);
+        if (result == 1) {
+            established = true;
             break;
         }
+        int error = SSL_get_error(tls->ssl, result);
+        if (error == SSL_ERROR_WANT_READ && co_await shard.reactor.readable(client_fd)) continue;
+        if (error == SSL_ERROR_WANT_WRITE && co_await shard.reactor.writable(client_fd)) continue;
+        break;
+    }
+    if (!established) {
+        std::cerr << "SSL handshake failed.\n";
+        close_socket(client_fd, shard);
+        end_work();
+        co_return;
+    }
 
+    ++tls_handshakes_;
+    if (SSL_session_reused(tls->ssl)) ++tls_resumed_;
+#ifdef SSL_OP_ENABLE_KTLS
+    if (BIO_get_ktls_send(SSL_get_wbio(tls->ssl))) ++tls_ktls_;
+#endif
+    {
         std::lock_guard<std::mutex> lock(client_map_mutex_);
-        client_heartbeat_[client_fd] = std::chrono::steady_clock::now();
-        dispatcher_->dispatch([this, client_fd]() {
-            handle_client(client_fd);
-        });
+        ssl_clients_[client_fd] = tls;
     }
+    register_client(client_fd, shard, true); // replies wait for the handshake
 
-    std::cout << "[INFO] accept_connections thread exiting..." << std::endl;
+    Strand strand(Dispatcher::get_instance());
+    FrameDecoder decoder;
+    std::vector<Payload> frames;
+    while (running_) {
+        std::span<char> space = decoder.prepare();
+        int bytes;
+        int error = SSL_ERROR_NONE;
+        {
+            std::lock_guard<std::mutex> lock(tls->mutex);
+            bytes = SSL_read(tls->ssl, space.data(), static_cast<int>(space.size()));
+            if (bytes <= 0) error = SSL_get_error(tls->ssl, bytes);
+        }
+        if (error == SSL_ERROR_WANT_READ) {
+            decoder.release();
+            if (!co_await shard.reactor.readable(client_fd)) break;
+            continue;
+        }
+        if (error == SSL_ERROR_WANT_WRITE) {
+            co_await sleep_for(kTlsRetryDelay, TaskLane::NetworkIO);
+            continue;
+        }
+        if (bytes <= 0) break;
+
+        decoder.commit(static_cast<size_t>(bytes));
+        bool intact = decoder.drain(frames);
+        on_frames(client_fd, strand, frames);
+        if (!intact) {
+            std::cerr << "Client " << client_fd << " sent a malformed frame." << std::endl;
+            break;
+        }
+    }
+    close_socket(client_fd, shard);
+    end_work();
 }
 
+// An idle client holds no slab: the decoder lets go of it before waiting
+CoTask<void> NetworkServer::client_session(int client_fd, Shard& shard) {
+    AsyncSocket socket(client_fd, shard.reactor);
+    Strand strand(Dispatcher::get_instance());
+    FrameDecoder decoder;
+    std::vector<Payload> frames;
+    while (running_) {
+        ssize_t bytes = socket.try_read(decoder.prepare());
+        if (bytes == -EAGAIN) {
+            decoder.release();
+            if (!co_await socket.readable()) break;
+            continue;
+        }
+        if (bytes <= 0) break;
+        decoder.commit(static_cast<size_t>(bytes));
+        bool intact = decoder.drain(frames);
+        on_frames(client_fd, strand, frames);
+        if (!intact) {
+            std::cerr << "Client " << client_fd << " sent a malformed frame." << std::endl;
+            break;
+        }
+    }
+    close_socket(client_fd, shard);
+    end_work();
+}
 
+// Every frame from one read goes to the strand as a single task. Heartbeats
+// only store a timestamp, so they are handled right here and skip the
+// strand and its backlog; one refresh covers any number of PONGs in the
+// batch. Leaves frames empty.
+void NetworkServer::on_frames(int client_fd, Strand& strand, std::vector<Payload>& frames) {
+    auto pong = std::remove(frames.begin(), frames.end(), "PONG");
+    if (pong != frames.end()) {
+        frames.erase(pong, frames.end());
+        refresh_heartbeat(client_fd);
+    }
+    if (frames.empty()) return;
+
+    begin_work();
+    strand.post([this, client_fd, batch = std::move(frames)]() {
+        for (const Payload& message : batch) {
+            try {
+                handle_message(client_fd, message);
+            } catch (const std::exception& e) {
+                std::cerr << "Client " << client_fd << " message error: " << e.what() << std::endl;
+            }
+        }
+        end_work();
+    });
+    frames.clear();
+}
 
-void NetworkServer::handle_client(int client_fd) {
-    SSL* ssl = nullptr;
-    if (use_ssl_) {
-        ssl = SSL_new(ssl_ctx_);
-        SSL_set_fd(ssl, client_fd);
-        if (SSL_accept(ssl) <= 0) {
-            std::cerr << "SSL handshake failed.\n";
-            close_socket(client_fd);
-            return;
+void NetworkServer::handle_message(int, const Payload &message) {
+    handle_task(message);
+}
+
+// Drains the socket a batch at a time. Each session gets one strand task
+// and one heartbeat refresh per batch, however many datagrams it sent.
+CoTask<void> NetworkServer::serve_datagrams() {
+    struct Batch {
+        int session;
+        Strand strand;
+        std::vector<Payload> frames;
+    };
+    DatagramSocket& socket = *datagram_socket_;
+    std::vector<Datagram> datagrams;
+    std::vector<Batch> batches;
+    SlabRef slab;
+    size_t slab_used = 0;
+
+    while (running_) {
+        datagrams.clear();
+        int count = socket.receive(datagrams);
+        if (count == -EAGAIN || count == -EWOULDBLOCK) {
+            if (!co_await shards_.front()->reactor.readable(socket.fd())) break;
+            continue;
+        }
+        if (count < 0) {
+            std::cerr << "[ERROR] Datagram receive error: " << strerror(-count) << std::endl;
+            break;
+        }
+
+        batches.clear();
+        {
+            std::lock_guard<std::mutex> lock(udp_mutex_);
+            for (const Datagram& datagram : datagrams) {
+                int session = udp_session(datagram.peer);
+                auto batch = std::find_if(batches.begin(), batches.end(),
+                                          [session](const Batch& b) { return b.session == session; });
+                if (batch == batches.end()) {
+                    batches.push_back(Batch{session, udp_sessions_.at(session).strand, {}});
+                    batch = batches.end() - 1;
+                }
+                batch->frames.push_back(copy_datagram(datagram.data, slab, slab_used));
+            }
+        }
+        for (Batch& batch : batches) {
+            refresh_heartbeat(batch.session);
+            on_frames(batch.session, batch.strand, batch.frames);
+        }
+    }
+    end_work();
+}
+
+int NetworkServer::udp_session(const sockaddr_in& peer) {
+    const uint64_t key = (static_cast<uint64_t>(peer.sin_addr.s_addr) << 16) | peer.sin_port;
+    auto it = udp_session_ids_.find(key);
+    if (it != udp_session_ids_.end()) {
+        // Only while the sweep is expiring it: the datagram keeps it alive
+        if (!heartbeats_->tracked(it->second)) heartbeats_->track(it->second);
+        return it->second;
+    }
+
+    int session = next_udp_session_;
+    if (free_udp_sessions_.empty()) {
+        ++next_udp_session_;
+    } else {
+        session = free_udp_sessions_.front();
+        free_udp_sessions_.pop_front();
+    }
+    udp_session_ids_.emplace(key, session);
+    udp_sessions_.emplace(session, UdpSession{peer, Strand(Dispatcher::get_instance())});
+    heartbeats_->track(session);
+    return session;
+}
+
+// A datagram may have reopened the session since the sweep found it
+// silent; udp_session() tracks it again under the same lock
+void NetworkServer::expire_udp_session(int session_id) {
+    std::lock_guard<std::mutex> lock(udp_mutex_);
+    auto it = udp_sessions_.find(session_id);
+    if (it == udp_sessions_.end() || heartbeats_->tracked(session_id)) return;
+    std::cout << "Client " << session_id << " timed out.\n";
+    const sockaddr_in& peer = it->second.peer;
+    udp_session_ids_.erase((static_cast<uint64_t>(peer.sin_addr.s_addr) << 16) | peer.sin_port);
+    udp_sessions_.erase(it);
+    free_udp_sessions_.push_back(session_id);
+}
+
+// At most one flush runs at a time; replies queued while it sends go out
+// in its next sendmmsg round. A full send buffer keeps the unsent tail
+// and waits on the reactor for room, so replies leave in order; a datagram
+// the kernel refuses outright, or one still held when the server stops,
+// is counted in dropped_datagrams().
+CoTask<void> NetworkServer::flush_datagrams() {
+    std::vector<OutgoingDatagram> outgoing;
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(udp_outbox_mutex_);
+            if (udp_outbox_.empty()) {
+                udp_flush_scheduled_ = false;
+                break;
+            }
+            outgoing.swap(udp_outbox_);
+        }
+        size_t sent = 0;
+        while (sent < outgoing.size()) {
+            int error = 0;
+            sent += datagram_socket_->send(std::span<const OutgoingDatagram>(outgoing).subspan(sent), error);
+            if (sent == outgoing.size()) break;
+            if (error == EAGAIN || error == EWOULDBLOCK) {
+                if (is_running() && co_await shards_.front()->reactor.writable(datagram_socket_->fd())) continue;
+                udp_dropped_.fetch_add(outgoing.size() - sent, std::memory_order_relaxed); // stopping
+                break;
+            }
+            udp_dropped_.fetch_add(1, std::memory_order_relaxed); // e.g. EMSGSIZE: skip it, keep the rest
+            ++sent;
+        }
+        outgoing.clear();
+    }
+    end_work();
+}
+
+size_t NetworkServer::dropped_datagrams() const {
+    return udp_dropped_.load(std::memory_order_relaxed);
+}
+
+void NetworkServer::set_udp_offload(bool enabled) {
+    udp_offload_ = enabled;
+}
+
+bool NetworkServer::is_running() const {
+    return running_;
+}
+
+IoBackend NetworkServer::io_backend() const {
+    return !shards_.empty() && shards_.front()->uring ? IoBackend::IoUring : IoBackend::Epoll;
+}
+
+void NetworkServer::set_listener_shards(size_t count) {
+    shard_count_ = std::max<size_t>(count, 1);
+}
+
+size_t NetworkServer::listener_shards() const {
+    return shards_.size();
+}
+
+void NetworkServer::set_heartbeat(HeartbeatOptions options) {
+    heartbeats_ = std::make_unique<HeartbeatTable>(options);
+}
+
+bool NetworkServer::send_to_client(int client_fd, std::string message, SendPriority priority) {
+    if (protocol_ == ProtocolType::UDP) {
+        OutgoingDatagram datagram{};
+        {
+            std::lock_guard<std::mutex> lock(udp_mutex_);
+            auto it = udp_sessions_.find(client_fd);
+            if (it == udp_sessions_.end()) return false;
+            datagram.peer = it->second.peer;
         }
+        datagram.data = std::move(message);
+        std::vector<OutgoingDatagram> datagrams;
+        datagrams.push_back(std::move(datagram));
+        queue_datagrams(std::move(datagrams));
+        return true;
+    }
 
+    std::shared_ptr<OutboundQueue> queue;
+    Shard* shard = nullptr;
+    std::shared_ptr<TlsConnection> tls;
+    {
         std::lock_guard<std::mutex> lock(client_map_mutex_);
-        ssl_clients_[client_fd] = ssl;
+        auto it = outbound_.find(client_fd);
+        if (it == outbound_.end()) return false;
+        queue = it->second.queue;
+        shard = it->second.shard;
+        auto ssl_it = ssl_clients_.find(client_fd);
+        if (ssl_it != ssl_clients_.end()) tls = ssl_it->second;
     }
 
-    char buffer[1024];
-    while (running_) {
-        int bytes = use_ssl_ ? SSL_read(ssl, buffer, sizeof(buffer)) : recv(client_fd, buffer, sizeof(buffer), 0);
-        if (bytes > 0) {
-            std::string message(buffer, bytes);
-            dispatcher_->dispatch([this, client_fd, message]() {
-                if (message == "PONG") {
-                    std::lock_guard<std::mutex> lock(client_map_mutex_);
-                    client_heartbeat_[client_fd] = std::chrono::steady_clock::now();
-                } else {
-                    handle_task(message);
-                }
-            });
+    OutboundQueue::Push pushed = queue->push(encode_frame(message), priority);
+    return after_push(client_fd, pushed, std::move(queue), std::move(tls), *shard);
+}
+
+bool NetworkServer::after_push(int client_fd, OutboundQueue::Push pushed, std::shared_ptr<OutboundQueue> queue,
+                               std::shared_ptr<TlsConnection> tls, Shard& shard) {
+    switch (pushed) {
+    case OutboundQueue::Push::Queued:
+        return true;
+    case OutboundQueue::Push::Flush:
+        start_flush(client_fd, std::move(queue), std::move(tls), shard);
+        return true;
+    case OutboundQueue::Push::Overflow:
+        // Its session sees the shutdown and closes the connection
+        std::cerr << "[WARN] Client " << client_fd << " fell " << outbound_limits_.max_queued
+                  << " bytes behind, disconnecting." << std::endl;
+        shutdown(client_fd, SHUT_RDWR);
+        return false;
+    case OutboundQueue::Push::Dropped:
+        break;
+    }
+    return false;
+}
+
+size_t NetworkServer::broadcast(std::string message, SendPriority priority) {
+    return fan_out(nullptr, std::move(message), priority);
+}
+
+size_t NetworkServer::broadcast(const std::vector<int>& client_fds, std::string message, SendPriority priority) {
+    return fan_out(&client_fds, std::move(message), priority);
+}
+
+// Only the targets are collected under client_map_mutex_; pushing to the
+// queues and starting their flushes happens on each shard's own task
+size_t NetworkServer::fan_out(const std::vector<int>* client_fds, std::string message, SendPriority priority) {
+    if (protocol_ == ProtocolType::UDP) return fan_out_datagrams(client_fds, std::move(message));
+
+    struct Target {
+        int client_fd;
+        std::shared_ptr<OutboundQueue> queue;
+        std::shared_ptr<TlsConnection> tls;
+    };
+    std::unordered_map<Shard*, std::vector<Target>> targets;
+    size_t count = 0;
+    {
+        std::lock_guard<std::mutex> lock(client_map_mutex_);
+        auto add = [&](int client_fd, const Outbound& outbound) {
+            auto ssl_it = ssl_clients_.find(client_fd);
+            targets[outbound.shard].push_back(
+                Target{client_fd, outbound.queue, ssl_it != ssl_clients_.end() ? ssl_it->second : nullptr});
+            ++count;
+        };
+        if (client_fds) {
+            for (int client_fd : *client_fds) {
+                auto it = outbound_.find(client_fd);
+                if (it != outbound_.end()) add(client_fd, it->second);
+            }
         } else {
-            close_socket(client_fd);
-            break;
+            for (const auto& [client_fd, outbound] : outbound_) add(client_fd, outbound);
         }
     }
+    if (count == 0) return 0;
+
+    const SharedBuffer frame = std::make_shared<const std::string>(encode_frame(message));
+    for (auto& [shard, list] : targets) {
+        begin_work();
+        shard->fan_out.post([this, shard, list = std::move(list), frame, priority]() mutable {
+            for (Target& target : list) {
+                OutboundQueue::Push pushed = target.queue->push(frame, priority);
+                after_push(target.client_fd, pushed, std::move(target.queue), std::move(target.tls), *shard);
+            }
+            end_work();
+        });
+    }
+    return count;
 }
 
-void NetworkServer::monitor_heartbeat() {
-    using namespace std::chrono;
-    while (running_) {
-        std::this_thread::sleep_for(seconds(1));
+// Every session shares one socket, so one batch of datagrams that all
+// point at the same payload goes to the next sendmmsg flush
+size_t NetworkServer::fan_out_datagrams(const std::vector<int>* client_fds, std::string message) {
+    auto payload = std::make_shared<const std::string>(std::move(message));
+    std::vector<OutgoingDatagram> datagrams;
+    {
+        std::lock_guard<std::mutex> lock(udp_mutex_);
+        auto add = [&](const UdpSession& session) {
+            datagrams.push_back(OutgoingDatagram{session.peer, std::string(), payload});
+        };
+        if (client_fds) {
+            for (int session : *client_fds) {
+                auto it = udp_sessions_.find(session);
+                if (it != udp_sessions_.end()) add(it->second);
+            }
+        } else {
+            for (const auto& [session, state] : udp_sessions_) add(state);
+        }
+    }
+    const size_t count = datagrams.size();
+    if (count > 0) queue_datagrams(std::move(datagrams));
+    return count;
+}
 
-        auto now = steady_clock::now();
-        std::lock_guard<std::mutex> lock(client_map_mutex_);
-        for (auto it = client_heartbeat_.begin(); it != client_heartbeat_.end();) {
-            if (duration_cast<seconds>(now - it->second).count() > 10) {
-                std::cout << "Client " << it->first << " timed out.\n";
-                close_socket(it->first);
-                it = client_heartbeat_.erase(it);
-            } else {
-                ++it;
+void NetworkServer::queue_datagrams(std::vector<OutgoingDatagram> datagrams) {
+    {
+        std::lock_guard<std::mutex> lock(udp_outbox_mutex_);
+        if (udp_outbox_.empty()) {
+            udp_outbox_.swap(datagrams);
+        } else {
+            for (OutgoingDatagram& datagram : datagrams) udp_outbox_.push_back(std::move(datagram));
+        }
+        if (udp_flush_scheduled_) return;
+        udp_flush_scheduled_ = true;
+    }
+    begin_work();
+    co_spawn(*dispatcher_, flush_datagrams(), TaskLane::NetworkIO);
+}
+
+void NetworkServer::set_outbound_limits(OutboundLimits limits) {
+    outbound_limits_ = limits;
+}
+
+size_t NetworkServer::outbound_bytes(int client_fd) {
+    std::lock_guard<std::mutex> lock(client_map_mutex_);
+    auto it = outbound_.find(client_fd);
+    return it == outbound_.end() ? 0 : it->second.queue->queued_bytes();
+}
+
+void NetworkServer::register_client(int client_fd, Shard& shard, bool with_outbound) {
+    std::lock_guard<std::mutex> lock(client_map_mutex_);
+    if (clients_.insert(client_fd).second) heartbeats_->track(client_fd);
+    if (with_outbound) outbound_[client_fd] = Outbound{std::make_shared<OutboundQueue>(outbound_limits_), &shard};
+}
+
+// Runs a flush for a queue that push() just made non-empty. Each pass
+// writes everything pending at once; messages queued meanwhile go out in
+// the next pass, so a burst of replies costs a handful of syscalls.
+void NetworkServer::start_flush(int client_fd, std::shared_ptr<OutboundQueue> queue,
+                                std::shared_ptr<TlsConnection> tls, Shard& shard) {
+    begin_work();
+    if (shard.uring) {
+        flush_uring(client_fd, std::move(queue), shard);
+    } else if (tls) {
+        co_spawn(*dispatcher_, flush_tls(client_fd, std::move(tls), std::move(queue), shard), TaskLane::NetworkIO);
+    } else {
+        co_spawn(*dispatcher_, flush_socket(client_fd, std::move(queue), shard), TaskLane::NetworkIO);
+    }
+}
+
+CoTask<void> NetworkServer::flush_socket(int client_fd, std::shared_ptr<OutboundQueue> queue, Shard& shard) {
+    std::vector<iovec> iovecs;
+    auto end = OutboundQueue::FlushEnd::More;
+    while (end == OutboundQueue::FlushEnd::More) {
+        iovecs.clear();
+        if (queue->gather(iovecs, kMaxFlushIovecs) == 0) {
+            end = queue->end_flush();
+            continue;
+        }
+        msghdr message{};
+        message.msg_iov = iovecs.data();
+        message.msg_iovlen = iovecs.size();
+        ssize_t bytes = sendmsg(client_fd, &message, MSG_NOSIGNAL);
+        if (bytes >= 0) {
+            queue->consume(static_cast<size_t>(bytes));
+            continue;
+        }
+        if (errno == EINTR) continue;
+        if ((errno == EAGAIN || errno == EWOULDBLOCK) && co_await shard.reactor.writable(client_fd)) continue;
+        end = queue->end_flush(true); // broken or closing; the session notices on its own
+    }
+    if (end == OutboundQueue::FlushEnd::Release) release_socket(client_fd, nullptr, shard);
+    end_work();
+}
+
+// One TLS record per write. A write that would block waits on the reactor
+// and is retried with the same record, as OpenSSL requires.
+CoTask<void> NetworkServer::flush_tls(int client_fd, std::shared_ptr<TlsConnection> tls,
+                                      std::shared_ptr<OutboundQueue> queue, Shard& shard) {
+    std::string record;
+    auto end = OutboundQueue::FlushEnd::More;
+    while (end == OutboundQueue::FlushEnd::More) {
+        record.clear();
+        if (queue->gather(record, kTlsRecordBytes) == 0) {
+            end = queue->end_flush();
+            continue;
+        }
+        while (true) {
+            int written;
+            int error = SSL_ERROR_NONE;
+            {
+                std::lock_guard<std::mutex> lock(tls->mutex);
+                written = SSL_write(tls->ssl, record.data(), static_cast<int>(record.size()));
+                if (written <= 0) error = SSL_get_error(tls->ssl, written);
+            }
+            if (written > 0) {
+                queue->consume(static_cast<size_t>(written));
+                break;
+            }
+            if (error == SSL_ERROR_WANT_WRITE && co_await shard.reactor.writable(client_fd)) continue;
+            if (error == SSL_ERROR_WANT_READ) {
+                co_await sleep_for(kTlsRetryDelay, TaskLane::NetworkIO);
+                continue;
             }
+            end = queue->end_flush(true); // broken or closing; the session notices on its own
+            break;
         }
     }
+    if (end == OutboundQueue::FlushEnd::Release) release_socket(client_fd, tls, shard);
+    end_work();
+}
 
-    std::cout << "[INFO] heartbeat_thread_ exiting..." << std::endl;
+// One send in flight per client: its completion, on the uring loop
+// thread, sends whatever queued up meanwhile
+void NetworkServer::flush_uring(int client_fd, std::shared_ptr<OutboundQueue> queue, Shard& shard, bool failed) {
+    while (true) {
+        std::string batch;
+        if (!failed && queue->gather(batch, kUringSendBytes) > 0) {
+            shard.uring->send(client_fd, std::move(batch), [this, client_fd, queue, &shard](ssize_t result) {
+                if (result > 0) queue->consume(static_cast<size_t>(result));
+                flush_uring(client_fd, queue, shard, result < 0);
+            });
+            return;
+        }
+        auto end = queue->end_flush(failed);
+        if (end == OutboundQueue::FlushEnd::More) {
+            failed = false;
+            continue;
+        }
+        if (end == OutboundQueue::FlushEnd::Release) release_socket(client_fd, nullptr, shard);
+        end_work();
+        return;
+    }
 }
 
+// The shard's uring loop takes over accepting and reading; each client
+// keeps the same strand, heartbeat and work accounting as an epoll session.
+// TLS always stays on the epoll path: OpenSSL does its own reads and
+// writes on the socket and asks to be called again on WANT_READ/WANT_WRITE,
+// which needs readiness, while the ring completes reads into buffers it
+// owns. Driving it from the ring would take a memory BIO in between.
+bool NetworkServer::start_uring(Shard& shard) {
+    if (backend_ != IoBackend::IoUring || use_ssl_) return false;
+
+    UringBackend::Callbacks callbacks;
+    callbacks.on_accept = [this, &shard](int client_fd) {
+        register_client(client_fd, shard, true);
+        begin_work();
+        shard.uring_sessions.emplace(client_fd, UringSession{Strand(Dispatcher::get_instance()), FrameDecoder()});
+    };
+    // The kernel's buffer goes back as soon as this returns, so the data is
+    // copied into the session's slab; the frames then share that slab
+    callbacks.on_data = [this, &shard, frames = std::vector<Payload>()](int client_fd, std::string_view data) mutable {
+        auto it = shard.uring_sessions.find(client_fd);
+        if (it == shard.uring_sessions.end()) return;
+        FrameDecoder& decoder = it->second.decoder;
+        decoder.feed(data);
+        if (!decoder.drain(frames)) {
+            std::cerr << "Client " << client_fd << " sent a malformed frame." << std::endl;
+            shutdown(client_fd, SHUT_RDWR); // the recv ends and on_close cleans up
+        }
+        decoder.release(); // like the kernel's buffers, idle clients hold no slab
+        on_frames(client_fd, it->second.strand, frames);
+    };
+    callbacks.on_close = [this, &shard](int client_fd) {
+        shard.uring_sessions.erase(client_fd);
+        close_socket(client_fd, shard);
+        end_work();
+    };
+
+    shard.uring = std::make_unique<UringBackend>(std::move(callbacks));
+    if (!shard.uring->start(shard.listen_fd)) {
+        std::cerr << "[WARN] io_uring unavailable, falling back to epoll." << std::endl;
+        shard.uring.reset();
+        return false;
+    }
+    return true;
+}
+
+void NetworkServer::refresh_heartbeat(int client_fd) {
+    heartbeats_->touch(client_fd);
+}
+
+void NetworkServer::sweep_heartbeats() {
+    std::vector<int> expired;
+    heartbeats_->expire(expired);
+    for (int client_fd : expired) on_heartbeat_timeout(client_fd);
+}
+
+void NetworkServer::begin_work() {
+    std::lock_guard<std::mutex> lock(session_mutex_);
+    ++outstanding_work_;
+}
+
+// Notifies under the lock: once stop() sees zero it may destroy the server
+void NetworkServer::end_work() {
+    std::lock_guard<std::mutex> lock(session_mutex_);
+    --outstanding_work_;
+    session_cv_.notify_all();
+}
+
+// Wakes the client's session, which closes the socket itself. Checked
+// under the map lock: if the fd closed and went to a new client since the
+// sweep, register_client has tracked it again and it is left alone.
+void NetworkServer::on_heartbeat_timeout(int client_fd) {
+    if (protocol_ == ProtocolType::UDP) {
+        expire_udp_session(client_fd);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(client_map_mutex_);
+    if (!clients_.count(client_fd) || heartbeats_->tracked(client_fd)) return;
+    std::cout << "Client " << client_fd << " timed out.\n";
+    shutdown(client_fd, SHUT_RDWR);
+}
 
-void NetworkServer::handle_task(const std::string &message) {
+
+void NetworkServer::handle_task(const Payload &message) {
     if (message == "shutdown") {
         running_ = false;
         std::cout << "[INFO] Server is shutting down..." << std::endl;
@@ -240,16 +961,50 @@ void NetworkServer::handle_task(const std::string &message) {
     std::cout << "Message processed: " << message << std::endl;
 }
 
-void NetworkServer::close_socket(int fd) {
+// Bookkeeping is dropped before the fd is closed so a reused fd number
+// never inherits this client's heartbeat or TLS state
+void NetworkServer::close_socket(int fd, Shard& shard) {
+    shard.reactor.remove(fd);
+
+    std::shared_ptr<TlsConnection> tls;
+    std::shared_ptr<OutboundQueue> queue;
+    {
+        std::lock_guard<std::mutex> lock(client_map_mutex_);
+        auto ssl_it = ssl_clients_.find(fd);
+        if (ssl_it != ssl_clients_.end()) {
+            tls = std::move(ssl_it->second);
+            ssl_clients_.erase(ssl_it);
+        }
+        if (clients_.erase(fd)) heartbeats_->forget(fd);
+        auto queue_it = outbound_.find(fd);
+        if (queue_it != outbound_.end()) {
+            queue = std::move(queue_it->second.queue);
+            outbound_.erase(queue_it);
+        }
+    }
+
+    // A flush still writing keeps the socket; the shutdown makes it fail
+    // fast, and it releases the socket when it ends
+    if (queue && !queue->close()) {
+        shutdown(fd, SHUT_RDWR);
+        return;
+    }
+    release_socket(fd, tls, shard);
+}
+
+// Sends close_notify if the socket takes it right away; the SSL object
+// goes with the last reference to its connection
+void NetworkServer::release_socket(int fd, const std::shared_ptr<TlsConnection>& tls, Shard& shard) {
+    shard.reactor.remove(fd);
+    if (tls) {
+        std::lock_guard<std::mutex> lock(tls->mutex);
+        SSL_shutdown(tls->ssl);
+    }
 #ifdef _WIN32
     closesocket(fd);
 #else
     close(fd);
 #endif
-
-    std::lock_guard<std::mutex> lock(client_map_mutex_);
-    ssl_clients_.erase(fd);
-    client_heartbeat_.erase(fd);
 }
 
 } // namespace CMQ
@@ -0,0 +1,113 @@
+// src/network/OutboundQueue.cpp
+#include "network/OutboundQueue.hpp"
+#include <algorithm>
+
+namespace CMQ {
+
+OutboundQueue::OutboundQueue(OutboundLimits limits) : limits_(limits) {}
+
+OutboundQueue::Push OutboundQueue::push(std::string message, SendPriority priority) {
+    return push_entry(Entry{std::move(message), nullptr}, priority);
+}
+
+// Limits count the shared bytes in full: they are what this connection
+// still has to write
+OutboundQueue::Push OutboundQueue::push(SharedBuffer message, SendPriority priority) {
+    return push_entry(Entry{std::string(), std::move(message)}, priority);
+}
+
+OutboundQueue::Push OutboundQueue::push_entry(Entry entry, SendPriority priority) {
+    const size_t size = entry.view().size();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closed_) return Push::Dropped;
+    if (congested_ && priority == SendPriority::Low) return Push::Dropped;
+    if (queued_bytes_ + size > limits_.max_queued) return Push::Overflow;
+
+    queued_bytes_ += size;
+    if (queued_bytes_ > limits_.high_watermark) congested_ = true;
+    messages_.push_back(std::move(entry));
+    if (flushing_) return Push::Queued;
+    flushing_ = true;
+    return Push::Flush;
+}
+
+size_t OutboundQueue::gather(std::vector<iovec>& out, size_t max_iovecs) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closed_) return 0;
+    size_t bytes = 0;
+    size_t offset = head_offset_;
+    for (auto it = messages_.begin(); it != messages_.end() && out.size() < max_iovecs; ++it) {
+        std::string_view message = it->view();
+        out.push_back(iovec{const_cast<char*>(message.data()) + offset, message.size() - offset});
+        bytes += message.size() - offset;
+        offset = 0;
+    }
+    return bytes;
+}
+
+size_t OutboundQueue::gather(std::string& out, size_t max_bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closed_) return 0;
+    size_t offset = head_offset_;
+    for (auto it = messages_.begin(); it != messages_.end() && out.size() < max_bytes; ++it) {
+        std::string_view message = it->view();
+        size_t take = std::min(message.size() - offset, max_bytes - out.size());
+        out.append(message.substr(offset, take));
+        offset = 0;
+    }
+    return out.size();
+}
+
+void OutboundQueue::consume(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    bytes = std::min(bytes, queued_bytes_);
+    queued_bytes_ -= bytes;
+    while (bytes > 0 && !messages_.empty()) {
+        size_t left = messages_.front().view().size() - head_offset_;
+        if (bytes < left) {
+            head_offset_ += bytes;
+            break;
+        }
+        bytes -= left;
+        head_offset_ = 0;
+        messages_.pop_front();
+    }
+    if (congested_ && queued_bytes_ < limits_.low_watermark) congested_ = false;
+}
+
+OutboundQueue::FlushEnd OutboundQueue::end_flush(bool failed) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (failed || closed_) clear();
+    if (!closed_ && !messages_.empty()) return FlushEnd::More;
+    flushing_ = false;
+    return closed_ ? FlushEnd::Release : FlushEnd::Idle;
+}
+
+bool OutboundQueue::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+    if (flushing_) return false;
+    clear();
+    return true;
+}
+
+size_t OutboundQueue::queued_bytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queued_bytes_;
+}
+
+bool OutboundQueue::congested() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return congested_;
+}
+
+// The flusher may still hold views into messages_, so a running flush
+// only clears the queue from end_flush
+void OutboundQueue::clear() {
+    messages_.clear();
+    head_offset_ = 0;
+    queued_bytes_ = 0;
+    congested_ = false;
+}
+
+}
@@ -0,0 +1,190 @@
+// src/network/Reactor.cpp
+#include "network/Reactor.hpp"
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace CMQ {
+
+namespace {
+    constexpr int kMaxEvents = 256;
+}
+
+bool Reactor::IoAwaitable::await_suspend(std::coroutine_handle<> handle) {
+    handle_ = handle;
+    // Not parked (reactor stopped, bad fd): continue at once with ready_ == false
+    return reactor_.watch(this);
+}
+
+Reactor::Reactor() : Reactor(nullptr) {}
+
+Reactor::Reactor(Dispatcher& dispatcher) : Reactor(&dispatcher) {}
+
+Reactor::Reactor(Dispatcher* dispatcher)
+    : dispatcher_(dispatcher), epoll_fd_(epoll_create1(EPOLL_CLOEXEC)),
+      wake_fd_(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)), running_(false) {
+    if (epoll_fd_ < 0 || wake_fd_ < 0) {
+        std::cerr << "Reactor: failed to create epoll/eventfd: " << strerror(errno) << std::endl;
+        return;
+    }
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = wake_fd_;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &event);
+}
+
+Reactor::~Reactor() {
+    stop();
+    if (wake_fd_ >= 0) close(wake_fd_);
+    if (epoll_fd_ >= 0) close(epoll_fd_);
+}
+
+void Reactor::start() {
+    if (running_ || epoll_fd_ < 0) return;
+    running_ = true;
+    thread_ = std::thread(&Reactor::run, this);
+}
+
+void Reactor::stop() {
+    if (!running_.exchange(false)) return;
+
+    uint64_t one = 1;
+    [[maybe_unused]] ssize_t written = write(wake_fd_, &one, sizeof(one));
+    if (thread_.joinable()) thread_.join();
+
+    std::vector<IoAwaitable*> cancelled;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& [fd, watch] : watches_) {
+            epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+            if (watch.reader) cancelled.push_back(watch.reader);
+            if (watch.writer) cancelled.push_back(watch.writer);
+        }
+        watches_.clear();
+    }
+    for (IoAwaitable* waiter : cancelled) resume(waiter, false);
+}
+
+bool Reactor::is_running() const {
+    return running_;
+}
+
+Reactor::IoAwaitable Reactor::readable(int fd) {
+    return IoAwaitable(*this, fd, EPOLLIN);
+}
+
+Reactor::IoAwaitable Reactor::writable(int fd) {
+    return IoAwaitable(*this, fd, EPOLLOUT);
+}
+
+void Reactor::remove(int fd) {
+    std::vector<IoAwaitable*> cancelled;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = watches_.find(fd);
+        if (it == watches_.end()) return;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+        if (it->second.reader) cancelled.push_back(it->second.reader);
+        if (it->second.writer) cancelled.push_back(it->second.writer);
+        watches_.erase(it);
+    }
+    for (IoAwaitable* waiter : cancelled) resume(waiter, false);
+}
+
+// The first wait on a fd registers it for both directions, edge-triggered;
+// after that parking a waiter costs no syscall
+bool Reactor::watch(IoAwaitable* waiter) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!running_) return false;
+
+    const int fd = waiter->fd_;
+    auto it = watches_.find(fd);
+    if (it == watches_.end()) {
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        event.data.fd = fd;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) < 0) {
+            std::cerr << "Reactor: epoll_ctl failed for fd " << fd << ": " << strerror(errno) << std::endl;
+            return false;
+        }
+        it = watches_.emplace(fd, Watch{}).first;
+    }
+
+    Watch& watch = it->second;
+    const bool reading = waiter->events_ & EPOLLIN;
+    IoAwaitable*& slot = reading ? watch.reader : watch.writer;
+    bool& pending = reading ? watch.readable : watch.writable;
+    if (slot) return false; // one waiter per direction
+
+    // An edge since the caller's EAGAIN: retry at once instead of parking
+    if (pending) {
+        pending = false;
+        waiter->ready_ = true;
+        return false;
+    }
+    slot = waiter;
+    return true;
+}
+
+void Reactor::resume(IoAwaitable* waiter, bool ready) {
+    waiter->ready_ = ready;
+    std::coroutine_handle<> handle = waiter->handle_;
+    // A pool that stops before taking it leaves the resume to this thread
+    if (!dispatcher_ || !dispatcher_->is_running() ||
+        !dispatcher_->dispatch([handle]() { handle.resume(); }, TaskLane::NetworkIO)) {
+        handle.resume();
+    }
+}
+
+void Reactor::run() {
+    epoll_event events[kMaxEvents];
+    std::vector<IoAwaitable*> ready;
+
+    while (running_) {
+        int count = epoll_wait(epoll_fd_, events, kMaxEvents, -1);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "Reactor: epoll_wait failed: " << strerror(errno) << std::endl;
+            break;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (int i = 0; i < count; ++i) {
+                int fd = events[i].data.fd;
+                if (fd == wake_fd_) continue;
+
+                auto it = watches_.find(fd);
+                if (it == watches_.end()) continue;
+                Watch& watch = it->second;
+
+                // Errors and hangups wake both directions; the retried syscall reports them
+                uint32_t fired = events[i].events;
+                bool broken = fired & (EPOLLERR | EPOLLHUP | EPOLLRDHUP);
+                if (broken || (fired & EPOLLIN)) {
+                    if (watch.reader) {
+                        ready.push_back(std::exchange(watch.reader, nullptr));
+                    } else {
+                        watch.readable = true;
+                    }
+                }
+                if (broken || (fired & EPOLLOUT)) {
+                    if (watch.writer) {
+                        ready.push_back(std::exchange(watch.writer, nullptr));
+                    } else {
+                        watch.writable = true;
+                    }
+                }
+            }
+        }
+
+        for (IoAwaitable* waiter : ready) resume(waiter, true);
+        ready.clear();
+    }
+}
+
+}
@@ -0,0 +1,79 @@
+// src/network/TlsSocket.cpp
+#include "network/TlsSocket.hpp"
+#include <openssl/bio.h>
+#include <cerrno>
+#include <csignal>
+#include <ctime>
+#include <pthread.h>
+#include <sys/socket.h>
+
+namespace CMQ {
+
+namespace {
+    using BioWrite = int (*)(BIO*, const char*, int);
+
+    BioWrite socket_write = nullptr; // BIO_s_socket's own, for kTLS sockets
+
+    // A SIGPIPE raised while it is blocked stays pending; consume it unless
+    // it was already pending before the write
+    int write_without_sigpipe(BIO* bio, const char* data, int size) {
+        sigset_t pipe_set;
+        sigset_t previous;
+        sigemptyset(&pipe_set);
+        sigaddset(&pipe_set, SIGPIPE);
+        pthread_sigmask(SIG_BLOCK, &pipe_set, &previous);
+        sigset_t pending;
+        sigpending(&pending);
+        const bool was_pending = sigismember(&pending, SIGPIPE);
+
+        int written = socket_write(bio, data, size);
+        if (written < 0 && errno == EPIPE && !was_pending) {
+            const int error = errno;
+            timespec now{};
+            while (sigtimedwait(&pipe_set, nullptr, &now) < 0 && errno == EINTR) {}
+            errno = error;
+        }
+        pthread_sigmask(SIG_SETMASK, &previous, nullptr);
+        return written;
+    }
+
+    int write_nosignal(BIO* bio, const char* data, int size) {
+        if (BIO_get_ktls_send(bio)) return write_without_sigpipe(bio, data, size);
+
+        int fd = -1;
+        BIO_get_fd(bio, &fd);
+        ssize_t written = send(fd, data, static_cast<size_t>(size), MSG_NOSIGNAL);
+        BIO_clear_retry_flags(bio);
+        if (written <= 0 && BIO_sock_should_retry(static_cast<int>(written))) BIO_set_retry_write(bio);
+        return static_cast<int>(written);
+    }
+
+    // BIO_s_socket with the write swapped; the same type, so OpenSSL still
+    // recognises it for SSL_get_fd and kTLS
+    BIO_METHOD* make_method() {
+        const BIO_METHOD* base = BIO_s_socket();
+        socket_write = BIO_meth_get_write(base);
+        BIO_METHOD* method = BIO_meth_new(BIO_TYPE_SOCKET, "CMQ socket");
+        if (!method) return nullptr;
+        BIO_meth_set_write(method, &write_nosignal);
+        BIO_meth_set_read(method, BIO_meth_get_read(base));
+        BIO_meth_set_puts(method, BIO_meth_get_puts(base));
+        BIO_meth_set_gets(method, BIO_meth_get_gets(base));
+        BIO_meth_set_ctrl(method, BIO_meth_get_ctrl(base));
+        BIO_meth_set_create(method, BIO_meth_get_create(base));
+        BIO_meth_set_destroy(method, BIO_meth_get_destroy(base));
+        return method;
+    }
+}
+
+bool set_tls_socket(SSL* ssl, int fd) {
+    static BIO_METHOD* const method = make_method();
+    if (!method) return false;
+    BIO* bio = BIO_new(method);
+    if (!bio) return false;
+    BIO_set_fd(bio, fd, BIO_NOCLOSE);
+    SSL_set_bio(ssl, bio, bio);
+    return true;
+}
+
+}
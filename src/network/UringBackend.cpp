@@ -0,0 +1,494 @@
+// src/network/UringBackend.cpp
+#include "network/UringBackend.hpp"
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+namespace CMQ {
+
+namespace {
+    constexpr unsigned kSubmissionEntries = 1024;
+    constexpr unsigned kCompletionEntries = 8192; // one multishot recv per client can post at any time
+    // Provided receive buffers, a power of two. Each goes back to the
+    // kernel as soon as on_data returns, so idle clients hold none.
+    constexpr unsigned kBufferCount = 1024;
+    constexpr unsigned kBufferSize = 2048;
+    constexpr uint16_t kBufferGroup = 0;
+
+    // Same back-off as the epoll accept loop when descriptors run out
+    constexpr long long kAcceptRetryNanoseconds = 100'000'000;
+
+    // user_data carries the operation in its low 3 bits and the fd (or, for
+    // sends, the 8-byte aligned SendOp pointer) above them
+    enum Op : uint64_t { OpAccept = 1, OpRecv = 2, OpSend = 3, OpWake = 4, OpAcceptRetry = 5, OpCancel = 6 };
+    constexpr uint64_t kOpMask = 7;
+
+    uint64_t fd_data(Op op, int fd) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(fd)) << 3) | op;
+    }
+
+    int io_uring_setup(unsigned entries, io_uring_params* params) {
+        return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+    }
+
+    int io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+        return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+    }
+
+    int io_uring_register(int fd, unsigned opcode, void* arg, unsigned count) {
+        return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, count));
+    }
+
+    template<typename T>
+    T load_acquire(T* value) {
+        return std::atomic_ref<T>(*value).load(std::memory_order_acquire);
+    }
+
+    template<typename T>
+    void store_release(T* value, T next) {
+        std::atomic_ref<T>(*value).store(next, std::memory_order_release);
+    }
+}
+
+// The mmapped submission/completion queues and the provided-buffer ring
+struct UringBackend::Ring {
+    int fd = -1;
+
+    void* sq_map = nullptr;
+    size_t sq_map_size = 0;
+    void* cq_map = nullptr;
+    size_t cq_map_size = 0;
+    io_uring_sqe* sqes = nullptr;
+    size_t sqes_size = 0;
+
+    unsigned* sq_head = nullptr;
+    unsigned* sq_tail = nullptr;
+    unsigned sq_mask = 0;
+    unsigned sq_entries = 0;
+    unsigned sqe_tail = 0; // local tail, published by submit()
+    unsigned* cq_head = nullptr;
+    unsigned* cq_tail = nullptr;
+    unsigned cq_mask = 0;
+    io_uring_cqe* cqes = nullptr;
+
+    io_uring_buf_ring* buffers = nullptr;
+    size_t buffers_size = 0;
+    std::unique_ptr<char[]> buffer_memory;
+    uint16_t buffer_tail = 0;
+
+    uint64_t wake_value = 0;
+    __kernel_timespec retry_delay{0, kAcceptRetryNanoseconds};
+
+    // SINGLE_ISSUER and DEFER_TASKRUN (6.1) double as the feature probe:
+    // every kernel accepting them also has multishot recv and buffer rings
+    bool open() {
+        io_uring_params params{};
+        params.flags = IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN | IORING_SETUP_CQSIZE;
+        params.cq_entries = kCompletionEntries;
+        fd = io_uring_setup(kSubmissionEntries, &params);
+        if (fd < 0) return false;
+
+        sq_map_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_map_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        if (params.features & IORING_FEAT_SINGLE_MMAP) {
+            sq_map_size = cq_map_size = std::max(sq_map_size, cq_map_size);
+        }
+        sq_map = mmap(nullptr, sq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        if (sq_map == MAP_FAILED) return false;
+        if (params.features & IORING_FEAT_SINGLE_MMAP) {
+            cq_map = sq_map;
+        } else {
+            cq_map = mmap(nullptr, cq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+            if (cq_map == MAP_FAILED) return false;
+        }
+        sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqe_map = mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+        if (sqe_map == MAP_FAILED) return false;
+        sqes = static_cast<io_uring_sqe*>(sqe_map);
+
+        auto* sq = static_cast<char*>(sq_map);
+        auto* cq = static_cast<char*>(cq_map);
+        sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_entries = params.sq_entries;
+        sqe_tail = *sq_tail;
+        cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+        // The SQ index array maps slot i to sqe i for good
+        auto* array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        for (unsigned i = 0; i < sq_entries; ++i) array[i] = i;
+
+        return open_buffers();
+    }
+
+    // The buffer ring is filled before it is registered, so it starts full
+    bool open_buffers() {
+        buffer_memory = std::make_unique<char[]>(static_cast<size_t>(kBufferCount) * kBufferSize);
+
+        buffers_size = kBufferCount * sizeof(io_uring_buf);
+        void* ring = mmap(nullptr, buffers_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (ring == MAP_FAILED) return false;
+        buffers = static_cast<io_uring_buf_ring*>(ring);
+        for (unsigned bid = 0; bid < kBufferCount; ++bid) provide(static_cast<uint16_t>(bid));
+
+        io_uring_buf_reg reg{};
+        reg.ring_addr = reinterpret_cast<uint64_t>(buffers);
+        reg.ring_entries = kBufferCount;
+        reg.bgid = kBufferGroup;
+        return io_uring_register(fd, IORING_REGISTER_PBUF_RING, &reg, 1) == 0;
+    }
+
+    void close() {
+        if (fd >= 0) ::close(fd); // unregisters the buffer ring too
+        if (buffers) munmap(buffers, buffers_size);
+        if (sqes) munmap(sqes, sqes_size);
+        if (cq_map && cq_map != MAP_FAILED && cq_map != sq_map) munmap(cq_map, cq_map_size);
+        if (sq_map && sq_map != MAP_FAILED) munmap(sq_map, sq_map_size);
+        fd = -1;
+        buffers = nullptr;
+        sqes = nullptr;
+        sq_map = cq_map = nullptr;
+    }
+
+    char* buffer(uint16_t bid) {
+        return buffer_memory.get() + static_cast<size_t>(bid) * kBufferSize;
+    }
+
+    // Hands buffer bid back to the kernel. The ring is indexed as a plain
+    // io_uring_buf array: in C++ the uapi bufs[] wrapper is padded and
+    // would shift every entry by 8 bytes. tail overlays entry 0's resv.
+    void provide(uint16_t bid) {
+        io_uring_buf& entry = reinterpret_cast<io_uring_buf*>(buffers)[buffer_tail & (kBufferCount - 1)];
+        entry.addr = reinterpret_cast<uint64_t>(buffer(bid));
+        entry.len = kBufferSize;
+        entry.bid = bid;
+        store_release(&buffers->tail, ++buffer_tail);
+    }
+
+    // Flushes queued SQEs first if the submission queue is full
+    io_uring_sqe* get_sqe() {
+        if (sqe_tail - load_acquire(sq_head) >= sq_entries) submit(0);
+        io_uring_sqe* sqe = &sqes[sqe_tail & sq_mask];
+        std::memset(sqe, 0, sizeof(*sqe));
+        ++sqe_tail;
+        return sqe;
+    }
+
+    // One syscall submits everything queued since the last call and, with
+    // wait_for > 0, blocks for completions
+    int submit(unsigned wait_for) {
+        unsigned pending = sqe_tail - *sq_tail;
+        store_release(sq_tail, sqe_tail);
+        return io_uring_enter(fd, pending, wait_for, IORING_ENTER_GETEVENTS);
+    }
+};
+
+UringBackend::UringBackend(Callbacks callbacks)
+    : callbacks_(std::move(callbacks)), listen_fd_(-1), wake_fd_(-1), inflight_(0),
+      running_(false), stopping_(false) {}
+
+UringBackend::~UringBackend() {
+    stop();
+}
+
+bool UringBackend::start(int listen_fd) {
+    if (running_) return true;
+    wake_fd_ = eventfd(0, EFD_CLOEXEC);
+    if (wake_fd_ < 0) return false;
+
+    stopping_ = false;
+    std::promise<bool> ready;
+    std::future<bool> started = ready.get_future();
+    thread_ = std::thread(&UringBackend::run, this, listen_fd, std::move(ready));
+    if (!started.get()) {
+        thread_.join();
+        close(wake_fd_);
+        wake_fd_ = -1;
+        return false;
+    }
+    running_ = true;
+    return true;
+}
+
+void UringBackend::stop() {
+    if (!running_.exchange(false)) return;
+    stopping_ = true;
+    uint64_t one = 1;
+    [[maybe_unused]] ssize_t written = write(wake_fd_, &one, sizeof(one));
+    if (thread_.joinable()) thread_.join();
+    close(wake_fd_);
+    wake_fd_ = -1;
+}
+
+bool UringBackend::is_running() const {
+    return running_;
+}
+
+void UringBackend::send(int fd, std::string data, SendDone done) {
+    if (data.empty()) {
+        if (done) done(0);
+        return;
+    }
+    bool wake;
+    {
+        std::lock_guard<std::mutex> lock(send_mutex_);
+        wake = pending_sends_.empty();
+        pending_sends_.push_back(new SendOp{fd, std::move(data), std::move(done)});
+    }
+    // One wakeup per batch; the loop picks up everything queued meanwhile
+    if (wake && std::this_thread::get_id() != thread_.get_id()) {
+        uint64_t one = 1;
+        [[maybe_unused]] ssize_t written = write(wake_fd_, &one, sizeof(one));
+    }
+}
+
+void UringBackend::run(int listen_fd, std::promise<bool> ready) {
+    ring_ = std::make_unique<Ring>();
+    if (!ring_->open()) {
+        ring_->close();
+        ring_.reset();
+        ready.set_value(false);
+        return;
+    }
+    listen_fd_ = listen_fd;
+    inflight_ = 0;
+    arm_accept();
+    arm_wake();
+    ready.set_value(true);
+
+    while (!stopping_) {
+        flush_sends();
+        if (ring_->submit(1) < 0 && errno != EINTR) {
+            std::cerr << "UringBackend: io_uring_enter failed: " << strerror(errno) << std::endl;
+            break;
+        }
+        reap();
+    }
+
+    cancel_all();
+    ring_->close();
+    ring_.reset();
+
+    std::vector<SendOp*> unsent;
+    {
+        std::lock_guard<std::mutex> lock(send_mutex_);
+        unsent.swap(pending_sends_);
+    }
+    for (SendOp* op : unsent) finish(op, -ECANCELED);
+}
+
+void UringBackend::arm_accept() {
+    io_uring_sqe* sqe = ring_->get_sqe();
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = listen_fd_;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_CLOEXEC;
+    sqe->user_data = fd_data(OpAccept, listen_fd_);
+    ++inflight_;
+}
+
+void UringBackend::arm_recv(int fd) {
+    io_uring_sqe* sqe = ring_->get_sqe();
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = fd;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = kBufferGroup;
+    sqe->user_data = fd_data(OpRecv, fd);
+    ++inflight_;
+}
+
+void UringBackend::arm_wake() {
+    io_uring_sqe* sqe = ring_->get_sqe();
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = wake_fd_;
+    sqe->addr = reinterpret_cast<uint64_t>(&ring_->wake_value);
+    sqe->len = sizeof(ring_->wake_value);
+    sqe->user_data = fd_data(OpWake, wake_fd_);
+    ++inflight_;
+}
+
+void UringBackend::arm_accept_retry() {
+    io_uring_sqe* sqe = ring_->get_sqe();
+    sqe->opcode = IORING_OP_TIMEOUT;
+    sqe->addr = reinterpret_cast<uint64_t>(&ring_->retry_delay);
+    sqe->len = 1;
+    sqe->user_data = fd_data(OpAcceptRetry, listen_fd_);
+    ++inflight_;
+}
+
+void UringBackend::submit_send(SendOp* op) {
+    io_uring_sqe* sqe = ring_->get_sqe();
+    sqe->opcode = IORING_OP_SEND;
+    sqe->fd = op->fd;
+    sqe->addr = reinterpret_cast<uint64_t>(op->data.data() + op->offset);
+    sqe->len = static_cast<uint32_t>(op->data.size() - op->offset);
+    sqe->msg_flags = MSG_NOSIGNAL;
+    sqe->user_data = reinterpret_cast<uint64_t>(op) | OpSend;
+    ++inflight_;
+}
+
+// Moves sends queued by other threads into the per-client queues; a client
+// with nothing in flight gets its first send into this batch
+void UringBackend::flush_sends() {
+    std::vector<SendOp*> batch;
+    {
+        std::lock_guard<std::mutex> lock(send_mutex_);
+        batch.swap(pending_sends_);
+    }
+    for (SendOp* op : batch) {
+        std::deque<SendOp*>& queue = send_queues_[op->fd];
+        queue.push_back(op);
+        if (queue.size() == 1) submit_send(op);
+    }
+}
+
+// Everything but an in-flight front is discarded; the front is freed by its completion
+void UringBackend::drop_sends(int fd) {
+    auto it = send_queues_.find(fd);
+    if (it == send_queues_.end()) return;
+    std::deque<SendOp*>& queue = it->second;
+    while (queue.size() > 1) {
+        finish(queue.back(), -ECANCELED);
+        queue.pop_back();
+    }
+}
+
+void UringBackend::finish(SendOp* op, ssize_t result) {
+    if (op->done) op->done(result);
+    delete op;
+}
+
+void UringBackend::reap() {
+    unsigned head = *ring_->cq_head;
+    unsigned tail = load_acquire(ring_->cq_tail);
+    while (head != tail) {
+        const io_uring_cqe& cqe = ring_->cqes[head & ring_->cq_mask];
+        uint64_t user_data = cqe.user_data;
+        int result = cqe.res;
+        uint32_t flags = cqe.flags;
+        store_release(ring_->cq_head, ++head);
+
+        complete(user_data, result, flags);
+        if (head == tail) tail = load_acquire(ring_->cq_tail);
+    }
+}
+
+void UringBackend::complete(uint64_t user_data, int result, uint32_t flags) {
+    const bool more = flags & IORING_CQE_F_MORE;
+    const int fd = static_cast<int>(user_data >> 3);
+
+    switch (user_data & kOpMask) {
+    case OpAccept:
+        if (!more) --inflight_;
+        if (result >= 0) {
+            if (stopping_) {
+                close(result);
+            } else {
+                callbacks_.on_accept(result);
+                arm_recv(result);
+            }
+        } else if (result != -ECANCELED) {
+            std::cerr << "UringBackend: accept failed: " << strerror(-result) << std::endl;
+        }
+        if (!more && !stopping_) {
+            if (result == -EMFILE || result == -ENFILE) {
+                arm_accept_retry();
+            } else {
+                arm_accept();
+            }
+        }
+        break;
+
+    case OpRecv:
+        if (result > 0) {
+            auto bid = static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+            callbacks_.on_data(fd, std::string_view(ring_->buffer(bid), static_cast<size_t>(result)));
+            ring_->provide(bid);
+        }
+        if (!more) {
+            --inflight_;
+            // Out of buffers (or a multishot the kernel ended early) is not the client's fault
+            if (!stopping_ && (result > 0 || result == -ENOBUFS)) {
+                arm_recv(fd);
+            } else {
+                drop_sends(fd);
+                callbacks_.on_close(fd);
+            }
+        }
+        break;
+
+    case OpSend: {
+        --inflight_;
+        auto* op = reinterpret_cast<SendOp*>(user_data & ~kOpMask);
+        if (result > 0 && op->offset + static_cast<size_t>(result) < op->data.size() && !stopping_) {
+            op->offset += static_cast<size_t>(result);
+            submit_send(op); // short send: the rest goes next, still ahead of later sends
+            break;
+        }
+
+        std::deque<SendOp*>& queue = send_queues_[op->fd];
+        queue.pop_front();
+        std::deque<SendOp*> dropped;
+        if (result < 0) dropped.swap(queue); // the connection is broken; its recv reports the close
+        if (queue.empty()) {
+            send_queues_.erase(op->fd);
+        } else if (!stopping_) {
+            submit_send(queue.front());
+        }
+        const bool complete = result >= 0 && op->offset + static_cast<size_t>(result) >= op->data.size();
+        finish(op, complete ? static_cast<ssize_t>(op->data.size()) : (result < 0 ? result : -ECANCELED));
+        for (SendOp* unsent : dropped) finish(unsent, -ECANCELED);
+        break;
+    }
+
+    case OpWake:
+    case OpAcceptRetry:
+        --inflight_;
+        if (stopping_) break;
+        if ((user_data & kOpMask) == OpWake) {
+            arm_wake();
+        } else {
+            arm_accept();
+        }
+        break;
+
+    default:
+        break; // OpCancel
+    }
+}
+
+// Cancels every operation and reaps until the kernel owes nothing, so no
+// send buffer is freed while the kernel could still read it
+void UringBackend::cancel_all() {
+    io_uring_sqe* sqe = ring_->get_sqe();
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->cancel_flags = IORING_ASYNC_CANCEL_ALL | IORING_ASYNC_CANCEL_ANY;
+    sqe->user_data = OpCancel;
+
+    while (inflight_ > 0) {
+        if (ring_->submit(1) < 0 && errno != EINTR) break;
+        reap();
+    }
+
+    auto queues = std::move(send_queues_);
+    send_queues_.clear();
+    for (auto& [fd, queue] : queues) {
+        for (SendOp* op : queue) finish(op, -ECANCELED);
+    }
+}
+
+}
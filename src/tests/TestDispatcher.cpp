@@ -0,0 +1,484 @@
+// src/tests/TestDispatcher.cpp
+#include <gtest/gtest.h>
+#include "engine/Coroutine.hpp"
+#include "engine/Dispatcher.hpp"
+#include "engine/Stats.hpp"
+#include "engine/Strand.hpp"
+#include "engine/TimerWheel.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace CMQ;
+
+namespace {
+    bool wait_until(const std::function<bool()>& done, std::chrono::milliseconds timeout = std::chrono::seconds(5)) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (!done()) {
+            if (std::chrono::steady_clock::now() > deadline) return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+}
+
+// Every externally dispatched task runs in work-stealing mode
+TEST(DispatcherTest, WorkStealingRunsExternalTasks) {
+    Dispatcher& dispatcher = Dispatcher::get_instance();
+    dispatcher.stop();
+    dispatcher.start(4, SchedulingMode::WorkStealing);
+
+    std::atomic<int> counter{0};
+    for (int i = 0; i < 10000; ++i) {
+        dispatcher.dispatch([&counter]() { counter++; });
+    }
+
+    EXPECT_TRUE(wait_until([&]() { return counter == 10000; }));
+    dispatcher.stop();
+}
+
+// Tasks spawned from a worker land on its local deque and still all run
+TEST(DispatcherTest, WorkStealingRunsSpawnedTasks) {
+    Dispatcher& dispatcher = Dispatcher::get_instance();
+    dispatcher.stop();
+    dispatcher.start(4, SchedulingMode::WorkStealing);
+
+    std::atomic<int> counter{0};
+    for (int seed = 0; seed < 4; ++seed) {
+        dispatcher.dispatch([&dispatcher, &counter]() {
+            for (int i = 0; i < 2500; ++i) {
+                dispatcher.dispatch([&counter]() { counter++; });
+            }
+        });
+    }
+
+    EXPECT_TRUE(wait_until([&]() { return counter == 10000; }));
+    dispatcher.stop();
+}
+
+// A high-priority task spawned from a worker runs before its queued siblings
+TEST(DispatcherTest, WorkStealingKeepsHighPriorityOrder) {
+    Dispatcher& dispatcher = Dispatcher::get_instance();
+    dispatcher.stop();
+    dispatcher.start(1, SchedulingMode::WorkStealing);
+
+    std::mutex order_mutex;
+    std::vector<int> order;
+    std::atomic<bool> finished{false};
+    dispatcher.dispatch([&]() {
+        auto record = [&](int id) {
+            return [&, id]() {
+                std::lock_guard<std::mutex> lock(order_mutex);
+                order.push_back(id);
+                if (order.size() == 3) finished = true;
+            };
+        };
+        dispatcher.dispatch(record(1));
+        dispatcher.dispatch(record(2));
+        dispatcher.dispatch(record(0), true);
+    });
+
+    ASSERT_TRUE(wait_until([&]() { return finished.load(); }));
+    EXPECT_EQ(order, (std::vector<int>{0, 1, 2}));
+    dispatcher.stop();
+}
+
+// The dispatcher can be restarted after stop() and keeps accepting work
+TEST(DispatcherTest, RestartAfterStop) {
+    Dispatcher& dispatcher = Dispatcher::get_instance();
+    dispatcher.stop();
+
+    std::atomic<int> counter{0};
+    for (SchedulingMode mode : {SchedulingMode::SharedQueue, SchedulingMode::WorkStealing}) {
+        dispatcher.start(2, mode);
+        EXPECT_TRUE(dispatcher.dispatch([&counter]() { counter++; }));
+        EXPECT_TRUE(wait_until([&]() { return counter == 1; }));
+        dispatcher.stop();
+        counter = 0;
+    }
+}
+
+// Stats may be polled from any thread (e.g. /status) while a pool restarts
+// with a different mode and worker count
+TEST(DispatcherTest, StatsWhileRestarting) {
+    Dispatcher pool("restarting");
+    std::atomic<bool> polling{true};
+    std::thread poller([&polling]() {
+        while (polling) {
+            for (const DispatcherStats& stats : Dispatcher::all_stats()) {
+                if (stats.name == "restarting") EXPECT_LE(stats.workers.size(), 4u);
+            }
+        }
+    });
+    for (int round = 0; round < 50; ++round) {
+        pool.start(round % 2 ? 2 : 4, round % 2 ? SchedulingMode::WorkStealing : SchedulingMode::SharedQueue);
+        pool.dispatch([]() {});
+        pool.stop();
+    }
+    polling = false;
+    poller.join();
+}
+
+// A stopped pool says it dropped the task, so callers (e.g. Strand) can run
+// it themselves; a coroutine scheduled on it just continues
+TEST(DispatcherTest, StoppedPoolRejectsTasks) {
+    Dispatcher pool("stopped");
+    bool ran = false;
+    EXPECT_FALSE(pool.dispatch([&ran]() { ran = true; }, TaskLane::NetworkIO));
+    EXPECT_FALSE(ran);
+
+    TaskQueue queue;
+    queue.close();
+    EXPECT_FALSE(queue.push([]() {}, TaskLane::GameplayTick));
+
+    Strand strand(pool);
+    strand.post([&ran]() { ran = true; });
+    EXPECT_TRUE(ran);
+    EXPECT_EQ(strand.pending(), 0u);
+}
+
+namespace {
+    // Holds the single worker busy so tasks pile up before any of them run
+    struct WorkerGate {
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool open = false;
+
+        void block(Dispatcher& dispatcher) {
+            std::atomic<bool> entered{false};
+            dispatcher.dispatch([this, &entered]() {
+                entered = true;
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [this]() { return open; });
+            });
+            while (!entered) std::this_thread::yield();
+        }
+
+        void release() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                open = true;
+            }
+            cv.notify_all();
+        }
+    };
+}
+
+// A flood on a heavy lane cannot starve a light lane, and depth is readable per lane
+TEST(DispatcherTest, LanesShareWorkersByWeight) {
+    Dispatcher& dispatcher = Dispatcher::get_instance();
+    dispatcher.stop();
+    dispatcher.start(1);
+
+    WorkerGate gate;
+    gate.block(dispatcher);
+
+    std::mutex order_mutex;
+    std::vector<TaskLane> order;
+    auto record = [&](TaskLane lane) {
+        return [&, lane]() {
+            std::lock_guard<std::mutex> lock(order_mutex);
+            order.push_back(lane);
+        };
+    };
+    for (int i = 0; i < 100; ++i) dispatcher.dispatch(record(TaskLane::NetworkIO), TaskLane::NetworkIO);
+    dispatcher.dispatch(record(TaskLane::Background), TaskLane::Background);
+
+    EXPECT_EQ(dispatcher.queue_depth(TaskLane::NetworkIO), 100u);
+    EXPECT_EQ(dispatcher.queue_depth(TaskLane::Background), 1u);
+
+    gate.release();
+    ASSERT_TRUE(wait_until([&]() {
+        std::lock_guard<std::mutex> lock(order_mutex);
+        return order.size() == 101;
+    }));
+
+    // Weight 8 vs 1: the background task gets its turn within the first round
+    auto position = std::find(order.begin(), order.end(), TaskLane::Background) - order.begin();
+    EXPECT_LE(position, 9);
+    EXPECT_EQ(dispatcher.queue_depth(TaskLane::NetworkIO), 0u);
+    dispatcher.stop();
+}
+
+// Within a lane, deadline tasks run earliest-deadline-first ahead of FIFO tasks
+TEST(DispatcherTest, DeadlinesRunEarliestFirst) {
+    Dispatcher& dispatcher = Dispatcher::get_instance();
+    dispatcher.stop();
+    dispatcher.start(1);
+
+    WorkerGate gate;
+    gate.block(dispatcher);
+
+    std::mutex order_mutex;
+    std::vector<int> order;
+    auto record = [&](int id) {
+        return [&, id]() {
+            std::lock_guard<std::mutex> lock(order_mutex);
+            order.push_back(id);
+        };
+    };
+    auto now = std::chrono::steady_clock::now();
+    dispatcher.dispatch(record(4), TaskLane::GameplayTick);
+    dispatcher.dispatch(record(3), TaskLane::GameplayTick, now + std::chrono::milliseconds(30));
+    dispatcher.dispatch(record(1), TaskLane::GameplayTick, now + std::chrono::milliseconds(10));
+    dispatcher.dispatch(record(2), TaskLane::GameplayTick, now + std::chrono::milliseconds(20));
+
+    gate.release();
+    ASSERT_TRUE(wait_until([&]() {
+        std::lock_guard<std::mutex> lock(order_mutex);
+        return order.size() == 4;
+    }));
+    EXPECT_EQ(order, (std::vector<int>{1, 2, 3, 4}));
+    dispatcher.stop();
+}
+
+// One-shot, periodic, cancelled and rescheduled timers on a private wheel
+TEST(TimerWheelTest, FiresCancelsAndReschedules) {
+    using namespace std::chrono_literals;
+    Dispatcher& dispatcher = Dispatcher::get_instance();
+    dispatcher.stop();
+    dispatcher.start(2);
+    TimerWheel wheel(dispatcher);
+
+    std::atomic<int> one_shot{0}, periodic{0}, cancelled{0}, moved{0};
+    auto start = std::chrono::steady_clock::now();
+    std::atomic<int64_t> one_shot_at{0};
+    wheel.schedule(20ms, [&]() {
+        one_shot_at = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        one_shot++;
+    });
+    auto tick = wheel.schedule_periodic(5ms, [&]() { periodic++; });
+    auto dropped = wheel.schedule(10ms, [&]() { cancelled++; });
+    auto later = wheel.schedule(5ms, [&]() { moved++; });
+
+    wheel.cancel(dropped);
+    EXPECT_TRUE(wheel.reschedule(later, 400ms)); // past the first level
+    EXPECT_FALSE(wheel.reschedule(dropped, 1ms));
+
+    ASSERT_TRUE(wait_until([&]() { return one_shot == 1 && periodic >= 5; }));
+    EXPECT_GE(one_shot_at.load(), 20);
+    EXPECT_EQ(moved, 0);
+
+    ASSERT_TRUE(wait_until([&]() { return moved == 1; }));
+    EXPECT_GE(std::chrono::steady_clock::now() - start, 400ms);
+
+    wheel.cancel(tick);
+    int after_cancel = periodic;
+    std::this_thread::sleep_for(30ms);
+    EXPECT_EQ(periodic, after_cancel);
+    EXPECT_EQ(cancelled, 0);
+    EXPECT_EQ(one_shot, 1);
+    EXPECT_EQ(wheel.active_timers(), 0u);
+    dispatcher.stop();
+}
+
+// Independent pools run side by side; stopping one leaves the other serving
+TEST(DispatcherTest, NamedPoolsAreIndependent) {
+    Dispatcher io("io");
+    Dispatcher sim("sim");
+    io.start(2);
+
+    DispatcherOptions options;
+    options.thread_count = 2;
+    options.cpus = {0}; // every sandbox has a CPU 0
+    sim.start(options);
+
+    std::atomic<int> io_runs{0}, sim_runs{0};
+    for (int i = 0; i < 1000; ++i) {
+        io.dispatch([&io_runs]() { io_runs++; });
+        sim.dispatch([&sim_runs]() { sim_runs++; });
+    }
+    ASSERT_TRUE(wait_until([&]() { return io_runs == 1000 && sim_runs == 1000; }));
+    EXPECT_EQ(io.name(), "io");
+    EXPECT_EQ(sim.thread_count(), 2u);
+
+    io.stop();
+    EXPECT_FALSE(io.is_running());
+    EXPECT_TRUE(sim.is_running());
+    sim.dispatch([&sim_runs]() { sim_runs++; });
+    EXPECT_TRUE(wait_until([&]() { return sim_runs == 1001; }));
+    sim.stop();
+}
+
+namespace {
+    CoTask<int> add_on_worker(Dispatcher& dispatcher, int a, int b) {
+        co_await dispatcher.schedule();
+        co_return a + b;
+    }
+
+    CoTask<void> sleepy_sum(Dispatcher& dispatcher, std::atomic<int>& result, std::atomic<bool>& on_worker_thread,
+                            std::thread::id caller) {
+        int sum = co_await add_on_worker(dispatcher, 2, 3);
+        co_await sleep_for(std::chrono::milliseconds(20));
+        sum += co_await add_on_worker(dispatcher, sum, 10);
+        on_worker_thread = std::this_thread::get_id() != caller;
+        result = sum;
+    }
+}
+
+// A spawned coroutine hops onto the pool, sleeps on the timer wheel and
+// awaits nested coroutines without blocking the caller
+TEST(CoroutineTest, ScheduleSleepAndAwait) {
+    Dispatcher& dispatcher = Dispatcher::get_instance();
+    dispatcher.stop();
+    dispatcher.start(2);
+
+    std::atomic<int> result{0};
+    std::atomic<bool> on_worker_thread{false};
+    auto start = std::chrono::steady_clock::now();
+    co_spawn(dispatcher, sleepy_sum(dispatcher, result, on_worker_thread, std::this_thread::get_id()));
+
+    ASSERT_TRUE(wait_until([&]() { return result != 0; }));
+    EXPECT_EQ(result, 20);
+    EXPECT_TRUE(on_worker_thread);
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+    dispatcher.stop();
+}
+
+// Each strand runs its tasks in post order and never two at once, while
+// different strands still make progress in parallel on the pool
+TEST(StrandTest, OrderedAndSerialPerStrand) {
+    Dispatcher& dispatcher = Dispatcher::get_instance();
+    dispatcher.stop();
+    dispatcher.start(4, SchedulingMode::WorkStealing);
+
+    constexpr int kStrands = 8;
+    constexpr int kTasks = 2000;
+    struct Client {
+        Client(Dispatcher& dispatcher) : strand(dispatcher) {}
+        Strand strand;
+        std::vector<int> order; // touched only from the strand
+        std::atomic<int> inside{0};
+        std::atomic<bool> overlapped{false};
+        std::atomic<bool> off_strand{false};
+    };
+    std::vector<std::unique_ptr<Client>> clients;
+    for (int c = 0; c < kStrands; ++c) clients.push_back(std::make_unique<Client>(dispatcher));
+
+    for (int i = 0; i < kTasks; ++i) {
+        for (auto& client : clients) {
+            Client* raw = client.get();
+            raw->strand.post([raw, i]() {
+                if (raw->inside.fetch_add(1) != 0) raw->overlapped = true;
+                if (!raw->strand.running_in_this_thread()) raw->off_strand = true;
+                raw->order.push_back(i);
+                raw->inside.fetch_sub(1);
+            });
+        }
+    }
+
+    ASSERT_TRUE(wait_until([&]() {
+        for (auto& client : clients) {
+            if (client->strand.pending() != 0 || client->inside != 0) return false;
+        }
+        return true;
+    }));
+    dispatcher.stop(); // joins workers, so every order vector is complete and visible
+
+    for (auto& client : clients) {
+        ASSERT_EQ(client->order.size(), static_cast<size_t>(kTasks));
+        for (int i = 0; i < kTasks; ++i) ASSERT_EQ(client->order[i], i);
+        EXPECT_FALSE(client->overlapped);
+        EXPECT_FALSE(client->off_strand);
+    }
+}
+
+// Spin-then-park workers pick up bursts, park between them and still wake
+// for the next burst, in both scheduling modes
+TEST(DispatcherTest, SpinThenParkWakesParkedWorkers) {
+    for (SchedulingMode mode : {SchedulingMode::SharedQueue, SchedulingMode::WorkStealing}) {
+        Dispatcher dispatcher("spin");
+        DispatcherOptions options;
+        options.thread_count = 3;
+        options.mode = mode;
+        options.idle.strategy = IdleStrategy::SpinThenPark;
+        options.idle.spin_iterations = 64;
+        options.idle.yield_iterations = 2;
+        dispatcher.start(options);
+
+        std::atomic<int> counter{0};
+        for (int burst = 1; burst <= 5; ++burst) {
+            for (int i = 0; i < 200; ++i) {
+                dispatcher.dispatch([&counter]() { counter++; });
+            }
+            ASSERT_TRUE(wait_until([&]() { return counter == burst * 200; }));
+            std::this_thread::sleep_for(std::chrono::milliseconds(5)); // long enough to park
+        }
+        dispatcher.stop();
+    }
+}
+
+// Every value lands in a bucket whose upper bound covers it, within the
+// ~12% log-linear resolution, and percentiles come back from those bounds
+TEST(StatsTest, HistogramBucketsAndPercentiles) {
+    for (uint64_t value : {0ull, 1ull, 15ull, 16ull, 17ull, 1000ull, 123456789ull, 1ull << 39}) {
+        size_t index = LatencyHistogram::bucket_index(value);
+        ASSERT_LT(index, LatencyHistogram::kBucketCount);
+        uint64_t bound = LatencyHistogram::bucket_upper_bound(index);
+        EXPECT_GE(bound, value);
+        EXPECT_LE(bound, value + value / 8 + 1);
+    }
+
+    LatencyHistogram histogram;
+    for (uint64_t value = 1; value <= 1000; ++value) histogram.record(value * 1000);
+    HistogramSnapshot snapshot;
+    histogram.snapshot_into(snapshot);
+
+    EXPECT_EQ(snapshot.count(), 1000u);
+    EXPECT_EQ(snapshot.max(), 1000000u);
+    EXPECT_NEAR(static_cast<double>(snapshot.percentile(0.5)), 500000.0, 500000.0 / 8);
+    EXPECT_NEAR(static_cast<double>(snapshot.percentile(0.99)), 990000.0, 990000.0 / 8);
+    EXPECT_EQ(snapshot.percentile(1.0), 1000000u);
+}
+
+// Per-lane counts, failures and queue waits are aggregated across workers
+// and the pool is listed by all_stats()
+TEST(StatsTest, DispatcherCountsTasksPerLane) {
+    for (SchedulingMode mode : {SchedulingMode::SharedQueue, SchedulingMode::WorkStealing}) {
+        Dispatcher dispatcher("stats");
+        DispatcherOptions options;
+        options.thread_count = 2;
+        options.mode = mode;
+        dispatcher.start(options);
+
+        std::atomic<int> done{0};
+        for (int i = 0; i < 100; ++i) {
+            dispatcher.dispatch([&done]() { done++; }, TaskLane::NetworkIO);
+        }
+        for (int i = 0; i < 10; ++i) {
+            dispatcher.dispatch([&done]() {
+                done++;
+                throw std::runtime_error("expected failure");
+            }, TaskLane::Background);
+        }
+        ASSERT_TRUE(wait_until([&]() { return done == 110; }));
+        dispatcher.stop(); // joins workers, so every counter is final
+
+        DispatcherStats stats = dispatcher.stats();
+        EXPECT_EQ(stats.name, "stats");
+        ASSERT_EQ(stats.workers.size(), 2u);
+
+        uint64_t executed = 0;
+        for (const WorkerStats& worker : stats.workers) executed += worker.executed;
+        EXPECT_EQ(executed, 110u);
+
+        const LaneStats& io = stats.lanes[static_cast<size_t>(TaskLane::NetworkIO)];
+        const LaneStats& background = stats.lanes[static_cast<size_t>(TaskLane::Background)];
+        EXPECT_EQ(io.executed, 100u);
+        EXPECT_EQ(io.failed, 0u);
+        EXPECT_EQ(io.queue_wait.count(), 100u);
+        EXPECT_EQ(io.run_time.count(), 100u);
+        EXPECT_EQ(background.executed, 10u);
+        EXPECT_EQ(background.failed, 10u);
+
+        auto all = Dispatcher::all_stats();
+        EXPECT_TRUE(std::any_of(all.begin(), all.end(), [](const DispatcherStats& s) { return s.name == "stats"; }));
+    }
+}
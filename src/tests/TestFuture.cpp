@@ -0,0 +1,122 @@
+// src/tests/TestFuture.cpp
+#include <gtest/gtest.h>
+#include "engine/Future.hpp"
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace CMQ;
+
+class FutureTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        Dispatcher::get_instance().stop();
+        Dispatcher::get_instance().start(4, SchedulingMode::WorkStealing);
+    }
+
+    void TearDown() override {
+        Dispatcher::get_instance().stop();
+    }
+
+    Dispatcher& pool() { return Dispatcher::get_instance(); }
+};
+
+// submit -> then (inline) -> then (on the pool) -> get
+TEST_F(FutureTest, ThenChainsValues) {
+    auto result = submit(pool(), []() { return 20; })
+                      .then([](int value) { return value + 1; })
+                      .then(pool(), [](int value) { return std::to_string(value * 2); });
+    EXPECT_EQ(result.get(), "42");
+}
+
+// A continuation attached to an already-completed future runs on the caller
+TEST_F(FutureTest, ThenOnReadyFutureRunsInline) {
+    auto caller = std::this_thread::get_id();
+    std::thread::id ran_on;
+    auto done = make_ready_future(1).then([&](int) { ran_on = std::this_thread::get_id(); });
+    EXPECT_TRUE(done.is_ready());
+    EXPECT_EQ(ran_on, caller);
+}
+
+// Exceptions skip the remaining continuations and surface from get()
+TEST_F(FutureTest, ExceptionsPropagate) {
+    std::atomic<bool> skipped_ran{false};
+    auto result = submit(pool(), []() -> int { throw std::runtime_error("boom"); })
+                      .then([&](int value) {
+                          skipped_ran = true;
+                          return value;
+                      });
+    EXPECT_THROW(result.get(), std::runtime_error);
+    EXPECT_FALSE(skipped_ran);
+}
+
+// A continuation returning a Future is flattened into the chain
+TEST_F(FutureTest, ThenUnwrapsReturnedFuture) {
+    Dispatcher& dispatcher = pool();
+    auto result = submit(dispatcher, []() { return 3; }).then([&dispatcher](int value) {
+        return submit(dispatcher, [value]() { return value * 7; });
+    });
+    EXPECT_EQ(result.get(), 21);
+}
+
+// Parallel fan-out joined without blocking a worker, then one follow-up step
+TEST_F(FutureTest, WhenAllCollectsInOrder) {
+    std::vector<Future<int>> parts;
+    for (int i = 0; i < 64; ++i) {
+        parts.push_back(submit(pool(), [i]() { return i * i; }));
+    }
+    auto total = when_all(std::move(parts)).then([](std::vector<int> values) {
+        int sum = 0;
+        for (size_t i = 0; i < values.size(); ++i) {
+            EXPECT_EQ(values[i], static_cast<int>(i * i));
+            sum += values[i];
+        }
+        return sum;
+    });
+    EXPECT_EQ(total.get(), 85344);
+
+    std::atomic<int> ticks{0};
+    std::vector<Future<void>> work;
+    for (int i = 0; i < 16; ++i) {
+        work.push_back(submit(pool(), [&ticks]() { ticks++; }));
+    }
+    when_all(std::move(work)).get();
+    EXPECT_EQ(ticks, 16);
+
+    EXPECT_TRUE(when_all(std::vector<Future<int>>{}).get().empty());
+}
+
+TEST_F(FutureTest, WhenAllFailsOnFirstException) {
+    std::vector<Future<int>> parts;
+    parts.push_back(submit(pool(), []() { return 1; }));
+    parts.push_back(submit(pool(), []() -> int { throw std::logic_error("bad part"); }));
+    EXPECT_THROW(when_all(std::move(parts)).get(), std::logic_error);
+}
+
+TEST_F(FutureTest, WhenAnyReturnsFirstFinished) {
+    Promise<int> never;
+    std::vector<Future<int>> racers;
+    racers.push_back(never.get_future());
+    racers.push_back(submit(pool(), []() { return 7; }));
+
+    auto [index, value] = when_any(std::move(racers)).get();
+    EXPECT_EQ(index, 1u);
+    EXPECT_EQ(value, 7);
+    never.set_value(0); // late completion is ignored
+}
+
+// A dropped promise (e.g. a task discarded by a stopped pool) breaks its future
+TEST_F(FutureTest, BrokenPromise) {
+    Future<int> orphan;
+    {
+        Promise<int> promise;
+        orphan = promise.get_future();
+    }
+    EXPECT_THROW(orphan.get(), std::future_error);
+
+    pool().stop();
+    EXPECT_THROW(submit(pool(), []() { return 1; }).get(), std::future_error);
+}
@@ -0,0 +1,158 @@
+// src/tests/TestMessageQueue.cpp
+#include <gtest/gtest.h>
+#include "engine/MessageQueue.hpp"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace CMQ;
+
+class MessageQueueBackendTest : public ::testing::TestWithParam<QueueBackend> {};
+
+// Items come out in FIFO order and try_pop reports an empty queue
+TEST_P(MessageQueueBackendTest, PushPopFifo) {
+    MessageQueue<std::string> queue(8, GetParam());
+    queue.push("move 1 2");
+    queue.push("chat hi");
+    EXPECT_EQ(queue.size(), 2u);
+
+    std::string item;
+    ASSERT_TRUE(queue.pop(item));
+    EXPECT_EQ(item, "move 1 2");
+    ASSERT_TRUE(queue.try_pop(item));
+    EXPECT_EQ(item, "chat hi");
+    EXPECT_FALSE(queue.try_pop(item));
+    EXPECT_TRUE(queue.empty());
+}
+
+// close() releases a blocked consumer and leaves queued items drainable
+TEST_P(MessageQueueBackendTest, CloseWakesConsumers) {
+    MessageQueue<int> queue(4, GetParam());
+    std::atomic<bool> returned{false};
+    std::thread consumer([&]() {
+        int item;
+        EXPECT_FALSE(queue.pop(item));
+        returned = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    queue.close();
+    consumer.join();
+    EXPECT_TRUE(returned);
+    EXPECT_TRUE(queue.is_closed());
+}
+
+// Producers blocked on a full queue make progress as consumers drain it
+TEST_P(MessageQueueBackendTest, ManyProducersManyConsumers) {
+    MessageQueue<int> queue(16, GetParam());
+    constexpr int kProducers = 4;
+    constexpr int kPerProducer = 20000;
+    std::atomic<long long> sum{0};
+    std::atomic<int> count{0};
+
+    std::vector<std::thread> consumers;
+    for (int c = 0; c < 4; ++c) {
+        consumers.emplace_back([&]() {
+            int item;
+            while (queue.pop(item)) {
+                sum += item;
+                count++;
+            }
+        });
+    }
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&]() {
+            for (int i = 1; i <= kPerProducer; ++i) queue.push(i);
+        });
+    }
+    for (auto& t : producers) t.join();
+    while (count < kProducers * kPerProducer) std::this_thread::yield();
+    queue.close();
+    for (auto& t : consumers) t.join();
+
+    EXPECT_EQ(count, kProducers * kPerProducer);
+    EXPECT_EQ(sum, static_cast<long long>(kProducers) * kPerProducer * (kPerProducer + 1) / 2);
+}
+
+// push_bulk moves a burst in and pop_bulk drains it in order in one call
+TEST_P(MessageQueueBackendTest, BulkPushAndPop) {
+    MessageQueue<std::string> queue(64, GetParam());
+    std::vector<std::string> burst = {"move 1 2", "chat hi", "attack Dragon"};
+    EXPECT_EQ(queue.push_bulk(burst), 3u);
+    queue.push(std::string(5, 'x'));
+    queue.push(std::string("chat bye"));
+
+    std::vector<std::string> out;
+    EXPECT_EQ(queue.pop_bulk(out, 4, std::chrono::milliseconds(100)), 4u);
+    EXPECT_EQ(out, (std::vector<std::string>{"move 1 2", "chat hi", "attack Dragon", "xxxxx"}));
+    EXPECT_EQ(queue.pop_bulk(out, 16, std::chrono::milliseconds(100)), 1u);
+    EXPECT_EQ(out.back(), "chat bye");
+
+    // Empty queue: pop_bulk gives up after the timeout
+    EXPECT_EQ(queue.pop_bulk(out, 16, std::chrono::milliseconds(10)), 0u);
+}
+
+// A burst larger than the capacity still goes through as consumers drain it
+TEST_P(MessageQueueBackendTest, BulkPushLargerThanCapacity) {
+    MessageQueue<int> queue(4, GetParam());
+    std::vector<int> burst(1000);
+    for (int i = 0; i < 1000; ++i) burst[i] = i;
+
+    std::vector<int> received;
+    std::thread consumer([&]() {
+        while (received.size() < burst.size()) {
+            queue.pop_bulk(received, 32, std::chrono::milliseconds(100));
+        }
+    });
+    EXPECT_EQ(queue.push_bulk(burst), burst.size());
+    consumer.join();
+    EXPECT_EQ(received, burst);
+}
+
+// Closing a full queue under a blocked bulk push ends it, and the count it
+// returns is exactly what was stored
+TEST_P(MessageQueueBackendTest, CloseDuringBulkPushCountsOnlyStoredItems) {
+    MessageQueue<int> queue(4, GetParam());
+    std::vector<int> burst(100);
+    for (int i = 0; i < 100; ++i) burst[i] = i;
+
+    std::thread closer([&queue]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        queue.close();
+    });
+    size_t pushed = queue.push_bulk(burst);
+    closer.join();
+
+    size_t stored = 0;
+    int item;
+    while (queue.try_pop(item)) ASSERT_EQ(item, static_cast<int>(stored++));
+    EXPECT_LT(pushed, burst.size());
+    EXPECT_EQ(pushed, stored);
+}
+
+// Without a comparator the locked backend is strictly FIFO
+TEST(MessageQueueTest, LockedBackendIsFifo) {
+    MessageQueue<int> queue(16);
+    for (int i = 0; i < 10; ++i) queue.push(i);
+    for (int i = 0; i < 10; ++i) {
+        int item = -1;
+        ASSERT_TRUE(queue.try_pop(item));
+        EXPECT_EQ(item, i);
+    }
+}
+
+// A comparator still orders the locked backend by priority
+TEST(MessageQueueTest, ComparatorOrdersByPriority) {
+    MessageQueue<int> queue(16, [](const int& a, const int& b) { return a < b; });
+    for (int value : {3, 9, 1, 7}) queue.push(value);
+
+    std::vector<int> out;
+    queue.pop_bulk(out, 4, std::chrono::milliseconds(10));
+    EXPECT_EQ(out, (std::vector<int>{9, 7, 3, 1}));
+}
+
+INSTANTIATE_TEST_SUITE_P(Backends, MessageQueueBackendTest,
+                         ::testing::Values(QueueBackend::Locked, QueueBackend::LockFreeRing));
@@ -2,14 +2,33 @@
 #include <gtest/gtest.h>
 #include "network/NetworkServer.hpp"
 #include "network/NetworkClient.hpp"
+#include "network/AsyncSocket.hpp"
+#include "network/Framing.hpp"
+#include "network/HeartbeatTable.hpp"
+#include "network/OutboundQueue.hpp"
+#include "network/TlsSocket.hpp"
+#include "network/WireCodec.hpp"
+#include "gameplay/commands/ChatCommand.hpp"
+#include "gameplay/commands/MoveCommand.hpp"
 #include "engine/Dispatcher.hpp"
 #include "gameplay/GameServer.hpp"
 #include "gameplay/GameClient.hpp"
+#include "web/WebServer.hpp"
 #include <thread>
 #include <chrono>
+#include <deque>
 #include <atomic>
 #include <vector>
+#include <set>
 #include <sstream>
+#include <cstdio>
+#include <filesystem>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+#include <sys/socket.h>
+#include <poll.h>
+#include <arpa/inet.h>
+#include <unistd.h>
 
 using namespace CMQ;
 
@@ -23,7 +42,7 @@ TEST(GameServerTest, ServerStartAndStop) {
     ResetDispatcher();
     Dispatcher::get_instance().start(4);
 
-    auto message_queue = std::make_shared<MessageQueue<std::string>>(100);
+    auto message_queue = std::make_shared<MessageQueue<Payload>>(100);
     GameServer server(8080, message_queue, ProtocolType::TCP, false);
     EXPECT_NO_THROW(server.start());
 
@@ -37,7 +56,7 @@ TEST(GameClientTest, ClientConnectAndDisconnect) {
     ResetDispatcher();
     Dispatcher::get_instance().start(4);
 
-    auto message_queue = std::make_shared<MessageQueue<std::string>>(100);
+    auto message_queue = std::make_shared<MessageQueue<Payload>>(100);
     GameServer server(8080, message_queue, ProtocolType::TCP, false);
     server.start();
     std::this_thread::sleep_for(std::chrono::seconds(1)); // 确保服务器启动
@@ -61,7 +80,7 @@ TEST(GameClientTest, ClientCommandTest) {
     ResetDispatcher();
     Dispatcher::get_instance().start(4);
 
-    auto message_queue = std::make_shared<MessageQueue<std::string>>(100);
+    auto message_queue = std::make_shared<MessageQueue<Payload>>(100);
     GameServer server(8080, message_queue, ProtocolType::TCP, false);
     server.start();
     std::this_thread::sleep_for(std::chrono::seconds(1)); // 确保服务器启动
@@ -82,6 +101,1116 @@ TEST(GameClientTest, ClientCommandTest) {
     Dispatcher::get_instance().stop();
 }
 
+namespace {
+    CoTask<void> echo_session(AsyncSocket socket, std::atomic<int>& echoed) {
+        std::array<char, 64> buffer;
+        while (true) {
+            ssize_t bytes = co_await socket.read(buffer);
+            if (bytes <= 0) break;
+            echoed += static_cast<int>(bytes);
+            co_await socket.write_all(std::span<const char>(buffer.data(), static_cast<size_t>(bytes)));
+        }
+        close(socket.fd());
+    }
+}
+
+// Many coroutine sessions share two workers; none holds a thread while idle
+TEST(AsyncSocketTest, CoroutineEchoSessions) {
+    ResetDispatcher();
+    Dispatcher::get_instance().start(2);
+    Reactor reactor(Dispatcher::get_instance());
+    reactor.start();
+
+    constexpr int kSessions = 64;
+    std::atomic<int> echoed{0};
+    std::vector<int> peers;
+    for (int i = 0; i < kSessions; ++i) {
+        int fds[2];
+        ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+        co_spawn(Dispatcher::get_instance(), echo_session(AsyncSocket(fds[0], reactor), echoed), TaskLane::NetworkIO);
+        peers.push_back(fds[1]);
+    }
+
+    for (int fd : peers) {
+        ASSERT_EQ(send(fd, "ping", 4, 0), 4);
+    }
+    for (int fd : peers) {
+        char reply[4];
+        ASSERT_EQ(recv(fd, reply, sizeof(reply), MSG_WAITALL), 4);
+        EXPECT_EQ(std::string(reply, 4), "ping");
+        close(fd); // session sees EOF and finishes
+    }
+    EXPECT_EQ(echoed, kSessions * 4);
+
+    reactor.stop();
+    Dispatcher::get_instance().stop();
+}
+
+// Idle connections hold no worker: far more clients than I/O threads all
+// stay connected and every one of them is still served
+TEST(NetworkServerTest, ServesMoreIdleClientsThanWorkers) {
+    ResetDispatcher();
+    Dispatcher::get_instance().start(2);
+    auto io = std::make_shared<Dispatcher>("io");
+    io->start(2);
+
+    auto message_queue = std::make_shared<MessageQueue<Payload>>(1024);
+    NetworkServer server(8091, message_queue, ProtocolType::TCP, false, io);
+    server.start();
+
+    constexpr int kClients = 256;
+    std::vector<int> clients;
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(8091);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    for (int i = 0; i < kClients; ++i) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        ASSERT_EQ(connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+        clients.push_back(fd);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100)); // every session is now parked
+
+    for (int i = 0; i < kClients; ++i) {
+        std::string message = encode_frame("hello-" + std::to_string(i));
+        ASSERT_EQ(send(clients[i], message.data(), message.size(), 0), static_cast<ssize_t>(message.size()));
+    }
+
+    int received = 0;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (received < kClients && std::chrono::steady_clock::now() < deadline) {
+        Payload message;
+        if (message_queue->try_pop(message)) {
+            ++received;
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    EXPECT_EQ(received, kClients);
+
+    for (int fd : clients) close(fd);
+    server.stop();
+    io->stop();
+    Dispatcher::get_instance().stop();
+}
+
+namespace {
+    class AckServer : public NetworkServer {
+    public:
+        using NetworkServer::NetworkServer;
+        ~AckServer() override { stop(); }
+
+    protected:
+        void handle_message(int client_fd, const Payload& message) override {
+            send_to_client(client_fd, "ack:" + message.str());
+        }
+    };
+
+    // Echoes each datagram back as a burst with one reply too large for a
+    // datagram in the middle
+    class BurstServer : public AckServer {
+    public:
+        static constexpr int kReplies = 200;
+        static constexpr int kOversized = 100;
+        using AckServer::AckServer;
+
+    protected:
+        void handle_message(int client_fd, const Payload& message) override {
+            for (int i = 0; i < kReplies; ++i) {
+                send_to_client(client_fd, i == kOversized ? std::string(70000, 'x')
+                                                          : message.str() + std::to_string(1000 + i));
+            }
+        }
+    };
+}
+
+// Both backends serve the same sessions; the io_uring one falls back to
+// epoll on kernels without it, so this passes either way
+TEST(NetworkServerTest, BackendsAcknowledgeEveryClient) {
+    ResetDispatcher();
+    Dispatcher::get_instance().start(2);
+
+    for (IoBackend backend : {IoBackend::Epoll, IoBackend::IoUring}) {
+        auto message_queue = std::make_shared<MessageQueue<Payload>>(16);
+        AckServer server(8092, message_queue, ProtocolType::TCP, false, nullptr, backend);
+        server.start();
+        std::cout << "Testing backend " << (server.io_backend() == IoBackend::IoUring ? "io_uring" : "epoll") << std::endl;
+
+        constexpr int kClients = 64;
+        std::vector<int> clients;
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(8092);
+        inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+        for (int i = 0; i < kClients; ++i) {
+            int fd = socket(AF_INET, SOCK_STREAM, 0);
+            ASSERT_EQ(connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+            clients.push_back(fd);
+        }
+        for (int i = 0; i < kClients; ++i) {
+            std::string message = encode_frame("m" + std::to_string(1000 + i));
+            ASSERT_EQ(send(clients[i], message.data(), message.size(), 0), static_cast<ssize_t>(message.size()));
+        }
+        timeval timeout{5, 0};
+        for (int i = 0; i < kClients; ++i) {
+            setsockopt(clients[i], SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            char reply[10];
+            ASSERT_EQ(recv(clients[i], reply, sizeof(reply), MSG_WAITALL), 10);
+            EXPECT_EQ(std::string(reply, 10), encode_frame("ack:m" + std::to_string(1000 + i)));
+        }
+
+        for (int fd : clients) close(fd);
+        server.stop();
+    }
+    Dispatcher::get_instance().stop();
+}
+
+// Several listeners share the port; whichever shard accepts a client
+// serves it to the end, on either backend
+TEST(NetworkServerTest, ShardedListenersServeEveryClient) {
+    ResetDispatcher();
+    Dispatcher::get_instance().start(2);
+
+    for (IoBackend backend : {IoBackend::Epoll, IoBackend::IoUring}) {
+        auto message_queue = std::make_shared<MessageQueue<Payload>>(16);
+        AckServer server(8096, message_queue, ProtocolType::TCP, false, nullptr, backend);
+        server.set_listener_shards(4);
+        server.start();
+        EXPECT_EQ(server.listener_shards(), 4u);
+
+        constexpr int kClients = 128;
+        std::vector<int> clients;
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(8096);
+        inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+        for (int i = 0; i < kClients; ++i) {
+            int fd = socket(AF_INET, SOCK_STREAM, 0);
+            ASSERT_EQ(connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+            clients.push_back(fd);
+        }
+        for (int i = 0; i < kClients; ++i) {
+            std::string message = encode_frame("m" + std::to_string(1000 + i));
+            ASSERT_EQ(send(clients[i], message.data(), message.size(), 0), static_cast<ssize_t>(message.size()));
+        }
+        timeval timeout{5, 0};
+        for (int i = 0; i < kClients; ++i) {
+            setsockopt(clients[i], SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            char reply[10];
+            ASSERT_EQ(recv(clients[i], reply, sizeof(reply), MSG_WAITALL), 10);
+            EXPECT_EQ(std::string(reply, 10), encode_frame("ack:m" + std::to_string(1000 + i)));
+        }
+
+        for (int fd : clients) close(fd);
+        server.stop();
+    }
+    Dispatcher::get_instance().stop();
+}
+
+namespace {
+    // Knows each client by the name it sends first, and greets it
+    class RosterServer : public NetworkServer {
+    public:
+        using NetworkServer::NetworkServer;
+        ~RosterServer() override { stop(); }
+
+        int fd_of(const std::string& name) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return fds_[name];
+        }
+
+    protected:
+        void handle_message(int client_fd, const Payload& message) override {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                fds_[message.str()] = client_fd;
+            }
+            send_to_client(client_fd, "joined");
+        }
+
+    private:
+        std::mutex mutex_;
+        std::unordered_map<std::string, int> fds_;
+    };
+
+    // A raw client socket and the frames read from it but not yet checked
+    struct FrameReader {
+        int fd = -1;
+        FrameDecoder decoder;
+        std::deque<std::string> frames;
+
+        // Waits up to timeout for the next frame
+        bool next(std::string& frame, std::chrono::milliseconds timeout = std::chrono::seconds(5)) {
+            std::vector<std::string> drained;
+            while (frames.empty()) {
+                pollfd ready{fd, POLLIN, 0};
+                if (poll(&ready, 1, static_cast<int>(timeout.count())) <= 0) return false;
+                std::span<char> space = decoder.prepare();
+                ssize_t bytes = recv(fd, space.data(), space.size(), 0);
+                if (bytes <= 0) return false;
+                decoder.commit(static_cast<size_t>(bytes));
+                decoder.drain(drained);
+                frames.insert(frames.end(), drained.begin(), drained.end());
+                drained.clear();
+            }
+            frame = std::move(frames.front());
+            frames.pop_front();
+            return true;
+        }
+    };
+}
+
+// A broadcast reaches every client on every shard, and a targeted one only
+// the clients it names, in the order the broadcasts were made
+TEST(NetworkServerTest, BroadcastsReachEveryTargetedClient) {
+    ResetDispatcher();
+    Dispatcher::get_instance().start(2);
+
+    for (IoBackend backend : {IoBackend::Epoll, IoBackend::IoUring}) {
+        auto message_queue = std::make_shared<MessageQueue<Payload>>(16);
+        RosterServer server(8101, message_queue, ProtocolType::TCP, false, nullptr, backend);
+        server.set_listener_shards(4);
+        server.start();
+
+        constexpr size_t kClients = 64;
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(8101);
+        inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+        std::vector<FrameReader> clients(kClients);
+        for (size_t i = 0; i < kClients; ++i) {
+            clients[i].fd = socket(AF_INET, SOCK_STREAM, 0);
+            ASSERT_EQ(connect(clients[i].fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+            std::string hello = encode_frame("c" + std::to_string(i));
+            ASSERT_EQ(send(clients[i].fd, hello.data(), hello.size(), 0), static_cast<ssize_t>(hello.size()));
+        }
+        std::string frame;
+        for (FrameReader& client : clients) {
+            ASSERT_TRUE(client.next(frame));
+            EXPECT_EQ(frame, "joined");
+        }
+
+        std::vector<int> evens;
+        for (size_t i = 0; i < kClients; i += 2) evens.push_back(server.fd_of("c" + std::to_string(i)));
+        EXPECT_EQ(server.broadcast("news"), kClients);
+        EXPECT_EQ(server.broadcast(evens, "evens only"), kClients / 2);
+        EXPECT_EQ(server.broadcast("bye"), kClients);
+
+        for (size_t i = 0; i < kClients; ++i) {
+            ASSERT_TRUE(clients[i].next(frame));
+            EXPECT_EQ(frame, "news");
+            if (i % 2 == 0) {
+                ASSERT_TRUE(clients[i].next(frame));
+                EXPECT_EQ(frame, "evens only");
+            }
+            ASSERT_TRUE(clients[i].next(frame));
+            EXPECT_EQ(frame, "bye");
+        }
+
+        for (FrameReader& client : clients) close(client.fd);
+        server.stop();
+    }
+    Dispatcher::get_instance().stop();
+}
+
+// A chat line goes out to every connected player, the sender included
+TEST(GameServerTest, ChatIsBroadcastToEveryPlayer) {
+    ResetDispatcher();
+    Dispatcher::get_instance().start(2);
+
+    auto message_queue = std::make_shared<MessageQueue<Payload>>(16);
+    GameServer server(8102, message_queue, ProtocolType::TCP, false);
+    server.set_command_encoding(CommandEncoding::Text);
+    server.start();
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(8102);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    auto ends_with = [](const std::string& text, const std::string& suffix) {
+        return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+    };
+
+    // Each player hears its own line first, so both are registered before
+    // the second one speaks
+    FrameReader first;
+    first.fd = socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_EQ(connect(first.fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+    std::string line = encode_frame("chat hello");
+    ASSERT_EQ(send(first.fd, line.data(), line.size(), 0), static_cast<ssize_t>(line.size()));
+    std::string frame;
+    ASSERT_TRUE(first.next(frame));
+    EXPECT_TRUE(ends_with(frame, ": hello")) << frame;
+
+    FrameReader second;
+    second.fd = socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_EQ(connect(second.fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+    line = encode_frame("chat hi all");
+    ASSERT_EQ(send(second.fd, line.data(), line.size(), 0), static_cast<ssize_t>(line.size()));
+    ASSERT_TRUE(second.next(frame));
+    EXPECT_TRUE(ends_with(frame, ": hi all")) << frame;
+    ASSERT_TRUE(first.next(frame));
+    EXPECT_TRUE(ends_with(frame, ": hi all")) << frame;
+
+    close(first.fd);
+    close(second.fd);
+    server.stop();
+    Dispatcher::get_instance().stop();
+}
+
+// Each UDP peer gets its own session and the replies to its own datagrams,
+// with and without kernel segmentation offload
+TEST(NetworkServerTest, UdpSessionsReplyToEachPeer) {
+    ResetDispatcher();
+    Dispatcher::get_instance().start(2);
+
+    for (bool offload : {false, true}) {
+        auto message_queue = std::make_shared<MessageQueue<Payload>>(16);
+        AckServer server(8094, message_queue, ProtocolType::UDP, false);
+        server.set_udp_offload(offload);
+        server.start();
+
+        constexpr int kPeers = 8;
+        constexpr int kMessages = 50;
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(8094);
+        inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+
+        std::vector<int> peers;
+        for (int p = 0; p < kPeers; ++p) {
+            int fd = socket(AF_INET, SOCK_DGRAM, 0);
+            ASSERT_EQ(connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+            timeval timeout{5, 0};
+            setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            peers.push_back(fd);
+        }
+        // One peer's burst at a time, so nothing is lost to a full socket
+        // buffer on hosts with a small net.core.rmem_max
+        for (int p = 0; p < kPeers; ++p) {
+            for (int i = 0; i < kMessages; ++i) {
+                std::string message = "p" + std::to_string(p) + "-" + std::to_string(100 + i);
+                ASSERT_EQ(send(peers[p], message.data(), message.size(), 0), static_cast<ssize_t>(message.size()));
+            }
+            std::set<std::string> replies;
+            for (int i = 0; i < kMessages; ++i) {
+                char reply[64];
+                ssize_t bytes = recv(peers[p], reply, sizeof(reply), 0);
+                ASSERT_GT(bytes, 0) << "peer " << p << " got " << i << " replies";
+                replies.emplace(reply, static_cast<size_t>(bytes));
+            }
+            EXPECT_EQ(replies.size(), static_cast<size_t>(kMessages));
+            EXPECT_EQ(*replies.begin(), "ack:p" + std::to_string(p) + "-100");
+        }
+
+        for (int fd : peers) close(fd);
+        server.stop();
+    }
+    Dispatcher::get_instance().stop();
+}
+
+// A reply the kernel refuses (EMSGSIZE) is skipped and counted; the
+// replies queued behind it still go out, in order
+TEST(NetworkServerTest, UdpRefusedReplyDoesNotDropTheRest) {
+    ResetDispatcher();
+    Dispatcher::get_instance().start(2);
+
+    auto message_queue = std::make_shared<MessageQueue<Payload>>(16);
+    BurstServer server(8105, message_queue, ProtocolType::UDP, false);
+    server.start();
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(8105);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    int peer = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_EQ(connect(peer, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+    int size = 1 << 20;
+    setsockopt(peer, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+    timeval timeout{5, 0};
+    setsockopt(peer, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    ASSERT_EQ(send(peer, "r", 1, 0), 1);
+    for (int i = 0; i < BurstServer::kReplies; ++i) {
+        if (i == BurstServer::kOversized) continue;
+        char reply[64];
+        ssize_t bytes = recv(peer, reply, sizeof(reply), 0);
+        ASSERT_GT(bytes, 0) << "reply " << i << " missing";
+        EXPECT_EQ(std::string(reply, static_cast<size_t>(bytes)), "r" + std::to_string(1000 + i));
+    }
+    EXPECT_EQ(server.dropped_datagrams(), 1u);
+
+    close(peer);
+    server.stop();
+    Dispatcher::get_instance().stop();
+}
+
+// Congestion sheds low-priority messages first; only a client that lets
+// max_queued pile up is cut off
+TEST(OutboundQueueTest, WatermarksDropLowPriorityThenOverflow) {
+    OutboundQueue queue(OutboundLimits{100, 200, 400});
+    EXPECT_EQ(queue.push(std::string(150, 'a')), OutboundQueue::Push::Flush);
+    EXPECT_EQ(queue.push(std::string(100, 'b'), SendPriority::Low), OutboundQueue::Push::Queued);
+    EXPECT_TRUE(queue.congested());
+    EXPECT_EQ(queue.push(std::string(10, 'c'), SendPriority::Low), OutboundQueue::Push::Dropped);
+    EXPECT_EQ(queue.push(std::string(100, 'd')), OutboundQueue::Push::Queued);
+    EXPECT_EQ(queue.push(std::string(100, 'e')), OutboundQueue::Push::Overflow);
+    EXPECT_EQ(queue.queued_bytes(), 350u);
+
+    // One flush sees every pending message as one gathered write
+    std::vector<iovec> iovecs;
+    EXPECT_EQ(queue.gather(iovecs, 64), 350u);
+    EXPECT_EQ(iovecs.size(), 3u);
+
+    queue.consume(300); // a short write ends inside the last message
+    EXPECT_FALSE(queue.congested());
+    iovecs.clear();
+    EXPECT_EQ(queue.gather(iovecs, 64), 50u);
+    EXPECT_EQ(static_cast<const char*>(iovecs[0].iov_base)[0], 'd');
+
+    EXPECT_EQ(queue.push(std::string(10, 'f'), SendPriority::Low), OutboundQueue::Push::Queued);
+    EXPECT_EQ(queue.end_flush(), OutboundQueue::FlushEnd::More);
+    queue.consume(60);
+    EXPECT_EQ(queue.end_flush(), OutboundQueue::FlushEnd::Idle);
+    EXPECT_TRUE(queue.close());
+}
+
+// Only connections whose deadline has passed come out of a sweep; one
+// heard from since is refiled, and a forgotten or reused id is skipped
+TEST(HeartbeatTableTest, ExpiresOnlyConnectionsPastTheirDeadline) {
+    using namespace std::chrono_literals;
+    HeartbeatTable table(HeartbeatOptions{100ms, 10ms});
+    auto start = HeartbeatTable::Clock::now();
+    for (int id : {3, 4, 5, 6}) EXPECT_TRUE(table.track(id, start));
+    EXPECT_FALSE(table.track(-1, start));
+
+    table.touch(4, start + 60ms);
+    table.forget(5);
+    table.forget(6);
+    EXPECT_TRUE(table.track(6, start + 30ms)); // the fd went to a new client
+
+    std::vector<int> expired;
+    table.expire(expired, start + 50ms);
+    EXPECT_TRUE(expired.empty());
+    table.expire(expired, start + 115ms);
+    EXPECT_EQ(expired, std::vector<int>{3});
+    EXPECT_FALSE(table.tracked(3));
+    EXPECT_TRUE(table.tracked(4));
+
+    expired.clear();
+    table.expire(expired, start + 145ms);
+    EXPECT_EQ(expired, std::vector<int>{6});
+    expired.clear();
+    table.expire(expired, start + 1s); // a late sweep still finds it
+    EXPECT_EQ(expired, std::vector<int>{4});
+    expired.clear();
+    table.expire(expired, start + 2s);
+    EXPECT_TRUE(expired.empty());
+}
+
+namespace {
+    // Answers every message with far more data than the client reads
+    class FloodServer : public NetworkServer {
+    public:
+        using NetworkServer::NetworkServer;
+        ~FloodServer() override { stop(); }
+
+        std::atomic<int> refused{0};
+
+    protected:
+        void handle_message(int client_fd, const Payload&) override {
+            for (int i = 0; i < 1024; ++i) {
+                if (!send_to_client(client_fd, std::string(32 * 1024, 'x'))) {
+                    ++refused;
+                    return;
+                }
+            }
+        }
+    };
+}
+
+// A client that stops reading is disconnected at max_queued instead of
+// growing the server's memory without bound
+TEST(NetworkServerTest, DisconnectsClientsThatStopReading) {
+    ResetDispatcher();
+    Dispatcher::get_instance().start(2);
+
+    for (IoBackend backend : {IoBackend::Epoll, IoBackend::IoUring}) {
+        auto message_queue = std::make_shared<MessageQueue<Payload>>(16);
+        FloodServer server(8095, message_queue, ProtocolType::TCP, false, nullptr, backend);
+        server.set_outbound_limits(OutboundLimits{64 * 1024, 256 * 1024, 1024 * 1024});
+        server.start();
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(8095);
+        inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        ASSERT_EQ(connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+        std::string request = encode_frame("flood me");
+        ASSERT_EQ(send(fd, request.data(), request.size(), 0), static_cast<ssize_t>(request.size()));
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (server.refused == 0 && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        EXPECT_EQ(server.refused, 1);
+
+        // What was already in flight drains, then the connection ends
+        timeval timeout{5, 0};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        std::vector<char> sink(256 * 1024);
+        size_t drained = 0;
+        ssize_t bytes;
+        while ((bytes = recv(fd, sink.data(), sink.size(), 0)) > 0) drained += static_cast<size_t>(bytes);
+        EXPECT_TRUE(bytes == 0 || errno == ECONNRESET) << strerror(errno);
+        EXPECT_LT(drained, 1024u * 32 * 1024);
+
+        close(fd);
+        server.stop();
+    }
+    Dispatcher::get_instance().stop();
+}
+
+// Silent clients are cut off after the configured timeout; one that
+// keeps answering stays connected
+TEST(NetworkServerTest, DropsClientsThatStopAnsweringHeartbeats) {
+    using namespace std::chrono_literals;
+    ResetDispatcher();
+    Dispatcher::get_instance().start(2);
+
+    auto message_queue = std::make_shared<MessageQueue<Payload>>(16);
+    NetworkServer server(8097, message_queue, ProtocolType::TCP, false);
+    server.set_heartbeat(HeartbeatOptions{300ms, 20ms});
+    server.start();
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(8097);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    int silent = socket(AF_INET, SOCK_STREAM, 0);
+    int live = socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_EQ(connect(silent, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+    ASSERT_EQ(connect(live, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+
+    const std::string pong = encode_frame("PONG");
+    for (int i = 0; i < 12; ++i) {
+        ASSERT_EQ(send(live, pong.data(), pong.size(), 0), static_cast<ssize_t>(pong.size()));
+        std::this_thread::sleep_for(50ms);
+    }
+
+    timeval timeout{2, 0};
+    setsockopt(silent, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    char byte;
+    EXPECT_EQ(recv(silent, &byte, 1, 0), 0);
+    EXPECT_EQ(recv(live, &byte, 1, MSG_DONTWAIT), -1);
+    EXPECT_EQ(errno, EAGAIN);
+
+    close(silent);
+    close(live);
+    server.stop();
+    Dispatcher::get_instance().stop();
+}
+
+namespace {
+    // Self-signed P-256 certificate for localhost, written as PEM files
+    bool write_test_certificate(const std::string& certificate_file, const std::string& key_file) {
+        EVP_PKEY* key = EVP_EC_gen("P-256");
+        X509* certificate = X509_new();
+        ASN1_INTEGER_set(X509_get_serialNumber(certificate), 1);
+        X509_gmtime_adj(X509_getm_notBefore(certificate), 0);
+        X509_gmtime_adj(X509_getm_notAfter(certificate), 24 * 60 * 60);
+        X509_set_pubkey(certificate, key);
+        X509_NAME* name = X509_get_subject_name(certificate);
+        X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char*>("localhost"), -1, -1, 0);
+        X509_set_issuer_name(certificate, name);
+        bool written = X509_sign(certificate, key, EVP_sha256()) > 0;
+
+        FILE* out = std::fopen(certificate_file.c_str(), "w");
+        written = written && out && PEM_write_X509(out, certificate);
+        if (out) std::fclose(out);
+        out = std::fopen(key_file.c_str(), "w");
+        written = written && out && PEM_write_PrivateKey(out, key, nullptr, nullptr, 0, nullptr, nullptr);
+        if (out) std::fclose(out);
+
+        X509_free(certificate);
+        EVP_PKEY_free(key);
+        return written;
+    }
+
+    bool pop_within(MessageQueue<Payload>& queue, Payload& message, std::chrono::milliseconds timeout) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (!queue.try_pop(message)) {
+            if (std::chrono::steady_clock::now() > deadline) return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+}
+
+// Handshakes that stall hold no worker, and a client that reconnects
+// resumes its session instead of paying a full handshake
+TEST(NetworkServerTest, TlsResumesSessionsWithoutBlockingWorkers) {
+    ResetDispatcher();
+    Dispatcher::get_instance().start(2);
+
+    const std::string certificate_file = "/tmp/cmq_test_cert.pem";
+    const std::string key_file = "/tmp/cmq_test_key.pem";
+    ASSERT_TRUE(write_test_certificate(certificate_file, key_file));
+
+    auto message_queue = std::make_shared<MessageQueue<Payload>>(16);
+    NetworkServer server(8098, message_queue, ProtocolType::TCP, true);
+    TlsOptions options;
+    options.certificate_file = certificate_file;
+    options.private_key_file = key_file;
+    options.ktls = true; // used when the kernel has the tls module, ignored otherwise
+    ASSERT_TRUE(server.configure_tls(options));
+    server.start();
+
+    // More silent handshakers than workers
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(8098);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    std::vector<int> stalled;
+    for (int i = 0; i < 4; ++i) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        ASSERT_EQ(connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+        stalled.push_back(fd);
+    }
+
+    NetworkClient client("127.0.0.1", 8098, ProtocolType::TCP, true);
+    ASSERT_TRUE(client.connect_server());
+    EXPECT_FALSE(client.tls_session_reused());
+    client.receive_message_async(); // TLS 1.3 tickets arrive after the handshake
+    client.send_message("first");
+    Payload message;
+    ASSERT_TRUE(pop_within(*message_queue, message, std::chrono::seconds(5)));
+    EXPECT_EQ(message, "first");
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!client.has_tls_session() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_TRUE(client.has_tls_session());
+    client.disconnect();
+
+    ASSERT_TRUE(client.connect_server());
+    EXPECT_TRUE(client.tls_session_reused());
+    client.send_message("second");
+    ASSERT_TRUE(pop_within(*message_queue, message, std::chrono::seconds(5)));
+    EXPECT_EQ(message, "second");
+    client.disconnect();
+
+    TlsStats stats = server.tls_stats();
+    EXPECT_EQ(stats.handshakes, 2u);
+    EXPECT_EQ(stats.resumed, 1u);
+
+    for (int fd : stalled) close(fd);
+    server.stop();
+    Dispatcher::get_instance().stop();
+    std::remove(certificate_file.c_str());
+    std::remove(key_file.c_str());
+}
+
+// A handshake written to a peer that has gone away fails with EPIPE; the
+// library leaves SIGPIPE alone, so without the socket BIO it would kill
+// this process
+TEST(TlsSocketTest, WritesToAClosedPeerFailWithoutSigpipe) {
+    int pair[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, pair), 0);
+    close(pair[1]);
+
+    SSL_CTX* context = SSL_CTX_new(TLS_client_method());
+    SSL* ssl = SSL_new(context);
+    ASSERT_TRUE(set_tls_socket(ssl, pair[0]));
+    EXPECT_EQ(SSL_get_fd(ssl), pair[0]);
+    EXPECT_LE(SSL_connect(ssl), 0);
+    EXPECT_EQ(errno, EPIPE);
+
+    SSL_free(ssl);
+    SSL_CTX_free(context);
+    close(pair[0]);
+}
+
+// Frames come out whole whether the stream arrives coalesced or one byte
+// at a time, including payloads whose length needs a multi-byte header
+TEST(FramingTest, ReassemblesSplitAndCoalescedFrames) {
+    std::vector<std::string> payloads = {"move 1 2", "", "chat hi", std::string(300, 'x'), std::string(70000, 'y')};
+    std::string stream;
+    for (const auto& payload : payloads) append_frame(stream, payload);
+
+    FrameDecoder whole;
+    whole.feed(stream);
+    std::vector<std::string> frames;
+    ASSERT_TRUE(whole.drain(frames));
+    EXPECT_EQ(frames, payloads);
+    EXPECT_EQ(whole.buffered(), 0u);
+
+    FrameDecoder bytewise;
+    frames.clear();
+    for (char byte : stream) {
+        bytewise.feed(std::string_view(&byte, 1));
+        ASSERT_TRUE(bytewise.drain(frames));
+    }
+    EXPECT_EQ(frames, payloads);
+}
+
+// Frames are views into the slab they were read into. Only the head of a
+// frame cut off by the end of a slab is copied, and slabs go back to the
+// pool once the decoder and every frame have let go of them.
+TEST(FramingTest, FramesShareTheirSlabAndReturnItToThePool) {
+    BufferPool& pool = BufferPool::get_instance();
+    FrameDecoder decoder;
+    std::vector<Payload> frames;
+
+    std::string stream;
+    append_frame(stream, "move 1 2");
+    append_frame(stream, "chat hi");
+    decoder.feed(stream);
+    ASSERT_TRUE(decoder.drain(frames));
+    ASSERT_EQ(frames.size(), 2u);
+    EXPECT_EQ(frames[0], "move 1 2");
+    EXPECT_EQ(frames[1], "chat hi");
+    EXPECT_EQ(frames[1].data(), frames[0].data() + frames[0].size() + 1); // one slab, back to back
+
+    // The last frame does not fit in what is left of the slab
+    const std::string big(15000, 'b'), cut(2000, 'c');
+    stream.clear();
+    append_frame(stream, big);
+    append_frame(stream, cut);
+    decoder.feed(std::string_view(stream).substr(0, stream.size() - 1500));
+    ASSERT_TRUE(decoder.drain(frames));
+    decoder.feed(std::string_view(stream).substr(stream.size() - 1500));
+    ASSERT_TRUE(decoder.drain(frames));
+    ASSERT_EQ(frames.size(), 4u);
+    EXPECT_EQ(frames[2], big);
+    EXPECT_EQ(frames[3], cut);
+    EXPECT_EQ(decoder.carried(), 2u + cut.size() - 1500);
+
+    frames.clear();
+    decoder.release();
+    size_t allocations = pool.stats().allocations;
+    {
+        SlabRef first = pool.acquire();
+        SlabRef second = pool.acquire();
+    }
+    EXPECT_EQ(pool.stats().allocations, allocations);
+}
+
+TEST(FramingTest, RejectsOversizedAndMalformedHeaders) {
+    FrameDecoder oversized(16);
+    oversized.feed(encode_frame(std::string(17, 'z')));
+    std::vector<std::string> frames;
+    EXPECT_FALSE(oversized.drain(frames));
+
+    FrameDecoder malformed;
+    malformed.feed(std::string(6, '\xff'));
+    EXPECT_FALSE(malformed.drain(frames));
+    EXPECT_TRUE(frames.empty());
+}
+
+namespace {
+    struct WideOpcodeMessage {
+        static constexpr uint16_t kOpcode = 300;
+        uint32_t count = 0;
+        static bool visit(auto& self, auto& field) { return field(self.count); }
+    };
+}
+
+// Fields decode straight out of the payload: strings are views into it
+TEST(WireCodecTest, RoundTripsMessagesWithoutCopies) {
+    std::string move = encode_message(MoveMessage{-3, 200});
+    EXPECT_EQ(move.size(), 4u); // 1-byte opcode, zigzag -3 in 1 byte, 200 in 2
+
+    uint16_t opcode;
+    std::string_view fields;
+    ASSERT_TRUE(read_opcode(move, opcode, fields));
+    EXPECT_EQ(opcode, MoveMessage::kOpcode);
+    MoveMessage decoded_move;
+    ASSERT_TRUE(decode_fields(fields, decoded_move));
+    EXPECT_EQ(decoded_move.x, -3);
+    EXPECT_EQ(decoded_move.y, 200);
+
+    std::string chat = encode_message(ChatMessage{"hello there"});
+    ASSERT_TRUE(read_opcode(chat, opcode, fields));
+    ChatMessage decoded_chat;
+    ASSERT_TRUE(decode_fields(fields, decoded_chat));
+    EXPECT_EQ(decoded_chat.text, "hello there");
+    EXPECT_GE(decoded_chat.text.data(), chat.data());
+    EXPECT_LE(decoded_chat.text.data() + decoded_chat.text.size(), chat.data() + chat.size());
+
+    std::string wide = encode_message(WideOpcodeMessage{7});
+    ASSERT_TRUE(read_opcode(wide, opcode, fields));
+    EXPECT_EQ(opcode, 300);
+    EXPECT_EQ(wide.size(), 3u);
+
+    // Truncated fields and bad text are rejected rather than half-read
+    EXPECT_FALSE(decode_fields(std::string_view(chat).substr(1, 4), decoded_chat));
+    EXPECT_TRUE(parse_text_fields("100 -200", decoded_move));
+    EXPECT_EQ(decoded_move.y, -200);
+    EXPECT_FALSE(parse_text_fields("100 north", decoded_move));
+
+    // Opcodes use the whole uint16_t range; a varint's 10th byte carries
+    // only bit 63
+    std::string widest;
+    WireWriter(widest).varint(UINT16_MAX);
+    ASSERT_TRUE(read_opcode(widest, opcode, fields));
+    EXPECT_EQ(opcode, UINT16_MAX);
+    uint64_t value;
+    std::string top;
+    WireWriter(top).varint(UINT64_MAX);
+    ASSERT_EQ(top.size(), 10u);
+    EXPECT_TRUE(WireReader(top).varint(value));
+    EXPECT_EQ(value, UINT64_MAX);
+    top.back() = 0x02;
+    EXPECT_FALSE(WireReader(top).varint(value));
+}
+
+namespace {
+    // Checks that each client's messages arrive complete and in order
+    class SequenceServer : public NetworkServer {
+    public:
+        using NetworkServer::NetworkServer;
+        ~SequenceServer() override { stop(); }
+
+        static size_t payload_size(int sequence) { return 16 + static_cast<size_t>(sequence * 7919) % 200; }
+
+        static std::string payload(int sender, int sequence) {
+            std::string message = std::to_string(sender) + " " + std::to_string(sequence) + " ";
+            message.resize(payload_size(sequence), '.');
+            return message;
+        }
+
+        std::atomic<int> received{0};
+        std::atomic<int> out_of_order{0};
+
+    protected:
+        // Each sender has its own connection, so its strand serializes this
+        void handle_message(int, const Payload& message) override {
+            std::istringstream fields(message.str());
+            int sender = 0, sequence = 0;
+            fields >> sender >> sequence;
+            int& expected = next_[sender];
+            if (sequence != expected || message.size() != payload_size(sequence)) ++out_of_order;
+            expected = sequence + 1;
+            ++received;
+        }
+
+    private:
+        std::array<int, 16> next_{};
+    };
+}
+
+// Clients write frames back to back as fast as the socket takes them, in
+// chunks that ignore frame boundaries, so the server sees frames glued
+// together and cut at arbitrary points. Heartbeats are mixed in.
+TEST(NetworkServerTest, FramesSurviveLineRateStreams) {
+    ResetDispatcher();
+    Dispatcher::get_instance().start(2);
+
+    for (IoBackend backend : {IoBackend::Epoll, IoBackend::IoUring}) {
+        auto message_queue = std::make_shared<MessageQueue<Payload>>(16);
+        SequenceServer server(8093, message_queue, ProtocolType::TCP, false, nullptr, backend);
+        server.start();
+
+        constexpr int kClients = 4;
+        constexpr int kMessages = 20000;
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(8093);
+        inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+
+        std::vector<std::thread> senders;
+        for (int c = 0; c < kClients; ++c) {
+            int fd = socket(AF_INET, SOCK_STREAM, 0);
+            ASSERT_EQ(connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+            senders.emplace_back([fd, c]() {
+                std::string stream;
+                for (int i = 0; i < kMessages; ++i) {
+                    append_frame(stream, SequenceServer::payload(c, i));
+                    if (i % 100 == 0) append_frame(stream, "PONG");
+                }
+                size_t sent = 0, chunk = 1;
+                while (sent < stream.size()) {
+                    chunk = chunk * 31 % 8191 + 1; // odd sizes that rarely line up with a frame
+                    ssize_t bytes = send(fd, stream.data() + sent, std::min(chunk, stream.size() - sent), 0);
+                    if (bytes <= 0) break;
+                    sent += static_cast<size_t>(bytes);
+                }
+                shutdown(fd, SHUT_WR);
+                char drain;
+                recv(fd, &drain, 1, 0); // hold the connection until the server closes it
+                close(fd);
+            });
+        }
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(20);
+        while (server.received < kClients * kMessages && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        EXPECT_EQ(server.received, kClients * kMessages);
+        EXPECT_EQ(server.out_of_order, 0);
+
+        server.stop();
+        for (auto& sender : senders) sender.join();
+    }
+    Dispatcher::get_instance().stop();
+}
+
+// Several threads sharing one client each see their commands arrive in
+// the order they sent them, over TCP with the writer corked and waiting
+// out a flush window, and over UDP batched into sendmmsg
+TEST(NetworkClientTest, SendPipelineKeepsEachSendersOrder) {
+    ResetDispatcher();
+    Dispatcher::get_instance().start(2);
+
+    struct Case { ProtocolType protocol; int port; int messages; };
+    for (Case test : {Case{ProtocolType::TCP, 8099, 5000}, Case{ProtocolType::UDP, 8100, 200}}) {
+        auto message_queue = std::make_shared<MessageQueue<Payload>>(16);
+        SequenceServer server(test.port, message_queue, test.protocol, false);
+        server.start();
+
+        NetworkClient client("127.0.0.1", test.port, test.protocol, false);
+        SendOptions options;
+        options.flush_window = std::chrono::milliseconds(2);
+        options.cork = true;
+        client.set_send_options(options);
+        ASSERT_TRUE(client.connect_server());
+
+        constexpr int kSenders = 3;
+        std::vector<std::thread> senders;
+        for (int s = 0; s < kSenders; ++s) {
+            senders.emplace_back([&client, s, test]() {
+                for (int i = 0; i < test.messages; ++i) client.send_message(SequenceServer::payload(s, i));
+            });
+        }
+        for (auto& sender : senders) sender.join();
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (server.received < kSenders * test.messages && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        EXPECT_EQ(server.received, kSenders * test.messages);
+        EXPECT_EQ(server.out_of_order, 0);
+
+        client.disconnect();
+        server.stop();
+    }
+    Dispatcher::get_instance().stop();
+}
+
+// A connection closed while a flush is queued, waiting out its window or
+// writing still has its socket closed, by the flush if not by the close
+TEST(NetworkClientTest, ClosingMidFlushReleasesTheSocket) {
+    ResetDispatcher();
+    Dispatcher::get_instance().start(2);
+    TimerWheel::get_instance(); // its descriptors are not the client's
+
+    // Nobody accepts: the kernel completes connects from the backlog
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    int reuse = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(8104);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQ(bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+    ASSERT_EQ(listen(listener, 16), 0);
+
+    auto open_fds = []() {
+        return std::distance(std::filesystem::directory_iterator("/proc/self/fd"),
+                             std::filesystem::directory_iterator());
+    };
+    const auto baseline = open_fds();
+    for (auto window : {std::chrono::microseconds(0), std::chrono::microseconds(50000)}) {
+        NetworkClient client("127.0.0.1", 8104, ProtocolType::TCP);
+        SendOptions options;
+        options.flush_window = window;
+        client.set_send_options(options);
+        ASSERT_TRUE(client.connect_server());
+        for (int i = 0; i < 200; ++i) client.send_message(std::string(1024, 'x'));
+        client.disconnect();
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        while (open_fds() != baseline && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        EXPECT_EQ(open_fds(), baseline) << "window " << window.count() << " us";
+    }
+
+    close(listener);
+    Dispatcher::get_instance().stop();
+}
+
+// A reader its stopped pool never runs does not leave disconnect()
+// waiting for it
+TEST(NetworkClientTest, ReaderRejectedByAStoppedPoolDoesNotBlockDisconnect) {
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    int reuse = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(8106);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQ(bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+    ASSERT_EQ(listen(listener, 16), 0);
+
+    auto pool = std::make_shared<Dispatcher>("reader");
+    NetworkClient client("127.0.0.1", 8106, ProtocolType::TCP, false, pool);
+    ASSERT_TRUE(client.connect_server());
+    pool->stop();
+    client.receive_message_async();
+    client.disconnect(); // returns instead of waiting on a reader that never ran
+
+    close(listener);
+}
+
+// A client that connects and never sends a request is dropped after a
+// while: /status still answers and stop() still returns
+TEST(WebServerTest, IdleConnectionDoesNotBlockStatusOrStop) {
+    WebServer server(8103, std::make_shared<MessageQueue<std::string>>(16), WebServer::ProtocolType::TCP);
+    server.start();
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(8103);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    auto open_client = [&addr]() {
+        for (int attempt = 0; attempt < 50; ++attempt) {
+            int fd = socket(AF_INET, SOCK_STREAM, 0);
+            if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0) return fd;
+            close(fd);
+            std::this_thread::sleep_for(std::chrono::milliseconds(20)); // listener not up yet
+        }
+        return -1;
+    };
+
+    int idle = open_client();
+    ASSERT_GE(idle, 0);
+
+    int status = open_client();
+    ASSERT_GE(status, 0);
+    const std::string request = "GET /status HTTP/1.1\r\n\r\n";
+    ASSERT_EQ(send(status, request.data(), request.size(), 0), static_cast<ssize_t>(request.size()));
+    pollfd reply{status, POLLIN, 0};
+    ASSERT_EQ(poll(&reply, 1, 5000), 1);
+    char buffer[64] = {0};
+    ASSERT_GT(recv(status, buffer, sizeof(buffer) - 1, 0), 0);
+    EXPECT_EQ(std::string(buffer).rfind("HTTP/1.1 200 OK", 0), 0u);
+    close(status);
+
+    // Another idle client, accepted just before stop()
+    int late = open_client();
+    ASSERT_GE(late, 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    auto start = std::chrono::steady_clock::now();
+    server.stop();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(2));
+
+    close(idle);
+    close(late);
+}
+
 // Google Test main entry point
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
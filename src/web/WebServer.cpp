@@ -1,5 +1,7 @@
 // src/engine/WebServer.cpp
 #include "web/WebServer.hpp"
+#include "engine/Dispatcher.hpp"
+#include <poll.h>
 #include <sys/epoll.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
@@ -10,8 +12,67 @@
 
 namespace CMQ {
 
+namespace {
+
+// Poll period of the accept loop, bounding how long stop() waits
+constexpr int kAcceptPollMs = 100;
+// A client gets this long to send its request before it is dropped, so one
+// that connects and says nothing cannot hold up the loop or stop()
+constexpr int kRequestTimeoutMs = 500;
+
+double to_micros(uint64_t nanoseconds) {
+    return static_cast<double>(nanoseconds) / 1000.0;
+}
+
+void append_histogram(std::ostringstream& out, const char* key, const HistogramSnapshot& histogram) {
+    out << "\"" << key << "\":{"
+        << "\"count\":" << histogram.count()
+        << ",\"p50\":" << to_micros(histogram.percentile(0.50))
+        << ",\"p99\":" << to_micros(histogram.percentile(0.99))
+        << ",\"p999\":" << to_micros(histogram.percentile(0.999))
+        << ",\"max\":" << to_micros(histogram.max()) << "}";
+}
+
+// Latencies are reported in microseconds
+std::string dispatcher_stats_json() {
+    std::ostringstream out;
+    out << "[";
+    bool first_pool = true;
+    for (const DispatcherStats& pool : Dispatcher::all_stats()) {
+        if (!first_pool) out << ",";
+        first_pool = false;
+
+        out << "{\"name\":\"" << pool.name << "\",\"running\":" << (pool.running ? "true" : "false")
+            << ",\"workers\":[";
+        for (size_t i = 0; i < pool.workers.size(); ++i) {
+            const WorkerStats& worker = pool.workers[i];
+            if (i > 0) out << ",";
+            out << "{\"executed\":" << worker.executed << ",\"failed\":" << worker.failed
+                << ",\"steals\":" << worker.steals << ",\"parks\":" << worker.parks << "}";
+        }
+
+        out << "],\"lanes\":{";
+        for (size_t i = 0; i < kTaskLaneCount; ++i) {
+            const LaneStats& lane = pool.lanes[i];
+            if (i > 0) out << ",";
+            out << "\"" << lane_name(static_cast<TaskLane>(i)) << "\":{"
+                << "\"depth\":" << lane.depth << ",\"executed\":" << lane.executed
+                << ",\"failed\":" << lane.failed << ",";
+            append_histogram(out, "queue_wait_us", lane.queue_wait);
+            out << ",";
+            append_histogram(out, "run_time_us", lane.run_time);
+            out << "}";
+        }
+        out << "}}";
+    }
+    out << "]";
+    return out.str();
+}
+
+} // namespace
+
 WebServer::WebServer(int port, std::shared_ptr<MessageQueue<std::string>> queue, ProtocolType protocol)
-    : port_(port), message_queue_(queue), protocol_(protocol), running_(false), ssl_ctx_(nullptr), stop_threads_(false),
+    : port_(port), server_fd_(-1), running_(false), protocol_(protocol), message_queue_(queue), ssl_ctx_(nullptr), stop_threads_(false),
       total_messages_received_(0), current_queue_size_(0) {}
 
 WebServer::~WebServer() {
@@ -29,6 +90,10 @@ void WebServer::stop() {
     if (accept_thread_.joinable()) {
         accept_thread_.join();
     }
+    if (server_fd_ >= 0) {
+        close(server_fd_);
+        server_fd_ = -1;
+    }
 
     for (auto &thread : thread_pool_) {
         if (thread.joinable()) {
@@ -42,35 +107,51 @@ void WebServer::accept_connections() {
     initialize_ssl();
 
     server_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    int reuse = 1;
+    setsockopt(server_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
     sockaddr_in server_addr{};
     server_addr.sin_family = AF_INET;
     server_addr.sin_port = htons(port_);
     server_addr.sin_addr.s_addr = INADDR_ANY;
 
-    bind(server_fd_, (struct sockaddr *)&server_addr, sizeof(server_addr));
-    listen(server_fd_, 10);
+    if (bind(server_fd_, (struct sockaddr *)&server_addr, sizeof(server_addr)) < 0 || listen(server_fd_, 10) < 0) {
+        std::cerr << "WebServer failed to listen on port " << port_ << std::endl;
+        return;
+    }
 
+    // Status requests are tiny, so they are answered on this thread; the
+    // poll timeout lets stop() end the loop without a connection arriving
     while (running_) {
+        pollfd listener{server_fd_, POLLIN, 0};
+        if (poll(&listener, 1, kAcceptPollMs) <= 0) continue;
+
         sockaddr_in client_addr{};
         socklen_t addr_len = sizeof(client_addr);
         int client_fd = accept(server_fd_, (struct sockaddr *)&client_addr, &addr_len);
 
         if (client_fd >= 0) {
-            worker_threads_.emplace_back(&WebServer::handle_request, this, client_fd);
+            handle_request(client_fd);
         }
     }
 }
 
 void WebServer::handle_request(int client_fd) {
+    pollfd client{client_fd, POLLIN, 0};
+    if (poll(&client, 1, kRequestTimeoutMs) <= 0) {
+        close(client_fd);
+        return;
+    }
+
     char buffer[1024] = {0};
-    read(client_fd, buffer, sizeof(buffer));
-    std::string request(buffer);
+    ssize_t bytes = read(client_fd, buffer, sizeof(buffer) - 1);
+    std::string request(buffer, bytes > 0 ? static_cast<size_t>(bytes) : 0);
 
     if (request.find("GET /status") == 0) {
         std::string status = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n\r\n{";
         status += "\"total_messages_received\":" + std::to_string(total_messages_received_) + ",";
-        status += "\"current_queue_size\":" + std::to_string(current_queue_size_) + "}";
-        send(client_fd, status.c_str(), status.size(), 0);
+        status += "\"current_queue_size\":" + std::to_string(current_queue_size_) + ",";
+        status += "\"dispatchers\":" + dispatcher_stats_json() + "}";
+        send(client_fd, status.c_str(), status.size(), MSG_NOSIGNAL);
     }
 
     close(client_fd);